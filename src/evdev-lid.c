@@ -59,9 +59,6 @@ lid_switch_keyboard_event(uint64_t time,
 	if (!dispatch->lid_is_closed)
 		return;
 
-	if (event->type != LIBINPUT_EVENT_KEYBOARD_KEY)
-		return;
-
 	if (dispatch->reliability == RELIABILITY_WRITE_OPEN) {
 		int fd = libevdev_get_fd(dispatch->device->evdev);
 		struct input_event ev[2] = {
@@ -97,6 +94,8 @@ lid_switch_toggle_keyboard_listener(struct lid_switch_dispatch *dispatch,
 		libinput_device_add_event_listener(
 					&dispatch->keyboard.keyboard->base,
 					&dispatch->keyboard.listener,
+					event_listener_mask(
+						LIBINPUT_EVENT_KEYBOARD_KEY),
 					lid_switch_keyboard_event,
 					dispatch);
 	} else {
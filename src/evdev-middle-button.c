@@ -27,7 +27,14 @@
 
 #include "evdev.h"
 
+/* The timeout adapts to the interval between the left and right press of
+ * the user's chords, MIDDLEBUTTON_TIMEOUT is the upper limit. Until we
+ * have seen enough chords, the maximum timeout is used. */
 #define MIDDLEBUTTON_TIMEOUT ms2us(50)
+#define MIDDLEBUTTON_TIMEOUT_MIN ms2us(15)
+#define MIDDLEBUTTON_TIMEOUT_MARGIN ms2us(5)
+#define MIDDLEBUTTON_CHORD_MIN_SAMPLES 8
+#define MIDDLEBUTTON_CHORD_PERCENTILE 95
 
 /*****************************************
  * BEFORE YOU EDIT THIS FILE, look at the state diagram in
@@ -92,7 +99,57 @@ static void
 middlebutton_timer_set(struct evdev_device *device, uint64_t now)
 {
 	libinput_timer_set(&device->middlebutton.timer,
-			   now + MIDDLEBUTTON_TIMEOUT);
+			   now + device->middlebutton.timeout);
+}
+
+static void
+middlebutton_update_timeout(struct evdev_device *device)
+{
+	uint64_t sorted[MIDDLEBUTTON_CHORD_HISTORY];
+	unsigned int count = device->middlebutton.chord.count;
+	unsigned int i, j, idx;
+	uint64_t timeout;
+
+	if (count < MIDDLEBUTTON_CHORD_MIN_SAMPLES) {
+		device->middlebutton.timeout = MIDDLEBUTTON_TIMEOUT;
+		return;
+	}
+
+	/* insertion sort, the history is small and chords are rare */
+	for (i = 0; i < count; i++) {
+		uint64_t v = device->middlebutton.chord.intervals[i];
+
+		for (j = i; j > 0 && sorted[j - 1] > v; j--)
+			sorted[j] = sorted[j - 1];
+		sorted[j] = v;
+	}
+
+	idx = (count * MIDDLEBUTTON_CHORD_PERCENTILE + 99)/100 - 1;
+	timeout = sorted[idx] + MIDDLEBUTTON_TIMEOUT_MARGIN;
+	timeout = max(timeout, MIDDLEBUTTON_TIMEOUT_MIN);
+	timeout = min(timeout, MIDDLEBUTTON_TIMEOUT);
+
+	if (timeout != device->middlebutton.timeout)
+		evdev_log_debug(device,
+				"middlebutton: timeout now %dms\n",
+				(int)us2ms(timeout));
+
+	device->middlebutton.timeout = timeout;
+}
+
+static void
+middlebutton_record_chord(struct evdev_device *device, uint64_t time)
+{
+	unsigned int next = device->middlebutton.chord.next;
+	uint64_t interval = time - device->middlebutton.first_event_time;
+
+	device->middlebutton.chord.intervals[next] = interval;
+	device->middlebutton.chord.next = (next + 1) %
+					  MIDDLEBUTTON_CHORD_HISTORY;
+	if (device->middlebutton.chord.count < MIDDLEBUTTON_CHORD_HISTORY)
+		device->middlebutton.chord.count++;
+
+	middlebutton_update_timeout(device);
 }
 
 static void
@@ -175,6 +232,7 @@ evdev_middlebutton_ldown_handle_event(struct evdev_device *device,
 		middlebutton_state_error(device, event);
 		break;
 	case MIDDLEBUTTON_EVENT_R_DOWN:
+		middlebutton_record_chord(device, time);
 		middlebutton_post_event(device, time,
 					BTN_MIDDLE,
 					LIBINPUT_BUTTON_STATE_PRESSED);
@@ -209,6 +267,7 @@ evdev_middlebutton_ldown_handle_event(struct evdev_device *device,
 		middlebutton_set_state(device,
 				       MIDDLEBUTTON_PASSTHROUGH,
 				       time);
+		device->middlebutton.chord.missed = true;
 		break;
 	case MIDDLEBUTTON_EVENT_ALL_UP:
 		middlebutton_state_error(device, event);
@@ -225,6 +284,7 @@ evdev_middlebutton_rdown_handle_event(struct evdev_device *device,
 {
 	switch (event) {
 	case MIDDLEBUTTON_EVENT_L_DOWN:
+		middlebutton_record_chord(device, time);
 		middlebutton_post_event(device, time,
 					BTN_MIDDLE,
 					LIBINPUT_BUTTON_STATE_PRESSED);
@@ -263,6 +323,7 @@ evdev_middlebutton_rdown_handle_event(struct evdev_device *device,
 		middlebutton_set_state(device,
 				       MIDDLEBUTTON_PASSTHROUGH,
 				       time);
+		device->middlebutton.chord.missed = true;
 		break;
 	case MIDDLEBUTTON_EVENT_ALL_UP:
 		middlebutton_state_error(device, event);
@@ -616,6 +677,18 @@ evdev_middlebutton_filter_button(struct evdev_device *device,
 		return true;
 	}
 
+	/* If our timeout was too short for this chord, the first button
+	 * was already sent as normal button press. We can't undo that, but
+	 * we can adjust the timeout for the next chord */
+	if (device->middlebutton.chord.missed &&
+	    (event == MIDDLEBUTTON_EVENT_L_DOWN ||
+	     event == MIDDLEBUTTON_EVENT_R_DOWN)) {
+		if (time - device->middlebutton.first_event_time <
+		    MIDDLEBUTTON_TIMEOUT)
+			middlebutton_record_chord(device, time);
+		device->middlebutton.chord.missed = false;
+	}
+
 	rc = evdev_middlebutton_handle_event(device, time, event);
 
 	old_mask = device->middlebutton.button_mask;
@@ -629,6 +702,7 @@ evdev_middlebutton_filter_button(struct evdev_device *device,
 		evdev_middlebutton_handle_event(device,
 						time,
 						MIDDLEBUTTON_EVENT_ALL_UP);
+		device->middlebutton.chord.missed = false;
 		evdev_middlebutton_apply_config(device);
 	}
 
@@ -649,6 +723,12 @@ evdev_middlebutton_is_available(struct libinput_device *device)
 	return 1;
 }
 
+static int
+evdev_middlebutton_is_not_available(struct libinput_device *device)
+{
+	return 0;
+}
+
 static enum libinput_config_status
 evdev_middlebutton_set(struct libinput_device *device,
 		       enum libinput_config_middle_emulation_state enable)
@@ -691,11 +771,25 @@ evdev_middlebutton_get_default(struct libinput_device *device)
 			LIBINPUT_CONFIG_MIDDLE_EMULATION_DISABLED;
 }
 
+uint64_t
+evdev_middlebutton_get_timeout(struct libinput_device *device)
+{
+	struct evdev_device *evdev = evdev_device(device);
+
+	if (!evdev->middlebutton.enabled)
+		return 0;
+
+	/* The timer has no slack, so this is the real maximum delay */
+	return evdev->middlebutton.timeout;
+}
+
 void
 evdev_init_middlebutton(struct evdev_device *device,
 			bool enable,
 			bool want_config)
 {
+	/* No timer slack here, the timeout is reported to the caller as the
+	 * maximum delay of a button press */
 	libinput_timer_init(&device->middlebutton.timer,
 			    evdev_libinput_context(device),
 			    evdev_middlebutton_handle_timeout,
@@ -703,13 +797,21 @@ evdev_init_middlebutton(struct evdev_device *device,
 	device->middlebutton.enabled_default = enable;
 	device->middlebutton.want_enabled = enable;
 	device->middlebutton.enabled = enable;
+	device->middlebutton.timeout = MIDDLEBUTTON_TIMEOUT;
 
-	if (!want_config)
+	/* Without the config option, emulation is still active and the
+	 * timeout can be queried, it just can't be toggled */
+	device->middlebutton.config.get_timeout = evdev_middlebutton_get_timeout;
+	device->base.config.middle_emulation = &device->middlebutton.config;
+
+	if (!want_config) {
+		device->middlebutton.config.available =
+			evdev_middlebutton_is_not_available;
 		return;
+	}
 
 	device->middlebutton.config.available = evdev_middlebutton_is_available;
 	device->middlebutton.config.set = evdev_middlebutton_set;
 	device->middlebutton.config.get = evdev_middlebutton_get;
 	device->middlebutton.config.get_default = evdev_middlebutton_get_default;
-	device->base.config.middle_emulation = &device->middlebutton.config;
 }
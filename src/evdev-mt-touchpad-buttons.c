@@ -78,82 +78,27 @@ button_event_to_str(enum button_event event) {
 	return NULL;
 }
 
-static inline bool
-is_inside_bottom_button_area(const struct tp_dispatch *tp,
-			     const struct tp_touch *t)
-{
-	return t->point.y >= tp->buttons.bottom_area.top_edge;
-}
-
-static inline bool
-is_inside_bottom_right_area(const struct tp_dispatch *tp,
-			    const struct tp_touch *t)
-{
-	return is_inside_bottom_button_area(tp, t) &&
-	       t->point.x > tp->buttons.bottom_area.rightbutton_left_edge;
-}
-
-static inline bool
-is_inside_bottom_middle_area(const struct tp_dispatch *tp,
-			   const struct tp_touch *t)
-{
-	return is_inside_bottom_button_area(tp, t) &&
-	       !is_inside_bottom_right_area(tp, t) &&
-	       t->point.x > tp->buttons.bottom_area.middlebutton_left_edge;
-}
-
-static inline bool
-is_inside_bottom_left_area(const struct tp_dispatch *tp,
-			   const struct tp_touch *t)
-{
-	return is_inside_bottom_button_area(tp, t) &&
-	       !is_inside_bottom_middle_area(tp, t) &&
-	       !is_inside_bottom_right_area(tp, t);
-}
-
-static inline bool
-is_inside_top_button_area(const struct tp_dispatch *tp,
-			  const struct tp_touch *t)
-{
-	return t->point.y <= tp->buttons.top_area.bottom_edge;
-}
-
-static inline bool
-is_inside_top_right_area(const struct tp_dispatch *tp,
-			 const struct tp_touch *t)
-{
-	return is_inside_top_button_area(tp, t) &&
-	       t->point.x > tp->buttons.top_area.rightbutton_left_edge;
-}
-
-static inline bool
-is_inside_top_left_area(const struct tp_dispatch *tp,
-			const struct tp_touch *t)
-{
-	return is_inside_top_button_area(tp, t) &&
-	       t->point.x < tp->buttons.top_area.leftbutton_right_edge;
-}
-
-static inline bool
-is_inside_top_middle_area(const struct tp_dispatch *tp,
-			  const struct tp_touch *t)
-{
-	return is_inside_top_button_area(tp, t) &&
-	       t->point.x >= tp->buttons.top_area.leftbutton_right_edge &&
-	       t->point.x <= tp->buttons.top_area.rightbutton_left_edge;
-}
-
+/* The timers only exist once software buttons were enabled, see
+ * tp_init_button_timers(). Without software buttons a touch never enters a
+ * button area, so only the allocation failing leaves us here without one.
+ */
 static void
 tp_button_set_enter_timer(struct tp_dispatch *tp, struct tp_touch *t)
 {
-	libinput_timer_set(&t->button.timer,
+	if (!t->button.timer)
+		return;
+
+	libinput_timer_set(t->button.timer,
 			   t->millis + DEFAULT_BUTTON_ENTER_TIMEOUT);
 }
 
 static void
 tp_button_set_leave_timer(struct tp_dispatch *tp, struct tp_touch *t)
 {
-	libinput_timer_set(&t->button.timer,
+	if (!t->button.timer)
+		return;
+
+	libinput_timer_set(t->button.timer,
 			   t->millis + DEFAULT_BUTTON_LEAVE_TIMEOUT);
 }
 
@@ -167,7 +112,8 @@ tp_button_set_state(struct tp_dispatch *tp,
 		    enum button_state new_state,
 		    enum button_event event)
 {
-	libinput_timer_cancel(&t->button.timer);
+	if (t->button.timer)
+		libinput_timer_cancel(t->button.timer);
 
 	t->button.state = new_state;
 
@@ -456,26 +402,27 @@ tp_button_handle_state(struct tp_dispatch *tp, uint64_t time)
 {
 	struct tp_touch *t;
 
-	tp_for_each_touch(tp, t) {
+	/* a touch in TOUCH_END is always dirty */
+	tp_for_each_dirty_touch(tp, t) {
 		if (t->state == TOUCH_NONE || t->state == TOUCH_HOVERING)
 			continue;
 
 		if (t->state == TOUCH_END) {
 			tp_button_handle_event(tp, t, BUTTON_EVENT_UP, time);
-		} else if (t->dirty) {
+		} else {
 			enum button_event event;
 
-			if (is_inside_bottom_right_area(tp, t))
+			if (t->zones & TP_ZONE_BOTTOM_RIGHT)
 				event = BUTTON_EVENT_IN_BOTTOM_R;
-			else if (is_inside_bottom_middle_area(tp, t))
+			else if (t->zones & TP_ZONE_BOTTOM_MIDDLE)
 				event = BUTTON_EVENT_IN_BOTTOM_M;
-			else if (is_inside_bottom_left_area(tp, t))
+			else if (t->zones & TP_ZONE_BOTTOM_LEFT)
 				event = BUTTON_EVENT_IN_BOTTOM_L;
-			else if (is_inside_top_right_area(tp, t))
+			else if (t->zones & TP_ZONE_TOP_RIGHT)
 				event = BUTTON_EVENT_IN_TOP_R;
-			else if (is_inside_top_middle_area(tp, t))
+			else if (t->zones & TP_ZONE_TOP_MIDDLE)
 				event = BUTTON_EVENT_IN_TOP_M;
-			else if (is_inside_top_left_area(tp, t))
+			else if (t->zones & TP_ZONE_TOP_LEFT)
 				event = BUTTON_EVENT_IN_TOP_L;
 			else
 				event = BUTTON_EVENT_IN_AREA;
@@ -531,6 +478,34 @@ tp_release_all_buttons(struct tp_dispatch *tp,
 	}
 }
 
+static bool
+tp_init_button_timers(struct tp_dispatch *tp)
+{
+	struct libinput_timer *timers;
+	struct tp_touch *t;
+
+	if (tp->touch_timers.button)
+		return true;
+
+	timers = calloc(tp->ntouches, sizeof(*timers));
+	if (!timers) {
+		evdev_log_error(tp->device,
+				"failed to allocate software button timers\n");
+		return false;
+	}
+
+	tp->touch_timers.button = timers;
+
+	tp_for_each_touch(tp, t) {
+		t->button.timer = &timers[tp_touch_index(tp, t)];
+		libinput_timer_init(t->button.timer,
+				    tp_libinput_context(tp),
+				    tp_button_handle_timeout, t);
+	}
+
+	return true;
+}
+
 static void
 tp_init_softbuttons(struct tp_dispatch *tp,
 		    struct evdev_device *device)
@@ -540,6 +515,8 @@ tp_init_softbuttons(struct tp_dispatch *tp,
 	int mb_le, mb_re; /* middle button left/right edge */
 	struct phys_coords mm = { 0.0, 0.0 };
 
+	tp_init_button_timers(tp);
+
 	evdev_device_get_size(device, &width, &height);
 
 	/* button height: 10mm or 15% or the touchpad height,
@@ -606,6 +583,8 @@ tp_init_top_softbuttons(struct tp_dispatch *tp,
 		struct phys_coords mm;
 		double width, height;
 
+		tp_init_button_timers(tp);
+
 		evdev_device_get_size(device, &width, &height);
 
 		mm.x = width * 0.60;
@@ -620,6 +599,8 @@ tp_init_top_softbuttons(struct tp_dispatch *tp,
 	} else {
 		tp->buttons.top_area.bottom_edge = INT_MIN;
 	}
+
+	tp_zones_update(tp);
 }
 
 static inline uint32_t
@@ -664,6 +645,8 @@ tp_switch_click_method(struct tp_dispatch *tp)
 		tp->buttons.bottom_area.top_edge = INT_MAX;
 		break;
 	}
+
+	tp_zones_update(tp);
 }
 
 static enum libinput_config_status
@@ -673,6 +656,10 @@ tp_button_config_click_set_method(struct libinput_device *device,
 	struct evdev_device *evdev = evdev_device(device);
 	struct tp_dispatch *tp = (struct tp_dispatch*)evdev->dispatch;
 
+	if (method == LIBINPUT_CONFIG_CLICK_METHOD_BUTTON_AREAS &&
+	    !tp_init_button_timers(tp))
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
 	tp->buttons.click_method = method;
 	tp_switch_click_method(tp);
 
@@ -734,8 +721,10 @@ tp_clickpad_middlebutton_apply_config(struct evdev_device *device)
 
 	device->middlebutton.enabled = device->middlebutton.want_enabled;
 	if (tp->buttons.click_method ==
-	    LIBINPUT_CONFIG_CLICK_METHOD_BUTTON_AREAS)
+	    LIBINPUT_CONFIG_CLICK_METHOD_BUTTON_AREAS) {
 		tp_init_softbuttons(tp, device);
+		tp_zones_update(tp);
+	}
 }
 
 static int
@@ -778,6 +767,14 @@ tp_clickpad_middlebutton_get_default(struct libinput_device *device)
 	return evdev_middlebutton_get_default(device);
 }
 
+static uint64_t
+tp_clickpad_middlebutton_get_timeout(struct libinput_device *device)
+{
+	/* both buttons are decided on within the same frame, clicks are
+	 * never delayed */
+	return 0;
+}
+
 static inline void
 tp_init_clickpad_middlebutton_emulation(struct tp_dispatch *tp,
 					struct evdev_device *device)
@@ -790,6 +787,7 @@ tp_init_clickpad_middlebutton_emulation(struct tp_dispatch *tp,
 	device->middlebutton.config.set = tp_clickpad_middlebutton_set;
 	device->middlebutton.config.get = tp_clickpad_middlebutton_get;
 	device->middlebutton.config.get_default = tp_clickpad_middlebutton_get_default;
+	device->middlebutton.config.get_timeout = tp_clickpad_middlebutton_get_timeout;
 	device->base.config.middle_emulation = &device->middlebutton.config;
 }
 
@@ -826,7 +824,7 @@ tp_init_middlebutton_emulation(struct tp_dispatch *tp,
 				want_config_option);
 }
 
-void
+bool
 tp_init_buttons(struct tp_dispatch *tp,
 		struct evdev_device *device)
 {
@@ -864,18 +862,25 @@ tp_init_buttons(struct tp_dispatch *tp,
 	tp->device->base.config.click_method = &tp->buttons.config_method;
 
 	tp->buttons.click_method = tp_click_get_default_method(tp);
+
+	/* Allocated up front so the touchpad fails to initialize rather than
+	 * run its software buttons without timers */
+	if ((tp->buttons.click_method ==
+	     LIBINPUT_CONFIG_CLICK_METHOD_BUTTON_AREAS ||
+	     tp->buttons.has_topbuttons) &&
+	    !tp_init_button_timers(tp))
+		return false;
+
 	tp_switch_click_method(tp);
 
 	tp_init_top_softbuttons(tp, device, 1.0);
 
 	tp_init_middlebutton_emulation(tp, device);
 
-	tp_for_each_touch(tp, t) {
+	tp_for_each_touch(tp, t)
 		t->button.state = BUTTON_STATE_NONE;
-		libinput_timer_init(&t->button.timer,
-				    tp_libinput_context(tp),
-				    tp_button_handle_timeout, t);
-	}
+
+	return true;
 }
 
 void
@@ -883,8 +888,11 @@ tp_remove_buttons(struct tp_dispatch *tp)
 {
 	struct tp_touch *t;
 
+	if (!tp->touch_timers.button)
+		return;
+
 	tp_for_each_touch(tp, t)
-		libinput_timer_cancel(&t->button.timer);
+		libinput_timer_cancel(t->button.timer);
 }
 
 static int
@@ -1194,6 +1202,5 @@ bool
 tp_button_is_inside_softbutton_area(const struct tp_dispatch *tp,
 				    const struct tp_touch *t)
 {
-	return is_inside_top_button_area(tp, t) ||
-	       is_inside_bottom_button_area(tp, t);
+	return (t->zones & (TP_ZONE_TOP|TP_ZONE_BOTTOM)) != 0;
 }
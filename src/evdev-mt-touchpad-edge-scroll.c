@@ -80,10 +80,10 @@ tp_touch_get_edge(const struct tp_dispatch *tp, const struct tp_touch *t)
 	if (tp->scroll.method != LIBINPUT_CONFIG_SCROLL_EDGE)
 		return EDGE_NONE;
 
-	if (t->point.x > tp->scroll.right_edge)
+	if (t->zones & TP_ZONE_EDGE_RIGHT)
 		edge |= EDGE_RIGHT;
 
-	if (t->point.y > tp->scroll.bottom_edge)
+	if (t->zones & TP_ZONE_EDGE_BOTTOM)
 		edge |= EDGE_BOTTOM;
 
 	return edge;
@@ -102,7 +102,11 @@ tp_edge_scroll_set_timer(struct tp_dispatch *tp,
 	    LIBINPUT_CONFIG_CLICK_METHOD_BUTTON_AREAS)
 		return;
 
-	libinput_timer_set(&t->scroll.timer,
+	/* only allocated once edge scrolling is enabled */
+	if (!t->scroll.timer)
+		return;
+
+	libinput_timer_set(t->scroll.timer,
 			   t->millis + DEFAULT_SCROLL_LOCK_TIMEOUT);
 }
 
@@ -111,7 +115,8 @@ tp_edge_scroll_set_state(struct tp_dispatch *tp,
 			 struct tp_touch *t,
 			 enum tp_edge_scroll_touch_state state)
 {
-	libinput_timer_cancel(&t->scroll.timer);
+	if (t->scroll.timer)
+		libinput_timer_cancel(t->scroll.timer);
 
 	t->scroll.edge_state = state;
 
@@ -121,7 +126,7 @@ tp_edge_scroll_set_state(struct tp_dispatch *tp,
 		break;
 	case EDGE_SCROLL_TOUCH_STATE_EDGE_NEW:
 		t->scroll.edge = tp_touch_get_edge(tp, t);
-		t->scroll.initial = t->point;
+		t->cold->scroll.initial = t->point;
 		tp_edge_scroll_set_timer(tp, t);
 		break;
 	case EDGE_SCROLL_TOUCH_STATE_EDGE:
@@ -302,12 +307,42 @@ tp_edge_scroll_init(struct tp_dispatch *tp, struct evdev_device *device)
 	else
 		tp->scroll.bottom_edge = INT_MAX;
 
-	tp_for_each_touch(tp, t) {
+	tp_for_each_touch(tp, t)
 		t->scroll.direction = -1;
-		libinput_timer_init(&t->scroll.timer,
+}
+
+/* Most touchpads use two-finger scrolling, so the timers are only
+ * allocated when edge scrolling is first enabled and then kept for the
+ * lifetime of the device.
+ */
+bool
+tp_edge_scroll_init_timers(struct tp_dispatch *tp)
+{
+	struct libinput_timer *timers;
+	struct tp_touch *t;
+
+	if (tp->touch_timers.scroll)
+		return true;
+
+	timers = calloc(tp->ntouches, sizeof(*timers));
+	if (!timers) {
+		evdev_log_error(tp->device,
+				"failed to allocate edge scroll timers\n");
+		return false;
+	}
+
+	tp->touch_timers.scroll = timers;
+
+	tp_for_each_touch(tp, t) {
+		t->scroll.timer = &timers[tp_touch_index(tp, t)];
+		libinput_timer_init(t->scroll.timer,
 				    tp_libinput_context(tp),
 				    tp_edge_scroll_handle_timeout, t);
+		libinput_timer_set_slack(t->scroll.timer,
+					 TIMER_SLACK_DEFAULT);
 	}
+
+	return true;
 }
 
 void
@@ -315,8 +350,11 @@ tp_remove_edge_scroll(struct tp_dispatch *tp)
 {
 	struct tp_touch *t;
 
+	if (!tp->touch_timers.scroll)
+		return;
+
 	tp_for_each_touch(tp, t)
-		libinput_timer_cancel(&t->scroll.timer);
+		libinput_timer_cancel(t->scroll.timer);
 }
 
 void
@@ -325,7 +363,7 @@ tp_edge_scroll_handle_state(struct tp_dispatch *tp, uint64_t time)
 	struct tp_touch *t;
 
 	if (tp->scroll.method != LIBINPUT_CONFIG_SCROLL_EDGE) {
-		tp_for_each_touch(tp, t) {
+		tp_for_each_dirty_touch(tp, t) {
 			if (t->state == TOUCH_BEGIN)
 				t->scroll.edge_state =
 					EDGE_SCROLL_TOUCH_STATE_AREA;
@@ -336,10 +374,7 @@ tp_edge_scroll_handle_state(struct tp_dispatch *tp, uint64_t time)
 		return;
 	}
 
-	tp_for_each_touch(tp, t) {
-		if (!t->dirty)
-			continue;
-
+	tp_for_each_dirty_touch(tp, t) {
 		switch (t->state) {
 		case TOUCH_NONE:
 		case TOUCH_HOVERING:
@@ -368,10 +403,7 @@ tp_edge_scroll_post_events(struct tp_dispatch *tp, uint64_t time)
 	const struct normalized_coords zero = { 0.0, 0.0 };
 	const struct discrete_coords zero_discrete = { 0.0, 0.0 };
 
-	tp_for_each_touch(tp, t) {
-		if (!t->dirty)
-			continue;
-
+	tp_for_each_dirty_touch(tp, t) {
 		if (t->palm.state != PALM_NONE)
 			continue;
 
@@ -419,7 +451,7 @@ tp_edge_scroll_post_events(struct tp_dispatch *tp, uint64_t time)
 			tmp = normalized;
 			normalized = tp_normalize_delta(tp,
 					device_delta(t->point,
-						     t->scroll.initial));
+						     t->cold->scroll.initial));
 			if (fabs(*delta) < DEFAULT_SCROLL_THRESHOLD)
 				normalized = zero;
 			else
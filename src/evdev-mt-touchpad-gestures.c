@@ -45,22 +45,28 @@ gesture_state_to_str(enum tp_gesture_state state)
 	return NULL;
 }
 
-static struct normalized_coords
-tp_get_touches_delta(struct tp_dispatch *tp, bool average)
+static void
+tp_gesture_update_frame(struct tp_dispatch *tp)
 {
 	struct tp_touch *t;
-	unsigned int i, nactive = 0;
 	struct normalized_coords normalized;
 	struct normalized_coords delta = {0.0, 0.0};
+	unsigned int nactive = 0, nreal = 0;
 
-	for (i = 0; i < tp->num_slots; i++) {
-		t = &tp->touches[i];
-
+	tp_for_each_down_touch(tp, t) {
 		if (!tp_touch_active(tp, t))
 			continue;
 
+		if (nactive < ARRAY_LENGTH(tp->gesture.frame.touches))
+			tp->gesture.frame.touches[nactive] = t;
 		nactive++;
 
+		/* fake touches don't have deltas */
+		if (tp_touch_index(tp, t) >= tp->num_slots)
+			continue;
+
+		nreal++;
+
 		if (t->dirty) {
 			normalized = tp_get_delta(t);
 
@@ -69,25 +75,14 @@ tp_get_touches_delta(struct tp_dispatch *tp, bool average)
 		}
 	}
 
-	if (!average || nactive == 0)
-		return delta;
-
-	delta.x /= nactive;
-	delta.y /= nactive;
-
-	return delta;
-}
-
-static inline struct normalized_coords
-tp_get_combined_touches_delta(struct tp_dispatch *tp)
-{
-	return tp_get_touches_delta(tp, false);
-}
-
-static inline struct normalized_coords
-tp_get_average_touches_delta(struct tp_dispatch *tp)
-{
-	return tp_get_touches_delta(tp, true);
+	tp->gesture.frame.nactive = nactive;
+	tp->gesture.frame.delta = delta;
+	tp->gesture.frame.average = delta;
+	if (nreal > 0) {
+		tp->gesture.frame.average.x /= nreal;
+		tp->gesture.frame.average.y /= nreal;
+	}
+	tp->gesture.frame.have_pinch = false;
 }
 
 static void
@@ -133,9 +128,9 @@ tp_gesture_post_pointer_motion(struct tp_dispatch *tp, uint64_t time)
 
 	/* When a clickpad is clicked, combine motion of all active touches */
 	if (tp->buttons.is_clickpad && tp->buttons.state)
-		unaccel = tp_get_combined_touches_delta(tp);
+		unaccel = tp->gesture.frame.delta;
 	else
-		unaccel = tp_get_average_touches_delta(tp);
+		unaccel = tp->gesture.frame.average;
 
 	delta = tp_filter_motion(tp, &unaccel, time);
 
@@ -148,37 +143,6 @@ tp_gesture_post_pointer_motion(struct tp_dispatch *tp, uint64_t time)
 	}
 }
 
-static unsigned int
-tp_gesture_get_active_touches(const struct tp_dispatch *tp,
-			      struct tp_touch **touches,
-			      unsigned int count)
-{
-	unsigned int n = 0;
-	struct tp_touch *t;
-
-	memset(touches, 0, count * sizeof(struct tp_touch *));
-
-	tp_for_each_touch(tp, t) {
-		if (tp_touch_active(tp, t)) {
-			touches[n++] = t;
-			if (n == count)
-				return count;
-		}
-	}
-
-	/*
-	 * This can happen when the user does .e.g:
-	 * 1) Put down 1st finger in center (so active)
-	 * 2) Put down 2nd finger in a button area (so inactive)
-	 * 3) Put down 3th finger somewhere, gets reported as a fake finger,
-	 *    so gets same coordinates as 1st -> active
-	 *
-	 * We could avoid this by looking at all touches, be we really only
-	 * want to look at real touches.
-	 */
-	return n;
-}
-
 static uint32_t
 tp_gesture_get_direction(struct tp_dispatch *tp, struct tp_touch *touch,
 			 unsigned int nfingers)
@@ -189,7 +153,7 @@ tp_gesture_get_direction(struct tp_dispatch *tp, struct tp_touch *touch,
 
 	move_threshold *= (nfingers - 1);
 
-	delta = device_delta(touch->point, touch->gesture.initial);
+	delta = device_delta(touch->point, touch->cold->gesture.initial);
 	mm = tp_phys_delta(tp, delta);
 
 	if (length_in_mm(mm) < move_threshold)
@@ -199,10 +163,7 @@ tp_gesture_get_direction(struct tp_dispatch *tp, struct tp_touch *touch,
 }
 
 static void
-tp_gesture_get_pinch_info(struct tp_dispatch *tp,
-			  double *distance,
-			  double *angle,
-			  struct device_float_coords *center)
+tp_gesture_update_frame_pinch(struct tp_dispatch *tp)
 {
 	struct normalized_coords normalized;
 	struct device_float_coords delta;
@@ -211,10 +172,27 @@ tp_gesture_get_pinch_info(struct tp_dispatch *tp,
 
 	delta = device_delta(first->point, second->point);
 	normalized = tp_normalize_delta(tp, delta);
-	*distance = normalized_length(normalized);
-	*angle = atan2(normalized.y, normalized.x) * 180.0 / M_PI;
+	tp->gesture.frame.distance = normalized_length(normalized);
+	tp->gesture.frame.angle =
+		atan2(normalized.y, normalized.x) * 180.0 / M_PI;
+	tp->gesture.frame.center = device_average(first->point, second->point);
+	tp->gesture.frame.have_pinch = true;
+}
 
-	*center = device_average(first->point, second->point);
+static void
+tp_gesture_get_pinch_info(struct tp_dispatch *tp,
+			  double *distance,
+			  double *angle,
+			  struct device_float_coords *center)
+{
+	/* Normally computed in tp_gesture_handle_state(), but the
+	 * tracked touches may have been picked after that */
+	if (!tp->gesture.frame.have_pinch)
+		tp_gesture_update_frame_pinch(tp);
+
+	*distance = tp->gesture.frame.distance;
+	*angle = tp->gesture.frame.angle;
+	*center = tp->gesture.frame.center;
 }
 
 static void
@@ -225,26 +203,54 @@ tp_gesture_set_scroll_buildup(struct tp_dispatch *tp)
 	struct tp_touch *first = tp->gesture.touches[0],
 			*second = tp->gesture.touches[1];
 
-	d0 = device_delta(first->point, first->gesture.initial);
-	d1 = device_delta(second->point, second->gesture.initial);
+	d0 = device_delta(first->point, first->cold->gesture.initial);
+	d1 = device_delta(second->point, second->cold->gesture.initial);
 
 	average = device_float_average(d0, d1);
 	tp->device->scroll.buildup = tp_normalize_delta(tp, average);
 }
 
+static inline bool
+tp_gesture_events_wanted(struct tp_dispatch *tp)
+{
+	uint64_t mask;
+
+	mask = event_listener_mask(LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN) |
+	       event_listener_mask(LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE) |
+	       event_listener_mask(LIBINPUT_EVENT_GESTURE_SWIPE_END) |
+	       event_listener_mask(LIBINPUT_EVENT_GESTURE_PINCH_BEGIN) |
+	       event_listener_mask(LIBINPUT_EVENT_GESTURE_PINCH_UPDATE) |
+	       event_listener_mask(LIBINPUT_EVENT_GESTURE_PINCH_END);
+
+	return libinput_device_event_wanted(&tp->device->base, mask);
+}
+
 static enum tp_gesture_state
 tp_gesture_handle_state_none(struct tp_dispatch *tp, uint64_t time)
 {
 	struct tp_touch *first, *second;
-	struct tp_touch *touches[4];
+	struct tp_touch **touches = tp->gesture.frame.touches;
 	unsigned int ntouches;
 	unsigned int i;
 
-	ntouches = tp_gesture_get_active_touches(tp, touches, 4);
+	/*
+	 * This can be less than the finger count when the user does .e.g:
+	 * 1) Put down 1st finger in center (so active)
+	 * 2) Put down 2nd finger in a button area (so inactive)
+	 * 3) Put down 3th finger somewhere, gets reported as a fake finger,
+	 *    so gets same coordinates as 1st -> active
+	 *
+	 * We could avoid this by looking at all touches, be we really only
+	 * want to look at real touches.
+	 */
+	ntouches = min(tp->gesture.frame.nactive,
+		       ARRAY_LENGTH(tp->gesture.frame.touches));
 	if (ntouches < 2)
 		return GESTURE_STATE_NONE;
 
-	if (!tp->gesture.enabled) {
+	/* If nobody wants swipe or pinch events, don't bother telling
+	 * them apart from two-finger scrolling */
+	if (!tp->gesture.enabled || !tp_gesture_events_wanted(tp)) {
 		if (ntouches == 2)
 			return GESTURE_STATE_SCROLL;
 		else
@@ -285,8 +291,8 @@ tp_gesture_handle_state_none(struct tp_dispatch *tp, uint64_t time)
 	}
 
 	tp->gesture.initial_time = time;
-	first->gesture.initial = first->point;
-	second->gesture.initial = second->point;
+	first->cold->gesture.initial = first->point;
+	second->cold->gesture.initial = second->point;
 	tp->gesture.touches[0] = first;
 	tp->gesture.touches[1] = second;
 
@@ -379,7 +385,7 @@ tp_gesture_handle_state_scroll(struct tp_dispatch *tp, uint64_t time)
 	if (tp->scroll.method != LIBINPUT_CONFIG_SCROLL_2FG)
 		return GESTURE_STATE_SCROLL;
 
-	delta = tp_get_average_touches_delta(tp);
+	delta = tp->gesture.frame.average;
 
 	/* scroll is not accelerated */
 	delta = tp_filter_motion_unaccelerated(tp, &delta, time);
@@ -401,7 +407,7 @@ tp_gesture_handle_state_swipe(struct tp_dispatch *tp, uint64_t time)
 {
 	struct normalized_coords delta, unaccel;
 
-	unaccel = tp_get_average_touches_delta(tp);
+	unaccel = tp->gesture.frame.average;
 	delta = tp_filter_motion(tp, &unaccel, time);
 
 	if (!normalized_is_zero(delta) || !normalized_is_zero(unaccel)) {
@@ -590,13 +596,10 @@ tp_gesture_finger_count_switch_timeout(uint64_t now, void *data)
 void
 tp_gesture_handle_state(struct tp_dispatch *tp, uint64_t time)
 {
-	unsigned int active_touches = 0;
-	struct tp_touch *t;
+	unsigned int active_touches;
 
-	tp_for_each_touch(tp, t) {
-		if (tp_touch_active(tp, t))
-			active_touches++;
-	}
+	tp_gesture_update_frame(tp);
+	active_touches = tp->gesture.frame.nactive;
 
 	if (active_touches != tp->gesture.finger_count) {
 		/* If all fingers are lifted immediately end the gesture */
@@ -617,6 +620,10 @@ tp_gesture_handle_state(struct tp_dispatch *tp, uint64_t time)
 	} else {
 		 tp->gesture.finger_count_pending = 0;
 	}
+
+	if (tp->gesture.state == GESTURE_STATE_UNKNOWN ||
+	    tp->gesture.state == GESTURE_STATE_PINCH)
+		tp_gesture_update_frame_pinch(tp);
 }
 
 void
@@ -190,6 +190,9 @@ tp_tap_touch_handle_event(struct tp_dispatch *tp,
 			      tp->tap.saved_press_time,
 			      1,
 			      LIBINPUT_BUTTON_STATE_PRESSED);
+		/* Only wait for the tap timeout if a subsequent touch
+		 * could turn this into a drag, otherwise the click is
+		 * complete now */
 		if (tp->tap.drag_enabled) {
 			tp->tap.state = TAP_STATE_TAPPED;
 			tp->tap.saved_release_time = time;
@@ -766,7 +769,7 @@ tp_tap_exceeds_motion_threshold(struct tp_dispatch *tp,
 				struct tp_touch *t)
 {
 	struct phys_coords mm =
-		tp_phys_delta(tp, device_delta(t->point, t->tap.initial));
+		tp_phys_delta(tp, device_delta(t->point, t->cold->tap.initial));
 
 	return length_in_mm(mm) > DEFAULT_TAP_MOVE_THRESHOLD;
 }
@@ -792,8 +795,8 @@ tp_tap_handle_state(struct tp_dispatch *tp, uint64_t time)
 	if (tp->buttons.is_clickpad && tp->queued & TOUCHPAD_EVENT_BUTTON_PRESS)
 		tp_tap_handle_event(tp, NULL, TAP_EVENT_BUTTON, time);
 
-	tp_for_each_touch(tp, t) {
-		if (!t->dirty || t->state == TOUCH_NONE)
+	tp_for_each_dirty_touch(tp, t) {
+		if (t->state == TOUCH_NONE)
 			continue;
 
 		if (tp->buttons.is_clickpad &&
@@ -818,7 +821,7 @@ tp_tap_handle_state(struct tp_dispatch *tp, uint64_t time)
 			}
 
 			t->tap.state = TAP_TOUCH_STATE_TOUCH;
-			t->tap.initial = t->point;
+			t->cold->tap.initial = t->point;
 			tp_tap_handle_event(tp, t, TAP_EVENT_TOUCH, time);
 
 			/* If we think this is a palm, pretend there's a
@@ -838,7 +841,7 @@ tp_tap_handle_state(struct tp_dispatch *tp, uint64_t time)
 
 			/* Any touch exceeding the threshold turns all
 			 * touches into DEAD */
-			tp_for_each_touch(tp, tmp) {
+			tp_for_each_active_touch(tp, tmp) {
 				if (tmp->tap.state == TAP_TOUCH_STATE_TOUCH)
 					tmp->tap.state = TAP_TOUCH_STATE_DEAD;
 			}
@@ -900,9 +903,8 @@ tp_tap_handle_timeout(uint64_t time, void *data)
 
 	tp_tap_handle_event(tp, NULL, TAP_EVENT_TIMEOUT, time);
 
-	tp_for_each_touch(tp, t) {
-		if (t->state == TOUCH_NONE ||
-		    t->tap.state == TAP_TOUCH_STATE_IDLE)
+	tp_for_each_active_touch(tp, t) {
+		if (t->tap.state == TAP_TOUCH_STATE_IDLE)
 			continue;
 
 		t->tap.state = TAP_TOUCH_STATE_DEAD;
@@ -1030,6 +1032,18 @@ tp_tap_config_set_drag_enabled(struct libinput_device *device,
 
 	tp->tap.drag_enabled = enabled;
 
+	/* Without tap-and-drag there is nothing left to wait for, so
+	 * don't hold on to a tap that is only waiting for its timeout */
+	if (enabled == LIBINPUT_CONFIG_DRAG_DISABLED &&
+	    (tp->tap.state == TAP_STATE_TAPPED ||
+	     tp->tap.state == TAP_STATE_MULTITAP)) {
+		tp_tap_clear_timer(tp);
+		tp_tap_handle_event(tp,
+				    NULL,
+				    TAP_EVENT_TIMEOUT,
+				    libinput_now(device->seat->libinput));
+	}
+
 	return LIBINPUT_CONFIG_STATUS_SUCCESS;
 }
 
@@ -29,6 +29,7 @@
 #include <limits.h>
 
 #include "evdev-mt-touchpad.h"
+#include "trace.h"
 
 #define DEFAULT_TRACKPOINT_ACTIVITY_TIMEOUT ms2us(300)
 #define DEFAULT_KEYBOARD_ACTIVITY_TIMEOUT_1 ms2us(200)
@@ -60,6 +61,11 @@ tp_filter_motion(struct tp_dispatch *tp,
 	 * make sure we're on the same resolution for both axes */
 	raw = tp_unnormalize_for_xaxis(tp, *unaccelerated);
 
+	trace_probe3(filter_dispatch,
+		     tp->device->sysname,
+		     filter_get_type(tp->device->pointer.filter),
+		     time);
+
 	return filter_dispatch(tp->device->pointer.filter,
 			       &raw, tp, time);
 }
@@ -94,6 +100,52 @@ tp_motion_history_push(struct tp_touch *t)
 	t->history.index = motion_index;
 }
 
+/* Many touchpads report a finger that holds still as moving back and
+ * forth by a few units. If we see a touch move right-left-right or
+ * left-right-left in quick succession, the touchpad is one of those and
+ * we enable hysteresis for the lifetime of the device. Good touchpads
+ * never trigger this and keep the full precision for slow movements. */
+static inline void
+tp_detect_wobbling(struct tp_dispatch *tp,
+		   struct tp_touch *t,
+		   uint64_t time)
+{
+	uint64_t dtime;
+	int dx;
+
+	if (tp->hysteresis.enabled)
+		return;
+
+	dtime = time - t->wobble.last_motion_time;
+	t->wobble.last_motion_time = time;
+
+	if (t->history.count == 0) {
+		t->wobble.x_history = 0;
+		return;
+	}
+
+	/* y-only motion doesn't count, wobbling shows on x */
+	dx = t->point.x - tp_motion_history_offset(t, 0)->x;
+	if (dx == 0)
+		return;
+
+	if (dtime > ms2us(40))
+		t->wobble.x_history = 0;
+
+	t->wobble.x_history = (t->wobble.x_history << 1) | (dx > 0);
+
+	switch (t->wobble.x_history & 0x7) {
+	case 0x5: /* right, left, right */
+	case 0x2: /* left, right, left */
+		tp->hysteresis.enabled = true;
+		evdev_log_info(tp->device,
+			       "wobbling touches detected, enabling hysteresis\n");
+		break;
+	default:
+		break;
+	}
+}
+
 static inline void
 tp_motion_hysteresis(struct tp_dispatch *tp,
 		     struct tp_touch *t)
@@ -101,15 +153,15 @@ tp_motion_hysteresis(struct tp_dispatch *tp,
 	int x = t->point.x,
 	    y = t->point.y;
 
-	if (t->history.count == 0) {
+	if (t->history.count == 0 || !tp->hysteresis.enabled) {
 		t->hysteresis_center = t->point;
 	} else {
 		x = evdev_hysteresis(x,
 				     t->hysteresis_center.x,
-				     tp->hysteresis_margin.x);
+				     tp->hysteresis.margin.x);
 		y = evdev_hysteresis(y,
 				     t->hysteresis_center.y,
-				     tp->hysteresis_margin.y);
+				     tp->hysteresis.margin.y);
 		t->hysteresis_center.x = x;
 		t->hysteresis_center.y = y;
 		t->point.x = x;
@@ -136,6 +188,27 @@ tp_get_touch(struct tp_dispatch *tp, unsigned int slot)
 	return &tp->touches[slot];
 }
 
+static inline void
+tp_touch_set_dirty(struct tp_dispatch *tp, struct tp_touch *t)
+{
+	t->dirty = true;
+	long_set_bit(tp->touch_mask.dirty, tp_touch_index(tp, t));
+}
+
+static inline void
+tp_touch_set_state(struct tp_dispatch *tp,
+		   struct tp_touch *t,
+		   enum touch_state state)
+{
+	unsigned int idx = tp_touch_index(tp, t);
+
+	t->state = state;
+	long_set_bit_state(tp->touch_mask.active, idx, state != TOUCH_NONE);
+	long_set_bit_state(tp->touch_mask.down,
+			   idx,
+			   state == TOUCH_BEGIN || state == TOUCH_UPDATE);
+}
+
 static inline unsigned int
 tp_fake_finger_count(struct tp_dispatch *tp)
 {
@@ -212,10 +285,10 @@ tp_new_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 	 * don't know if it's a touch down or not. And BTN_TOUCH may happen
 	 * after ABS_MT_TRACKING_ID */
 	tp_motion_history_reset(t);
-	t->dirty = true;
+	tp_touch_set_dirty(tp, t);
 	t->has_ended = false;
 	t->was_down = false;
-	t->state = TOUCH_HOVERING;
+	tp_touch_set_state(tp, t, TOUCH_HOVERING);
 	t->pinned.is_pinned = false;
 	t->millis = time;
 	tp->queued |= TOUCHPAD_EVENT_MOTION;
@@ -224,14 +297,14 @@ tp_new_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 static inline void
 tp_begin_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 {
-	t->dirty = true;
-	t->state = TOUCH_BEGIN;
+	tp_touch_set_dirty(tp, t);
+	tp_touch_set_state(tp, t, TOUCH_BEGIN);
 	t->millis = time;
 	t->was_down = true;
 	tp->nfingers_down++;
-	t->palm.time = time;
+	t->cold->palm.time = time;
 	t->thumb.state = THUMB_STATE_MAYBE;
-	t->thumb.first_touch_time = time;
+	t->cold->thumb.first_touch_time = time;
 	t->tap.is_thumb = false;
 	assert(tp->nfingers_down >= 1);
 }
@@ -244,7 +317,7 @@ tp_end_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 {
 	switch (t->state) {
 	case TOUCH_HOVERING:
-		t->state = TOUCH_NONE;
+		tp_touch_set_state(tp, t, TOUCH_NONE);
 		/* fallthough */
 	case TOUCH_NONE:
 	case TOUCH_END:
@@ -255,12 +328,12 @@ tp_end_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 
 	}
 
-	t->dirty = true;
+	tp_touch_set_dirty(tp, t);
 	t->palm.state = PALM_NONE;
-	t->state = TOUCH_END;
+	tp_touch_set_state(tp, t, TOUCH_END);
 	t->pinned.is_pinned = false;
 	t->millis = time;
-	t->palm.time = 0;
+	t->cold->palm.time = 0;
 	assert(tp->nfingers_down >= 1);
 	tp->nfingers_down--;
 	tp->queued |= TOUCHPAD_EVENT_MOTION;
@@ -301,6 +374,149 @@ tp_get_delta(struct tp_touch *t)
 	return tp_normalize_delta(t->tp, delta);
 }
 
+/* The reference classification, straight from the various thresholds.
+ * Only used to fill the zone grid, use tp_zones_lookup() instead. */
+static uint32_t
+tp_zones_classify(const struct tp_dispatch *tp, int64_t x, int64_t y)
+{
+	uint32_t zones = TP_ZONE_NONE;
+
+	if (y >= tp->buttons.bottom_area.top_edge) {
+		if (x > tp->buttons.bottom_area.rightbutton_left_edge)
+			zones |= TP_ZONE_BOTTOM_RIGHT;
+		else if (x > tp->buttons.bottom_area.middlebutton_left_edge)
+			zones |= TP_ZONE_BOTTOM_MIDDLE;
+		else
+			zones |= TP_ZONE_BOTTOM_LEFT;
+	}
+
+	if (y <= tp->buttons.top_area.bottom_edge) {
+		if (x > tp->buttons.top_area.rightbutton_left_edge)
+			zones |= TP_ZONE_TOP_RIGHT;
+		else if (x < tp->buttons.top_area.leftbutton_right_edge)
+			zones |= TP_ZONE_TOP_LEFT;
+		else
+			zones |= TP_ZONE_TOP_MIDDLE;
+	}
+
+	if (x <= tp->palm.left_edge)
+		zones |= TP_ZONE_PALM_LEFT;
+	if (x >= tp->palm.right_edge)
+		zones |= TP_ZONE_PALM_RIGHT;
+
+	if (x > tp->scroll.right_edge)
+		zones |= TP_ZONE_EDGE_RIGHT;
+	if (y > tp->scroll.bottom_edge)
+		zones |= TP_ZONE_EDGE_BOTTOM;
+
+	if (y >= tp->thumb.upper_thumb_line)
+		zones |= TP_ZONE_THUMB;
+	if (y > tp->thumb.lower_thumb_line)
+		zones |= TP_ZONE_THUMB_LOWER;
+
+	return zones;
+}
+
+/* Sorts the breakpoints and drops duplicates, returns the new count */
+static unsigned int
+tp_zones_sort_breaks(int64_t *breaks, unsigned int n)
+{
+	unsigned int i, j, count = 0;
+
+	for (i = 1; i < n; i++) {
+		int64_t b = breaks[i];
+
+		for (j = i; j > 0 && breaks[j - 1] > b; j--)
+			breaks[j] = breaks[j - 1];
+		breaks[j] = b;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (count == 0 || breaks[i] != breaks[count - 1])
+			breaks[count++] = breaks[i];
+	}
+
+	return count;
+}
+
+/* The smallest coordinate inside the given cell */
+static inline int64_t
+tp_zones_cell_origin(const int64_t *breaks, unsigned int n, unsigned int cell)
+{
+	if (n == 0)
+		return 0;
+
+	return cell == 0 ? breaks[0] - 1 : breaks[cell - 1];
+}
+
+static inline unsigned int
+tp_zones_cell(const int64_t *breaks, unsigned int n, int v)
+{
+	unsigned int cell = 0;
+
+	while (cell < n && v >= breaks[cell])
+		cell++;
+
+	return cell;
+}
+
+uint32_t
+tp_zones_lookup(const struct tp_dispatch *tp, struct device_coords point)
+{
+	unsigned int cx, cy;
+
+	cx = tp_zones_cell(tp->zones.x, tp->zones.nx, point.x);
+	cy = tp_zones_cell(tp->zones.y, tp->zones.ny, point.y);
+
+	return tp->zones.cells[cx][cy];
+}
+
+void
+tp_zones_update(struct tp_dispatch *tp)
+{
+	int64_t *x = tp->zones.x,
+		*y = tp->zones.y;
+	unsigned int nx = 0, ny = 0;
+	unsigned int cx, cy;
+	struct tp_touch *t;
+
+	/* Every threshold test in tp_zones_classify() flips at one of
+	 * these coordinates, i.e. the test is "v >= break" or its
+	 * negation. */
+	x[nx++] = (int64_t)tp->buttons.bottom_area.rightbutton_left_edge + 1;
+	x[nx++] = (int64_t)tp->buttons.bottom_area.middlebutton_left_edge + 1;
+	x[nx++] = (int64_t)tp->buttons.top_area.rightbutton_left_edge + 1;
+	x[nx++] = tp->buttons.top_area.leftbutton_right_edge;
+	x[nx++] = (int64_t)tp->palm.left_edge + 1;
+	x[nx++] = tp->palm.right_edge;
+	x[nx++] = (int64_t)tp->scroll.right_edge + 1;
+
+	y[ny++] = tp->buttons.bottom_area.top_edge;
+	y[ny++] = (int64_t)tp->buttons.top_area.bottom_edge + 1;
+	y[ny++] = (int64_t)tp->scroll.bottom_edge + 1;
+	y[ny++] = tp->thumb.upper_thumb_line;
+	y[ny++] = (int64_t)tp->thumb.lower_thumb_line + 1;
+
+	assert(nx <= TP_ZONE_MAX_BREAKS);
+	assert(ny <= TP_ZONE_MAX_BREAKS);
+
+	tp->zones.nx = tp_zones_sort_breaks(x, nx);
+	tp->zones.ny = tp_zones_sort_breaks(y, ny);
+
+	for (cx = 0; cx <= tp->zones.nx; cx++) {
+		for (cy = 0; cy <= tp->zones.ny; cy++) {
+			int64_t ox, oy;
+
+			ox = tp_zones_cell_origin(x, tp->zones.nx, cx);
+			oy = tp_zones_cell_origin(y, tp->zones.ny, cy);
+			tp->zones.cells[cx][cy] = tp_zones_classify(tp, ox, oy);
+		}
+	}
+
+	tp_for_each_active_touch(tp, t)
+		t->zones = tp_zones_lookup(tp, t->point);
+}
+
 static void
 tp_process_absolute(struct tp_dispatch *tp,
 		    const struct input_event *e,
@@ -315,7 +531,7 @@ tp_process_absolute(struct tp_dispatch *tp,
 						  e->value);
 		t->point.x = e->value;
 		t->millis = time;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case ABS_MT_POSITION_Y:
@@ -324,7 +540,7 @@ tp_process_absolute(struct tp_dispatch *tp,
 						  e->value);
 		t->point.y = e->value;
 		t->millis = time;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case ABS_MT_SLOT:
@@ -338,12 +554,12 @@ tp_process_absolute(struct tp_dispatch *tp,
 		break;
 	case ABS_MT_PRESSURE:
 		t->pressure = e->value;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_OTHERAXIS;
 		break;
 	case ABS_MT_TOOL_TYPE:
 		t->is_tool_palm = e->value == MT_TOOL_PALM;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_OTHERAXIS;
 		break;
 	}
@@ -363,7 +579,7 @@ tp_process_absolute_st(struct tp_dispatch *tp,
 						  e->value);
 		t->point.x = e->value;
 		t->millis = time;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case ABS_Y:
@@ -372,12 +588,12 @@ tp_process_absolute_st(struct tp_dispatch *tp,
 						  e->value);
 		t->point.y = e->value;
 		t->millis = time;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case ABS_PRESSURE:
 		t->pressure = e->value;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_OTHERAXIS;
 		break;
 	}
@@ -413,7 +629,7 @@ tp_restore_synaptics_touches(struct tp_dispatch *tp,
 		/* new touch, move it through begin to update immediately */
 		tp_new_touch(tp, t, time);
 		tp_begin_touch(tp, t, time);
-		t->state = TOUCH_UPDATE;
+		tp_touch_set_state(tp, t, TOUCH_UPDATE);
 	}
 }
 
@@ -513,8 +729,8 @@ tp_unpin_finger(const struct tp_dispatch *tp, struct tp_touch *t)
 	if (!t->pinned.is_pinned)
 		return;
 
-	delta.x = abs(t->point.x - t->pinned.center.x);
-	delta.y = abs(t->point.y - t->pinned.center.y);
+	delta.x = abs(t->point.x - t->cold->pinned.center.x);
+	delta.y = abs(t->point.y - t->cold->pinned.center.y);
 
 	mm = evdev_device_unit_delta_to_mm(tp->device, &delta);
 
@@ -530,9 +746,9 @@ tp_pin_fingers(struct tp_dispatch *tp)
 {
 	struct tp_touch *t;
 
-	tp_for_each_touch(tp, t) {
+	tp_for_each_active_touch(tp, t) {
 		t->pinned.is_pinned = true;
-		t->pinned.center = t->point;
+		t->cold->pinned.center = t->point;
 	}
 }
 
@@ -553,8 +769,7 @@ tp_palm_tap_is_palm(const struct tp_dispatch *tp, const struct tp_touch *t)
 	if (t->state != TOUCH_BEGIN)
 		return false;
 
-	if (t->point.x > tp->palm.left_edge &&
-	    t->point.x < tp->palm.right_edge)
+	if ((t->zones & TP_ZONE_PALM) == 0)
 		return false;
 
 	evdev_log_debug(tp->device, "palm: palm-tap detected\n");
@@ -570,7 +785,7 @@ tp_palm_detect_dwt_triggered(struct tp_dispatch *tp,
 	    tp->dwt.keyboard_active &&
 	    t->state == TOUCH_BEGIN) {
 		t->palm.state = PALM_TYPING;
-		t->palm.first = t->point;
+		t->cold->palm.first = t->point;
 		return true;
 	} else if (!tp->dwt.keyboard_active &&
 		   t->state == TOUCH_UPDATE &&
@@ -581,8 +796,8 @@ tp_palm_detect_dwt_triggered(struct tp_dispatch *tp,
 		   started once we stop typing will be able to control the
 		   pointer (alas not tap, etc.).
 		   */
-		if (t->palm.time == 0 ||
-		    t->palm.time > tp->dwt.keyboard_last_press_time) {
+		if (t->cold->palm.time == 0 ||
+		    t->cold->palm.time > tp->dwt.keyboard_last_press_time) {
 			t->palm.state = PALM_NONE;
 			evdev_log_debug(tp->device,
 					"palm: touch released, timeout after typing\n");
@@ -609,8 +824,8 @@ tp_palm_detect_trackpoint_triggered(struct tp_dispatch *tp,
 		   t->state == TOUCH_UPDATE &&
 		   !tp->palm.trackpoint_active) {
 
-		if (t->palm.time == 0 ||
-		    t->palm.time > tp->palm.trackpoint_last_event_time) {
+		if (t->cold->palm.time == 0 ||
+		    t->cold->palm.time > tp->palm.trackpoint_last_event_time) {
 			t->palm.state = PALM_NONE;
 			evdev_log_debug(tp->device,
 				       "palm: touch released, timeout after trackpoint\n");
@@ -655,9 +870,9 @@ tp_palm_detect_move_out_of_edge(struct tp_dispatch *tp,
 	struct device_float_coords delta;
 	int dirs;
 
-	if (time < t->palm.time + PALM_TIMEOUT &&
-	    (t->point.x > tp->palm.left_edge && t->point.x < tp->palm.right_edge)) {
-		delta = device_delta(t->point, t->palm.first);
+	if (time < t->cold->palm.time + PALM_TIMEOUT &&
+	    (t->zones & TP_ZONE_PALM) == 0) {
+		delta = device_delta(t->point, t->cold->palm.first);
 		dirs = phys_get_direction(tp_phys_delta(tp, delta));
 		if ((dirs & DIRECTIONS) && !(dirs & ~DIRECTIONS))
 			return true;
@@ -682,7 +897,7 @@ tp_palm_detect_multifinger(struct tp_dispatch *tp, struct tp_touch *t, uint64_t
 	 * frame the second touch will still be PALM_NONE and thus detected
 	 * here as non-palm touch. This is too niche to worry about for now.
 	 */
-	tp_for_each_touch(tp, other) {
+	tp_for_each_down_touch(tp, other) {
 		if (other == t)
 			continue;
 
@@ -723,7 +938,7 @@ tp_palm_detect_edge(struct tp_dispatch *tp,
 	/* palm must start in exclusion zone, it's ok to move into
 	   the zone without being a palm */
 	if (t->state != TOUCH_BEGIN ||
-	    (t->point.x > tp->palm.left_edge && t->point.x < tp->palm.right_edge))
+	    (t->zones & TP_ZONE_PALM) == 0)
 		return false;
 
 	/* don't detect palm in software button areas, it's
@@ -737,8 +952,8 @@ tp_palm_detect_edge(struct tp_dispatch *tp,
 		return false;
 
 	t->palm.state = PALM_EDGE;
-	t->palm.time = time;
-	t->palm.first = t->point;
+	t->cold->palm.time = time;
+	t->cold->palm.first = t->point;
 
 	return true;
 }
@@ -766,6 +981,15 @@ out:
 	if (oldstate == t->palm.state)
 		return;
 
+	/* Counted once, by the reason the touch became a palm, not again
+	 * when it moves between palm states */
+	if (oldstate == PALM_NONE)
+		libinput_device_stats_add(&tp->device->base,
+					  t->palm.state == PALM_TYPING ?
+						LIBINPUT_STAT_DWT_TOUCHES :
+						LIBINPUT_STAT_PALM_TOUCHES,
+					  1);
+
 	switch (t->palm.state) {
 	case PALM_EDGE:
 		palm_state = "edge";
@@ -811,7 +1035,7 @@ tp_thumb_detect(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 	    t->thumb.state != THUMB_STATE_MAYBE)
 		return;
 
-	if (t->point.y < tp->thumb.upper_thumb_line) {
+	if ((t->zones & TP_ZONE_THUMB) == 0) {
 		/* if a potential thumb is above the line, it won't ever
 		 * label as thumb */
 		t->thumb.state = THUMB_STATE_NO;
@@ -820,12 +1044,12 @@ tp_thumb_detect(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 
 	/* If the thumb moves by more than 7mm, it's not a resting thumb */
 	if (t->state == TOUCH_BEGIN)
-		t->thumb.initial = t->point;
+		t->cold->thumb.initial = t->point;
 	else if (t->state == TOUCH_UPDATE) {
 		struct device_float_coords delta;
 		struct phys_coords mm;
 
-		delta = device_delta(t->point, t->thumb.initial);
+		delta = device_delta(t->point, t->cold->thumb.initial);
 		mm = tp_phys_delta(tp, delta);
 		if (length_in_mm(mm) > 7) {
 			t->thumb.state = THUMB_STATE_NO;
@@ -841,9 +1065,9 @@ tp_thumb_detect(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 	 */
 	if (t->pressure > tp->thumb.threshold)
 		t->thumb.state = THUMB_STATE_YES;
-	else if (t->point.y > tp->thumb.lower_thumb_line &&
+	else if ((t->zones & TP_ZONE_THUMB_LOWER) &&
 		 tp->scroll.method != LIBINPUT_CONFIG_SCROLL_EDGE &&
-		 t->thumb.first_touch_time + THUMB_MOVE_TIMEOUT < time)
+		 t->cold->thumb.first_touch_time + THUMB_MOVE_TIMEOUT < time)
 		t->thumb.state = THUMB_STATE_YES;
 
 	/* now what? we marked it as thumb, so:
@@ -857,11 +1081,18 @@ tp_thumb_detect(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 	 *   this gets a tad complicated otherwise
 	 */
 out:
-	if (t->thumb.state != state)
-		evdev_log_debug(tp->device,
-			  "thumb state: %s → %s\n",
-			  thumb_state_to_str(state),
-			  thumb_state_to_str(t->thumb.state));
+	if (t->thumb.state == state)
+		return;
+
+	if (t->thumb.state == THUMB_STATE_YES)
+		libinput_device_stats_add(&tp->device->base,
+					  LIBINPUT_STAT_THUMB_TOUCHES,
+					  1);
+
+	evdev_log_debug(tp->device,
+			"thumb state: %s → %s\n",
+			thumb_state_to_str(state),
+			thumb_state_to_str(t->thumb.state));
 }
 
 static void
@@ -1048,8 +1279,8 @@ tp_position_fake_touches(struct tp_dispatch *tp)
 
 		t->point = topmost->point;
 		t->pressure = topmost->pressure;
-		if (!t->dirty)
-			t->dirty = topmost->dirty;
+		if (topmost->dirty)
+			tp_touch_set_dirty(tp, t);
 	}
 }
 
@@ -1125,6 +1356,7 @@ static void
 tp_process_state(struct tp_dispatch *tp, uint64_t time)
 {
 	struct tp_touch *t;
+	struct device_coords point;
 	bool restart_filter = false;
 	bool want_motion_reset;
 
@@ -1134,7 +1366,9 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 
 	want_motion_reset = tp_need_motion_history_reset(tp);
 
-	tp_for_each_touch(tp, t) {
+	/* Touches in TOUCH_NONE have their history reset in
+	 * tp_new_touch(), no need to look at them here */
+	tp_for_each_active_touch(tp, t) {
 		if (want_motion_reset) {
 			tp_motion_history_reset(t);
 			t->quirks.reset_motion_history = true;
@@ -1146,6 +1380,8 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 		if (!t->dirty)
 			continue;
 
+		t->zones = tp_zones_lookup(tp, t->point);
+
 		if (tp_detect_jumps(tp, t)) {
 			if (!tp->semi_mt)
 				evdev_log_bug_kernel(tp->device,
@@ -1158,7 +1394,12 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 		tp_thumb_detect(tp, t, time);
 		tp_palm_detect(tp, t, time);
 
+		tp_detect_wobbling(tp, t, time);
+
+		point = t->point;
 		tp_motion_hysteresis(tp, t);
+		if (point.x != t->point.x || point.y != t->point.y)
+			t->zones = tp_zones_lookup(tp, t->point);
 		tp_motion_history_push(t);
 
 		tp_unpin_finger(tp, t);
@@ -1191,22 +1432,21 @@ tp_post_process_state(struct tp_dispatch *tp, uint64_t time)
 {
 	struct tp_touch *t;
 
-	tp_for_each_touch(tp, t) {
-
-		if (!t->dirty)
-			continue;
-
+	tp_for_each_dirty_touch(tp, t) {
 		if (t->state == TOUCH_END) {
 			if (t->has_ended)
-				t->state = TOUCH_NONE;
+				tp_touch_set_state(tp, t, TOUCH_NONE);
 			else
-				t->state = TOUCH_HOVERING;
+				tp_touch_set_state(tp, t, TOUCH_HOVERING);
 		} else if (t->state == TOUCH_BEGIN) {
-			t->state = TOUCH_UPDATE;
+			tp_touch_set_state(tp, t, TOUCH_UPDATE);
 		}
 
 		t->dirty = false;
 	}
+	memset(tp->touch_mask.dirty,
+	       0,
+	       tp->touch_mask.nlongs * sizeof(*tp->touch_mask.dirty));
 
 	tp->old_nfingers_down = tp->nfingers_down;
 	tp->buttons.old_state = tp->buttons.state;
@@ -1248,11 +1488,15 @@ static void
 tp_handle_state(struct tp_dispatch *tp,
 		uint64_t time)
 {
+	trace_probe2(tp_handle_state_begin, tp->device->sysname, time);
+
 	tp_process_state(tp, time);
 	tp_post_events(tp, time);
 	tp_post_process_state(tp, time);
 
 	tp_clickpad_middlebutton_apply_config(tp->device);
+
+	trace_probe2(tp_handle_state_end, tp->device->sysname, time);
 }
 
 static inline void
@@ -1344,7 +1588,12 @@ tp_interface_destroy(struct evdev_dispatch *dispatch)
 {
 	struct tp_dispatch *tp = tp_dispatch(dispatch);
 
+	free(tp->touch_mask.dirty);
+	free(tp->touch_timers.button);
+	free(tp->touch_timers.scroll);
+	free(tp->dwt.keys);
 	free(tp->touches);
+	free(tp->touches_cold);
 	free(tp);
 }
 
@@ -1438,11 +1687,6 @@ tp_trackpoint_event(uint64_t time, struct libinput_event *event, void *data)
 {
 	struct tp_dispatch *tp = data;
 
-	/* Buttons do not count as trackpad activity, as people may use
-	   the trackpoint buttons in combination with the touchpad. */
-	if (event->type == LIBINPUT_EVENT_POINTER_BUTTON)
-		return;
-
 	tp->palm.trackpoint_last_event_time = time;
 	tp->palm.trackpoint_event_count++;
 
@@ -1455,8 +1699,8 @@ tp_trackpoint_event(uint64_t time, struct libinput_event *event, void *data)
 		tp->palm.trackpoint_active = true;
 	}
 
-	libinput_timer_set(&tp->palm.trackpoint_timer,
-			   time + DEFAULT_TRACKPOINT_ACTIVITY_TIMEOUT);
+	libinput_timer_extend(&tp->palm.trackpoint_timer,
+			      time + DEFAULT_TRACKPOINT_ACTIVITY_TIMEOUT);
 }
 
 static void
@@ -1465,8 +1709,8 @@ tp_keyboard_timeout(uint64_t now, void *data)
 	struct tp_dispatch *tp = data;
 
 	if (tp->dwt.dwt_enabled &&
-	    long_any_bit_set(tp->dwt.key_mask,
-			     ARRAY_LENGTH(tp->dwt.key_mask))) {
+	    long_any_bit_set(tp->dwt.keys->key_mask,
+			     ARRAY_LENGTH(tp->dwt.keys->key_mask))) {
 		libinput_timer_set(&tp->dwt.keyboard_timer,
 				   now + DEFAULT_KEYBOARD_ACTIVITY_TIMEOUT_2);
 		tp->dwt.keyboard_last_press_time = now;
@@ -1526,17 +1770,14 @@ tp_keyboard_event(uint64_t time, struct libinput_event *event, void *data)
 	unsigned int key;
 	bool is_modifier;
 
-	if (event->type != LIBINPUT_EVENT_KEYBOARD_KEY)
-		return;
-
 	kbdev = libinput_event_get_keyboard_event(event);
 	key = libinput_event_keyboard_get_key(kbdev);
 
 	/* Only trigger the timer on key down. */
 	if (libinput_event_keyboard_get_key_state(kbdev) !=
 	    LIBINPUT_KEY_STATE_PRESSED) {
-		long_clear_bit(tp->dwt.key_mask, key);
-		long_clear_bit(tp->dwt.mod_mask, key);
+		long_clear_bit(tp->dwt.keys->key_mask, key);
+		long_clear_bit(tp->dwt.keys->mod_mask, key);
 		return;
 	}
 
@@ -1550,7 +1791,7 @@ tp_keyboard_event(uint64_t time, struct libinput_event *event, void *data)
 	 * ctrl+zoom or ctrl+click are possible */
 	is_modifier = tp_key_is_modifier(key);
 	if (is_modifier) {
-		long_set_bit(tp->dwt.mod_mask, key);
+		long_set_bit(tp->dwt.keys->mod_mask, key);
 		return;
 	}
 
@@ -1560,8 +1801,8 @@ tp_keyboard_event(uint64_t time, struct libinput_event *event, void *data)
 		 * trigger dwt because it's likely to be combination like
 		 * Ctrl+S or similar */
 
-		if (long_any_bit_set(tp->dwt.mod_mask,
-				     ARRAY_LENGTH(tp->dwt.mod_mask)))
+		if (long_any_bit_set(tp->dwt.keys->mod_mask,
+				     ARRAY_LENGTH(tp->dwt.keys->mod_mask)))
 		    return;
 
 		tp_stop_actions(tp, time);
@@ -1572,9 +1813,9 @@ tp_keyboard_event(uint64_t time, struct libinput_event *event, void *data)
 	}
 
 	tp->dwt.keyboard_last_press_time = time;
-	long_set_bit(tp->dwt.key_mask, key);
-	libinput_timer_set(&tp->dwt.keyboard_timer,
-			   time + timeout);
+	long_set_bit(tp->dwt.keys->key_mask, key);
+	libinput_timer_extend(&tp->dwt.keyboard_timer,
+			      time + timeout);
 }
 
 static bool
@@ -1630,14 +1871,18 @@ tp_dwt_pair_keyboard(struct evdev_device *touchpad,
 		if (bus_kbd != BUS_I8042)
 			return;
 
-		memset(tp->dwt.key_mask, 0, sizeof(tp->dwt.key_mask));
-		memset(tp->dwt.mod_mask, 0, sizeof(tp->dwt.mod_mask));
+		memset(tp->dwt.keys, 0, sizeof(*tp->dwt.keys));
 		libinput_device_remove_event_listener(&tp->dwt.keyboard_listener);
+	} else if (!tp->dwt.keys) {
+		tp->dwt.keys = zalloc(sizeof(*tp->dwt.keys));
+		if (!tp->dwt.keys)
+			return;
 	}
 
 	libinput_device_add_event_listener(&keyboard->base,
-				&tp->dwt.keyboard_listener,
-				tp_keyboard_event, tp);
+			&tp->dwt.keyboard_listener,
+			event_listener_mask(LIBINPUT_EVENT_KEYBOARD_KEY),
+			tp_keyboard_event, tp);
 	tp->dwt.keyboard = keyboard;
 	tp->dwt.keyboard_active = false;
 
@@ -1655,6 +1900,13 @@ tp_pair_trackpoint(struct evdev_device *touchpad,
 	unsigned int bus_tp = libevdev_get_id_bustype(touchpad->evdev),
 		     bus_trp = libevdev_get_id_bustype(trackpoint->evdev);
 	bool tp_is_internal, trp_is_internal;
+	uint64_t mask;
+
+	/* Buttons do not count as trackpad activity, as people may use
+	   the trackpoint buttons in combination with the touchpad. */
+	mask = event_listener_mask(LIBINPUT_EVENT_POINTER_MOTION) |
+	       event_listener_mask(LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE) |
+	       event_listener_mask(LIBINPUT_EVENT_POINTER_AXIS);
 
 	if ((trackpoint->tags & EVDEV_TAG_TRACKPOINT) == 0)
 		return;
@@ -1670,6 +1922,7 @@ tp_pair_trackpoint(struct evdev_device *touchpad,
 		if (tp->palm.monitor_trackpoint)
 			libinput_device_add_event_listener(&trackpoint->base,
 						&tp->palm.trackpoint_listener,
+						mask,
 						tp_trackpoint_event, tp);
 	}
 }
@@ -1680,9 +1933,6 @@ tp_lid_switch_event(uint64_t time, struct libinput_event *event, void *data)
 	struct tp_dispatch *tp = data;
 	struct libinput_event_switch *swev;
 
-	if (libinput_event_get_type(event) != LIBINPUT_EVENT_SWITCH_TOGGLE)
-		return;
-
 	swev = libinput_event_get_switch_event(event);
 	switch (libinput_event_switch_get_switch_state(swev)) {
 	case LIBINPUT_SWITCH_STATE_OFF:
@@ -1712,8 +1962,9 @@ tp_pair_lid_switch(struct evdev_device *touchpad,
 				lid_switch->devname);
 
 		libinput_device_add_event_listener(&lid_switch->base,
-					&tp->lid_switch.lid_switch_listener,
-					tp_lid_switch_event, tp);
+			&tp->lid_switch.lid_switch_listener,
+			event_listener_mask(LIBINPUT_EVENT_SWITCH_TOGGLE),
+			tp_lid_switch_event, tp);
 		tp->lid_switch.lid_switch = lid_switch;
 	}
 }
@@ -1891,10 +2142,12 @@ static struct evdev_dispatch_interface tp_interface = {
 
 static void
 tp_init_touch(struct tp_dispatch *tp,
-	      struct tp_touch *t)
+	      struct tp_touch *t,
+	      struct tp_touch_cold *cold)
 {
 	t->tp = tp;
 	t->has_ended = true;
+	t->cold = cold;
 }
 
 static void
@@ -2007,8 +2260,21 @@ tp_init_slots(struct tp_dispatch *tp,
 	if (!tp->touches)
 		return false;
 
+	tp->touches_cold = calloc(tp->ntouches, sizeof(struct tp_touch_cold));
+	if (!tp->touches_cold)
+		return false;
+
 	for (i = 0; i < tp->ntouches; i++)
-		tp_init_touch(tp, &tp->touches[i]);
+		tp_init_touch(tp, &tp->touches[i], &tp->touches_cold[i]);
+
+	/* one allocation for all three masks, see tp_interface_destroy() */
+	tp->touch_mask.nlongs = NLONGS(tp->ntouches);
+	tp->touch_mask.dirty = calloc(3 * tp->touch_mask.nlongs,
+				      sizeof(unsigned long));
+	if (!tp->touch_mask.dirty)
+		return false;
+	tp->touch_mask.active = tp->touch_mask.dirty + tp->touch_mask.nlongs;
+	tp->touch_mask.down = tp->touch_mask.active + tp->touch_mask.nlongs;
 
 	/* Always sync the first touch so we get ABS_X/Y synced on
 	 * single-touch touchpads */
@@ -2076,7 +2342,11 @@ tp_init_accel(struct tp_dispatch *tp)
 	    tp->device->model_flags & EVDEV_MODEL_LENOVO_X220_TOUCHPAD_FW81)
 		filter = create_pointer_accelerator_filter_lenovo_x230(tp->device->dpi);
 	else
+#if HAVE_FIXED_POINT_ACCEL
+		filter = create_pointer_accelerator_filter_touchpad_fixed(tp->device->dpi);
+#else
 		filter = create_pointer_accelerator_filter_touchpad(tp->device->dpi);
+#endif
 
 	if (!filter)
 		return false;
@@ -2130,6 +2400,10 @@ tp_scroll_config_scroll_method_set_method(struct libinput_device *device,
 	if (method == tp->scroll.method)
 		return LIBINPUT_CONFIG_STATUS_SUCCESS;
 
+	if (method == LIBINPUT_CONFIG_SCROLL_EDGE &&
+	    !tp_edge_scroll_init_timers(tp))
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
 	tp_edge_scroll_stop_events(tp, time);
 	tp_gesture_stop_twofinger_scroll(tp, time);
 
@@ -2176,7 +2450,7 @@ tp_scroll_config_scroll_method_get_default_method(struct libinput_device *device
 	return tp_scroll_get_default_method(tp);
 }
 
-static void
+static bool
 tp_init_scroll(struct tp_dispatch *tp, struct evdev_device *device)
 {
 	tp_edge_scroll_init(tp, device);
@@ -2189,10 +2463,15 @@ tp_init_scroll(struct tp_dispatch *tp, struct evdev_device *device)
 	tp->scroll.config_method.get_default_method = tp_scroll_config_scroll_method_get_default_method;
 	tp->scroll.method = tp_scroll_get_default_method(tp);
 	tp->device->base.config.scroll_method = &tp->scroll.config_method;
+	if (tp->scroll.method == LIBINPUT_CONFIG_SCROLL_EDGE &&
+	    !tp_edge_scroll_init_timers(tp))
+		return false;
 
 	 /* In mm for touchpads with valid resolution, see tp_init_accel() */
 	tp->device->scroll.threshold = 0.0;
 	tp->device->scroll.direction_lock_threshold = 5.0;
+
+	return true;
 }
 
 static int
@@ -2336,10 +2615,13 @@ tp_init_sendevents(struct tp_dispatch *tp,
 	libinput_timer_init(&tp->palm.trackpoint_timer,
 			    tp_libinput_context(tp),
 			    tp_trackpoint_timeout, tp);
+	libinput_timer_set_slack(&tp->palm.trackpoint_timer,
+				 TIMER_SLACK_LONG);
 
 	libinput_timer_init(&tp->dwt.keyboard_timer,
 			    tp_libinput_context(tp),
 			    tp_keyboard_timeout, tp);
+	libinput_timer_set_slack(&tp->dwt.keyboard_timer, TIMER_SLACK_LONG);
 }
 
 static void
@@ -2465,8 +2747,9 @@ tp_init_hysteresis(struct tp_dispatch *tp)
 
 	res_x = tp->device->abs.absinfo_x->resolution;
 	res_y = tp->device->abs.absinfo_y->resolution;
-	tp->hysteresis_margin.x = res_x/2;
-	tp->hysteresis_margin.y = res_y/2;
+	tp->hysteresis.margin.x = res_x/2;
+	tp->hysteresis.margin.y = res_y/2;
+	tp->hysteresis.enabled = false;
 }
 
 static void
@@ -2558,13 +2841,16 @@ tp_init(struct tp_dispatch *tp,
 		return false;
 
 	tp_init_tap(tp);
-	tp_init_buttons(tp, device);
+	if (!tp_init_buttons(tp, device))
+		return false;
 	tp_init_dwt(tp, device);
 	tp_init_palmdetect(tp, device);
 	tp_init_sendevents(tp, device);
-	tp_init_scroll(tp, device);
+	if (!tp_init_scroll(tp, device))
+		return false;
 	tp_init_gesture(tp);
 	tp_init_thumb(tp);
+	tp_zones_update(tp);
 
 	device->seat_caps |= EVDEV_DEVICE_POINTER;
 	if (tp->gesture.enabled)
@@ -132,24 +132,85 @@ enum tp_gesture_state {
 	GESTURE_STATE_SWIPE,
 };
 
+/* Touchpad areas a touch position may be in, see tp_zones_update() */
+enum tp_zone {
+	TP_ZONE_NONE			= 0,
+	TP_ZONE_BOTTOM_LEFT		= (1 << 0),	/* softbuttons */
+	TP_ZONE_BOTTOM_MIDDLE		= (1 << 1),
+	TP_ZONE_BOTTOM_RIGHT		= (1 << 2),
+	TP_ZONE_TOP_LEFT		= (1 << 3),	/* top softbuttons */
+	TP_ZONE_TOP_MIDDLE		= (1 << 4),
+	TP_ZONE_TOP_RIGHT		= (1 << 5),
+	TP_ZONE_PALM_LEFT		= (1 << 6),	/* palm exclusion zones */
+	TP_ZONE_PALM_RIGHT		= (1 << 7),
+	TP_ZONE_EDGE_RIGHT		= (1 << 8),	/* edge scrolling */
+	TP_ZONE_EDGE_BOTTOM		= (1 << 9),
+	TP_ZONE_THUMB			= (1 << 10),	/* below upper thumb line */
+	TP_ZONE_THUMB_LOWER		= (1 << 11),	/* below lower thumb line */
+};
+
+#define TP_ZONE_BOTTOM (TP_ZONE_BOTTOM_LEFT|TP_ZONE_BOTTOM_MIDDLE|TP_ZONE_BOTTOM_RIGHT)
+#define TP_ZONE_TOP (TP_ZONE_TOP_LEFT|TP_ZONE_TOP_MIDDLE|TP_ZONE_TOP_RIGHT)
+#define TP_ZONE_PALM (TP_ZONE_PALM_LEFT|TP_ZONE_PALM_RIGHT)
+#define TP_ZONE_MAX_BREAKS 8
+
 enum tp_thumb_state {
 	THUMB_STATE_NO,
 	THUMB_STATE_YES,
 	THUMB_STATE_MAYBE,
 };
 
+/* The keys currently down on the paired keyboard */
+struct tp_dwt_keys {
+	unsigned long key_mask[NLONGS(KEY_CNT)];
+	unsigned long mod_mask[NLONGS(KEY_CNT)];
+};
+
+/* Per-touch state that is only read when a touch begins, changes state
+ * or triggers a threshold check. It lives in a separate array, so the
+ * per-frame passes over struct tp_touch touch fewer cache lines. */
+struct tp_touch_cold {
+	struct {
+		struct device_coords initial;
+	} tap;
+
+	struct {
+		struct device_coords initial;
+	} scroll;
+
+	struct {
+		struct device_coords first; /* first coordinates as palm */
+		uint64_t time; /* first timestamp as palm */
+	} palm;
+
+	struct {
+		struct device_coords initial;
+	} gesture;
+
+	struct {
+		uint64_t first_touch_time;
+		struct device_coords initial;
+	} thumb;
+
+	/* see struct tp_touch.pinned */
+	struct {
+		struct device_coords center;
+	} pinned;
+};
+
 struct tp_touch {
+	/* Fields accessed by every per-frame pass come first */
 	struct tp_dispatch *tp;
 	enum touch_state state;
 	bool has_ended;				/* TRACKING_ID == -1 */
 	bool dirty;
-	struct device_coords point;
-	uint64_t millis;
-	int pressure;
 	bool is_tool_palm; /* MT_TOOL_PALM */
-
 	bool was_down; /* if distance == 0, false for pure hovering
 			  touches */
+	struct device_coords point;
+	uint64_t millis;
+	int pressure;
+	uint32_t zones;		/* enum tp_zone, for point, once processed */
 
 	struct {
 		/* A quirk mostly used on Synaptics touchpads. In a
@@ -168,13 +229,19 @@ struct tp_touch {
 
 	struct device_coords hysteresis_center;
 
+	/* Jitter detection, see tp_detect_wobbling() */
+	struct {
+		uint64_t last_motion_time;
+		/* one bit per x motion, 1 for right, newest in bit 0 */
+		unsigned int x_history;
+	} wobble;
+
 	/* A pinned touchpoint is the one that pressed the physical button
 	 * on a clickpad. After the release, it won't move until the center
 	 * moves more than a threshold away from the original coordinates
 	 */
 	struct {
 		bool is_pinned;
-		struct device_coords center;
 	} pinned;
 
 	/* Software-button state and timeout if applicable */
@@ -182,12 +249,11 @@ struct tp_touch {
 		enum button_state state;
 		/* We use button_event here so we can use == on events */
 		enum button_event curr;
-		struct libinput_timer timer;
+		struct libinput_timer *timer;	/* NULL until needed */
 	} button;
 
 	struct {
 		enum tp_tap_touch_state state;
-		struct device_coords initial;
 		bool is_thumb;
 	} tap;
 
@@ -195,25 +261,18 @@ struct tp_touch {
 		enum tp_edge_scroll_touch_state edge_state;
 		uint32_t edge;
 		int direction;
-		struct libinput_timer timer;
-		struct device_coords initial;
+		struct libinput_timer *timer;	/* NULL until needed */
 	} scroll;
 
 	struct {
 		enum touch_palm_state state;
-		struct device_coords first; /* first coordinates if is_palm == true */
-		uint64_t time; /* first timestamp if is_palm == true */
 	} palm;
 
-	struct {
-		struct device_coords initial;
-	} gesture;
-
 	struct {
 		enum tp_thumb_state state;
-		uint64_t first_touch_time;
-		struct device_coords initial;
 	} thumb;
+
+	struct tp_touch_cold *cold;
 };
 
 struct tp_dispatch {
@@ -232,6 +291,18 @@ struct tp_dispatch {
 	unsigned int num_slots;			/* number of slots */
 	unsigned int ntouches;			/* no slots inc. fakes */
 	struct tp_touch *touches;		/* len == ntouches */
+	struct tp_touch_cold *touches_cold;	/* len == ntouches */
+
+	/* The per-touch timers are only accessed when armed or when they
+	 * fire, they live outside of struct tp_touch so the per-frame touch
+	 * data stays compact. Each array is allocated when the feature
+	 * using it is first enabled, many touchpads never need either.
+	 * len == ntouches */
+	struct {
+		struct libinput_timer *button;	/* software buttons */
+		struct libinput_timer *scroll;	/* edge scrolling */
+	} touch_timers;
+
 	/* bit 0: BTN_TOUCH
 	 * bit 1: BTN_TOOL_FINGER
 	 * bit 2: BTN_TOOL_DOUBLETAP
@@ -239,6 +310,19 @@ struct tp_dispatch {
 	 */
 	unsigned int fake_touches;
 
+	/* Bitmasks indexed by touch index into tp->touches, so per-frame
+	 * passes only visit touches that matter.
+	 * dirty: touch was modified in the current frame, mirrors t->dirty
+	 * active: touch state is anything but TOUCH_NONE
+	 * down: touch state is TOUCH_BEGIN or TOUCH_UPDATE
+	 */
+	struct {
+		unsigned long *dirty;
+		unsigned long *active;
+		unsigned long *down;
+		size_t nlongs;
+	} touch_mask;
+
 	/* if pressure goes above high -> touch down,
 	   if pressure then goes below low -> touch up */
 	struct {
@@ -247,7 +331,24 @@ struct tp_dispatch {
 		int low;
 	} pressure;
 
-	struct device_coords hysteresis_margin;
+	struct {
+		struct device_coords margin;
+		/* Off until a wobbling touch is seen, then stays on */
+		bool enabled;
+	} hysteresis;
+
+	/* The button, palm, edge scroll and thumb thresholds split the
+	 * touchpad into a grid of cells. x and y are the sorted cell
+	 * boundaries, each cell holds the enum tp_zone mask shared by all
+	 * points inside it. Rebuilt by tp_zones_update() whenever a
+	 * threshold changes.
+	 */
+	struct {
+		int64_t x[TP_ZONE_MAX_BREAKS];
+		int64_t y[TP_ZONE_MAX_BREAKS];
+		unsigned int nx, ny;
+		uint32_t cells[TP_ZONE_MAX_BREAKS + 1][TP_ZONE_MAX_BREAKS + 1];
+	} zones;
 
 	struct {
 		double x_scale_coeff;
@@ -267,6 +368,23 @@ struct tp_dispatch {
 		double prev_scale;
 		double angle;
 		struct device_float_coords center;
+
+		/* Filled in once per frame by tp_gesture_handle_state(),
+		 * read by the gesture states and the 2fg scroll code */
+		struct {
+			unsigned int nactive;
+			/* the first few active touches */
+			struct tp_touch *touches[4];
+			/* sum of the active touch deltas */
+			struct normalized_coords delta;
+			struct normalized_coords average;
+
+			/* between tp->gesture.touches[0] and [1] */
+			bool have_pinch;
+			double distance;
+			double angle;
+			struct device_float_coords center;
+		} frame;
 	} gesture;
 
 	struct {
@@ -358,8 +476,7 @@ struct tp_dispatch {
 		struct libinput_event_listener keyboard_listener;
 		struct libinput_timer keyboard_timer;
 		struct evdev_device *keyboard;
-		unsigned long key_mask[NLONGS(KEY_CNT)];
-		unsigned long mod_mask[NLONGS(KEY_CNT)];
+		struct tp_dwt_keys *keys; /* NULL until a keyboard is paired */
 
 		uint64_t keyboard_last_press_time;
 	} dwt;
@@ -399,6 +516,57 @@ tp_dispatch(struct evdev_dispatch *dispatch)
 #define tp_for_each_touch(_tp, _t) \
 	for (unsigned int _i = 0; _i < (_tp)->ntouches && (_t = &(_tp)->touches[_i]); _i++)
 
+static inline unsigned int
+tp_touch_index(const struct tp_dispatch *tp, const struct tp_touch *t)
+{
+	return t - tp->touches;
+}
+
+/**
+ * @return the index of the first bit set in mask at or after start, or
+ * tp->ntouches if there is none
+ */
+static inline unsigned int
+tp_touch_mask_next(const struct tp_dispatch *tp,
+		   const unsigned long *mask,
+		   unsigned int start)
+{
+	size_t idx = start / LONG_BITS;
+	unsigned long bits;
+
+	if (start >= tp->ntouches)
+		return tp->ntouches;
+
+	bits = mask[idx] & (~0UL << (start % LONG_BITS));
+	while (bits == 0) {
+		if (++idx >= tp->touch_mask.nlongs)
+			return tp->ntouches;
+		bits = mask[idx];
+	}
+
+	return min(idx * LONG_BITS + __builtin_ctzl(bits), tp->ntouches);
+}
+
+/* Iterates over the touches set in the given mask in ascending order. The
+ * loop body may modify the mask, the next touch is looked up after the
+ * body ran. */
+#define tp_for_each_touch_in_mask(_tp, _t, _mask) \
+	for (unsigned int _i = tp_touch_mask_next((_tp), (_mask), 0); \
+	     _i < (_tp)->ntouches && (_t = &(_tp)->touches[_i]); \
+	     _i = tp_touch_mask_next((_tp), (_mask), _i + 1))
+
+/* Touches with t->dirty set */
+#define tp_for_each_dirty_touch(_tp, _t) \
+	tp_for_each_touch_in_mask(_tp, _t, (_tp)->touch_mask.dirty)
+
+/* Touches in any state but TOUCH_NONE */
+#define tp_for_each_active_touch(_tp, _t) \
+	tp_for_each_touch_in_mask(_tp, _t, (_tp)->touch_mask.active)
+
+/* Touches in TOUCH_BEGIN or TOUCH_UPDATE */
+#define tp_for_each_down_touch(_tp, _t) \
+	tp_for_each_touch_in_mask(_tp, _t, (_tp)->touch_mask.down)
+
 static inline struct libinput*
 tp_libinput_context(const struct tp_dispatch *tp)
 {
@@ -448,6 +616,12 @@ tp_unnormalize_for_xaxis(const struct tp_dispatch *tp,
 struct normalized_coords
 tp_get_delta(struct tp_touch *t);
 
+void
+tp_zones_update(struct tp_dispatch *tp);
+
+uint32_t
+tp_zones_lookup(const struct tp_dispatch *tp, struct device_coords point);
+
 struct normalized_coords
 tp_filter_motion(struct tp_dispatch *tp,
 		 const struct normalized_coords *unaccelerated,
@@ -473,7 +647,7 @@ tp_init_tap(struct tp_dispatch *tp);
 void
 tp_remove_tap(struct tp_dispatch *tp);
 
-void
+bool
 tp_init_buttons(struct tp_dispatch *tp, struct evdev_device *device);
 
 void
@@ -526,6 +700,9 @@ tp_edge_scroll_init(struct tp_dispatch *tp, struct evdev_device *device);
 void
 tp_remove_edge_scroll(struct tp_dispatch *tp);
 
+bool
+tp_edge_scroll_init_timers(struct tp_dispatch *tp);
+
 void
 tp_edge_scroll_handle_state(struct tp_dispatch *tp, uint64_t time);
 
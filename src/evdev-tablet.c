@@ -23,6 +23,7 @@
 #include "config.h"
 #include "libinput-version.h"
 #include "evdev-tablet.h"
+#include "trace.h"
 
 #include <assert.h>
 #include <stdbool.h>
@@ -76,50 +77,6 @@ tablet_force_button_presses(struct tablet_dispatch *tablet)
 	}
 }
 
-static inline size_t
-tablet_history_size(const struct tablet_dispatch *tablet)
-{
-	return ARRAY_LENGTH(tablet->history.samples);
-}
-
-static inline void
-tablet_history_reset(struct tablet_dispatch *tablet)
-{
-	tablet->history.count = 0;
-}
-
-static inline void
-tablet_history_push(struct tablet_dispatch *tablet,
-		    const struct tablet_axes *axes)
-{
-	unsigned int index = (tablet->history.index + 1) %
-				tablet_history_size(tablet);
-
-	tablet->history.samples[index] = *axes;
-	tablet->history.index = index;
-	tablet->history.count = min(tablet->history.count + 1,
-				    tablet_history_size(tablet));
-
-	if (tablet->history.count < tablet_history_size(tablet))
-		tablet_history_push(tablet, axes);
-}
-
-/**
- * Return a previous axis state, where index of 0 means "most recent", 1 is
- * "one before most recent", etc.
- */
-static inline const struct tablet_axes*
-tablet_history_get(const struct tablet_dispatch *tablet, unsigned int index)
-{
-	size_t sz = tablet_history_size(tablet);
-
-	assert(index < sz);
-	assert(index < tablet->history.count);
-
-	index = (tablet->history.index + sz - index) % sz;
-	return &tablet->history.samples[index];
-}
-
 static inline void
 tablet_reset_changed_axes(struct tablet_dispatch *tablet)
 {
@@ -446,6 +403,11 @@ tablet_tool_process_delta(struct tablet_dispatch *tablet,
 	if (device_float_is_zero(accel))
 		return zero;
 
+	trace_probe3(filter_dispatch,
+		     device->sysname,
+		     filter_get_type(device->pointer.filter),
+		     time);
+
 	return filter_dispatch(device->pointer.filter,
 			       &accel,
 			       tool,
@@ -590,28 +552,41 @@ tablet_update_wheel(struct tablet_dispatch *tablet,
 }
 
 static void
-tablet_smoothen_axes(const struct tablet_dispatch *tablet,
-		     struct tablet_axes *axes)
-{
-	size_t i;
-	size_t count = tablet_history_size(tablet);
-	struct tablet_axes smooth = { 0 };
+tablet_smoothen_axes(struct tablet_dispatch *tablet,
+		     struct libinput_tablet_tool *tool,
+		     struct tablet_axes *axes,
+		     uint64_t time)
+{
+	struct smoothing_filter *filter = &tablet->smoothing;
+	struct smoothing_sample sample, smooth;
+	enum smoothing_mode mode;
+
+	/* the config lives in the tool, pick up any change */
+	if (tool->smoothing.mode ==
+	    LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_ADAPTIVE)
+		mode = SMOOTHING_ADAPTIVE;
+	else
+		mode = SMOOTHING_BOX;
 
-	for (i = 0; i < count; i++) {
-		const struct tablet_axes *a = tablet_history_get(tablet, i);
+	/* a new algorithm starts from scratch, a new strength only changes
+	 * the cutoff so the current stroke doesn't jump */
+	if (mode != filter->mode)
+		smoothing_init(filter,
+			       mode,
+			       tool->smoothing.strength,
+			       filter->resolution);
+	else if (tool->smoothing.strength != filter->strength)
+		smoothing_set_strength(filter, tool->smoothing.strength);
 
-		smooth.point.x += a->point.x;
-		smooth.point.y += a->point.y;
+	sample.point.x = tablet->axes.point.x;
+	sample.point.y = tablet->axes.point.y;
+	sample.tilt = tablet->axes.tilt;
 
-		smooth.tilt.x += a->tilt.x;
-		smooth.tilt.y += a->tilt.y;
-	}
+	smooth = smoothing_dispatch(filter, &sample, time);
 
-	axes->point.x = smooth.point.x/count;
-	axes->point.y = smooth.point.y/count;
-
-	axes->tilt.x = smooth.tilt.x/count;
-	axes->tilt.y = smooth.tilt.y/count;
+	axes->point.x = smooth.point.x;
+	axes->point.y = smooth.point.y;
+	axes->tilt = smooth.tilt;
 }
 
 static bool
@@ -652,8 +627,7 @@ tablet_check_notify_axes(struct tablet_dispatch *tablet,
 	rc = true;
 
 out:
-	tablet_history_push(tablet, &tablet->axes);
-	tablet_smoothen_axes(tablet, &axes);
+	tablet_smoothen_axes(tablet, tool, &axes, time);
 
 	/* The delta relies on the last *smooth* point, so we do it last */
 	axes.delta = tablet_tool_process_delta(tablet, tool, device, &axes, time);
@@ -1042,6 +1016,10 @@ tablet_get_tool(struct tablet_dispatch *tablet,
 			.serial = serial,
 			.tool_id = tool_id,
 			.refcount = 1,
+			.smoothing.mode =
+				LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_AVERAGE,
+			.smoothing.strength =
+				TABLET_TOOL_SMOOTHING_DEFAULT_STRENGTH,
 		};
 
 		tool->pressure_offset = 0;
@@ -1509,6 +1487,19 @@ tablet_send_buttons(struct tablet_dispatch *tablet,
 	}
 }
 
+static inline bool
+tablet_tool_events_wanted(struct evdev_device *device)
+{
+	uint64_t mask;
+
+	mask = event_listener_mask(LIBINPUT_EVENT_TABLET_TOOL_AXIS) |
+	       event_listener_mask(LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY) |
+	       event_listener_mask(LIBINPUT_EVENT_TABLET_TOOL_TIP) |
+	       event_listener_mask(LIBINPUT_EVENT_TABLET_TOOL_BUTTON);
+
+	return libinput_device_event_wanted(&device->base, mask);
+}
+
 static void
 tablet_send_events(struct tablet_dispatch *tablet,
 		   struct libinput_tablet_tool *tool,
@@ -1527,6 +1518,22 @@ tablet_send_events(struct tablet_dispatch *tablet,
 		/* Dont' send an axis event, but we may have a tip event
 		 * update */
 		tablet_unset_status(tablet, TABLET_AXES_UPDATED);
+	} else if (!tablet_tool_events_wanted(device)) {
+		/* Nobody sees the axes, skip normalizing, smoothing and
+		 * accelerating them. The wheel is per-frame, drop it. */
+		axes = tablet->axes;
+		tablet->axes.wheel_discrete = 0;
+		tablet_unset_status(tablet, TABLET_AXES_UPDATED);
+		tablet_set_status(tablet, TABLET_AXES_SKIPPED);
+	} else if (tablet_has_status(tablet, TABLET_AXES_SKIPPED)) {
+		/* Catch up on everything we skipped, without a delta
+		 * spanning the gap */
+		tablet_mark_all_axes_changed(tablet, tool);
+		smoothing_reset(&tablet->smoothing);
+		tablet_check_notify_axes(tablet, device, tool, &axes, time);
+		axes.delta.x = 0;
+		axes.delta.y = 0;
+		tablet_unset_status(tablet, TABLET_AXES_SKIPPED);
 	} else {
 		tablet_check_notify_axes(tablet, device, tool, &axes, time);
 	}
@@ -1545,7 +1552,7 @@ tablet_send_events(struct tablet_dispatch *tablet,
 
 	if (tablet_send_proximity_out(tablet, tool, device, &axes, time)) {
 		tablet_change_to_left_handed(device);
-		tablet_history_reset(tablet);
+		smoothing_reset(&tablet->smoothing);
 	}
 }
 
@@ -1914,6 +1921,11 @@ tablet_init(struct tablet_dispatch *tablet,
 
 	tablet_init_left_handed(device);
 
+	smoothing_init(&tablet->smoothing,
+		       SMOOTHING_BOX,
+		       TABLET_TOOL_SMOOTHING_DEFAULT_STRENGTH,
+		       device->abs.absinfo_x->resolution);
+
 	for (axis = LIBINPUT_TABLET_TOOL_AXIS_X;
 	     axis <= LIBINPUT_TABLET_TOOL_AXIS_MAX;
 	     axis++) {
@@ -25,12 +25,12 @@
 #define EVDEV_TABLET_H
 
 #include "evdev.h"
+#include "filter-smoothing.h"
 
 #define LIBINPUT_TABLET_TOOL_AXIS_NONE 0
 #define LIBINPUT_TOOL_NONE 0
 #define LIBINPUT_TABLET_TOOL_TYPE_MAX LIBINPUT_TABLET_TOOL_TYPE_LENS
 
-#define TABLET_HISTORY_LENGTH 4
 
 enum tablet_status {
 	TABLET_NONE = 0,
@@ -44,6 +44,7 @@ enum tablet_status {
 	TABLET_TOOL_ENTERING_CONTACT = 1 << 7,
 	TABLET_TOOL_LEAVING_CONTACT = 1 << 8,
 	TABLET_TOOL_OUT_OF_RANGE = 1 << 9,
+	TABLET_AXES_SKIPPED = 1 << 10, /* nobody wanted tool events */
 };
 
 struct button_state {
@@ -57,11 +58,7 @@ struct tablet_dispatch {
 	unsigned char changed_axes[NCHARS(LIBINPUT_TABLET_TOOL_AXIS_MAX + 1)];
 	struct tablet_axes axes; /* for assembling the current state */
 	struct device_coords last_smooth_point;
-	struct {
-		unsigned int index;
-		unsigned int count;
-		struct tablet_axes samples[TABLET_HISTORY_LENGTH];
-	} history;
+	struct smoothing_filter smoothing;
 
 	unsigned char axis_caps[NCHARS(LIBINPUT_TABLET_TOOL_AXIS_MAX + 1)];
 	int current_value[LIBINPUT_TABLET_TOOL_AXIS_MAX + 1];
@@ -42,6 +42,7 @@
 #include "evdev.h"
 #include "filter.h"
 #include "libinput-private.h"
+#include "trace.h"
 
 #if HAVE_LIBWACOM
 #include <libwacom/libwacom.h>
@@ -477,6 +478,10 @@ fallback_flush_relative_motion(struct fallback_dispatch *dispatch,
 
 	if (device->pointer.filter) {
 		/* Apply pointer acceleration. */
+		trace_probe3(filter_dispatch,
+			     device->sysname,
+			     filter_get_type(device->pointer.filter),
+			     time);
 		accel = filter_dispatch(device->pointer.filter,
 					&raw,
 					device,
@@ -532,17 +537,19 @@ fallback_flush_mt_down(struct fallback_dispatch *dispatch,
 		return false;
 	}
 
-	seat_slot = ffs(~seat->slot_map) - 1;
+	seat_slot = libinput_seat_alloc_slot(seat);
 	slot->seat_slot = seat_slot;
 
 	if (seat_slot == -1)
 		return false;
 
-	seat->slot_map |= 1 << seat_slot;
 	point = slot->point;
 	slot->hysteresis_center = point;
 	evdev_transform_absolute(device, &point);
 
+	slot->notified_point = point;
+	motion_prediction_reset(&slot->prediction, time);
+
 	touch_notify_touch_down(base, time, slot_idx, seat_slot,
 				&point);
 
@@ -557,6 +564,7 @@ fallback_flush_mt_motion(struct fallback_dispatch *dispatch,
 {
 	struct libinput_device *base = &device->base;
 	struct device_coords point;
+	struct device_float_coords delta, velocity;
 	struct mt_slot *slot;
 	int seat_slot;
 
@@ -574,8 +582,15 @@ fallback_flush_mt_motion(struct fallback_dispatch *dispatch,
 		return false;
 
 	evdev_transform_absolute(device, &point);
+
+	delta = device_delta(point, slot->notified_point);
+	motion_prediction_update(&slot->prediction, time, delta.x, delta.y);
+	slot->notified_point = point;
+	velocity.x = slot->prediction.vx;
+	velocity.y = slot->prediction.vy;
+
 	touch_notify_touch_motion(base, time, slot_idx, seat_slot,
-				  &point);
+				  &point, &velocity);
 
 	return true;
 }
@@ -601,7 +616,7 @@ fallback_flush_mt_up(struct fallback_dispatch *dispatch,
 	if (seat_slot == -1)
 		return false;
 
-	seat->slot_map &= ~(1 << seat_slot);
+	libinput_seat_release_slot(seat, seat_slot);
 
 	touch_notify_touch_up(base, time, slot_idx, seat_slot);
 
@@ -627,17 +642,18 @@ fallback_flush_st_down(struct fallback_dispatch *dispatch,
 		return false;
 	}
 
-	seat_slot = ffs(~seat->slot_map) - 1;
+	seat_slot = libinput_seat_alloc_slot(seat);
 	dispatch->abs.seat_slot = seat_slot;
 
 	if (seat_slot == -1)
 		return false;
 
-	seat->slot_map |= 1 << seat_slot;
-
 	point = dispatch->abs.point;
 	evdev_transform_absolute(device, &point);
 
+	dispatch->abs.notified_point = point;
+	motion_prediction_reset(&dispatch->abs.prediction, time);
+
 	touch_notify_touch_down(base, time, -1, seat_slot, &point);
 
 	return true;
@@ -650,6 +666,7 @@ fallback_flush_st_motion(struct fallback_dispatch *dispatch,
 {
 	struct libinput_device *base = &device->base;
 	struct device_coords point;
+	struct device_float_coords delta, velocity;
 	int seat_slot;
 
 	point = dispatch->abs.point;
@@ -660,7 +677,17 @@ fallback_flush_st_motion(struct fallback_dispatch *dispatch,
 	if (seat_slot == -1)
 		return false;
 
-	touch_notify_touch_motion(base, time, -1, seat_slot, &point);
+	delta = device_delta(point, dispatch->abs.notified_point);
+	motion_prediction_update(&dispatch->abs.prediction,
+				 time,
+				 delta.x,
+				 delta.y);
+	dispatch->abs.notified_point = point;
+	velocity.x = dispatch->abs.prediction.vx;
+	velocity.y = dispatch->abs.prediction.vy;
+
+	touch_notify_touch_motion(base, time, -1, seat_slot,
+				  &point, &velocity);
 
 	return true;
 }
@@ -683,7 +710,7 @@ fallback_flush_st_up(struct fallback_dispatch *dispatch,
 	if (seat_slot == -1)
 		return false;
 
-	seat->slot_map &= ~(1 << seat_slot);
+	libinput_seat_release_slot(seat, seat_slot);
 
 	touch_notify_touch_up(base, time, -1, seat_slot);
 
@@ -1871,6 +1898,13 @@ evdev_process_event(struct evdev_device *device, struct input_event *e)
 			  e->value);
 #endif
 
+	if (e->type == EV_SYN && e->code == SYN_REPORT) {
+		libinput_device_stats_add(&device->base,
+					  LIBINPUT_STAT_FRAMES,
+					  1);
+		trace_probe2(frame, device->sysname, time);
+	}
+
 	dispatch->interface->process(dispatch, device, e, time);
 }
 
@@ -1903,6 +1937,9 @@ evdev_sync_device(struct evdev_device *device)
 					 LIBEVDEV_READ_FLAG_SYNC, &ev);
 		if (rc < 0)
 			break;
+		libinput_device_stats_add(&device->base,
+					  LIBINPUT_STAT_KERNEL_EVENTS,
+					  1);
 		evdev_device_dispatch_one(device, &ev);
 	} while (rc == LIBEVDEV_READ_STATUS_SYNC);
 
@@ -1915,8 +1952,13 @@ evdev_device_dispatch(void *data)
 	struct evdev_device *device = data;
 	struct libinput *libinput = evdev_libinput_context(device);
 	struct input_event ev;
+	uint64_t start, now;
 	int rc;
 
+	start = libinput_now(libinput);
+
+	trace_probe2(dispatch_begin, device->sysname, start);
+
 	/* If the compositor is repainting, this function is called only once
 	 * per frame and we have to process all the events available on the
 	 * fd, otherwise there will be input lag. */
@@ -1924,6 +1966,9 @@ evdev_device_dispatch(void *data)
 		rc = libevdev_next_event(device->evdev,
 					 LIBEVDEV_READ_FLAG_NORMAL, &ev);
 		if (rc == LIBEVDEV_READ_STATUS_SYNC) {
+			libinput_device_stats_add(&device->base,
+						  LIBINPUT_STAT_SYN_DROPPED,
+						  1);
 			evdev_log_info_ratelimit(device,
 						 &device->syn_drop_limit,
 						 "SYN_DROPPED event - some input events have been lost.\n");
@@ -1938,6 +1983,9 @@ evdev_device_dispatch(void *data)
 			if (rc == 0)
 				rc = LIBEVDEV_READ_STATUS_SUCCESS;
 		} else if (rc == LIBEVDEV_READ_STATUS_SUCCESS) {
+			libinput_device_stats_add(&device->base,
+						  LIBINPUT_STAT_KERNEL_EVENTS,
+						  1);
 			evdev_device_dispatch_one(device, &ev);
 		}
 	} while (rc == LIBEVDEV_READ_STATUS_SUCCESS);
@@ -1946,6 +1994,14 @@ evdev_device_dispatch(void *data)
 		libinput_remove_source(libinput, device->source);
 		device->source = NULL;
 	}
+
+	now = libinput_now(libinput);
+	if (start != 0 && now > start)
+		libinput_device_stats_add(&device->base,
+					  LIBINPUT_STAT_DISPATCH_TIME_US,
+					  now - start);
+
+	trace_probe3(dispatch_end, device->sysname, rc, now);
 }
 
 static inline bool
@@ -1956,12 +2012,21 @@ evdev_init_accel(struct evdev_device *device,
 
 	if (which == LIBINPUT_CONFIG_ACCEL_PROFILE_FLAT)
 		filter = create_pointer_accelerator_filter_flat(device->dpi);
+#if HAVE_FIXED_POINT_ACCEL
+	else if (device->tags & EVDEV_TAG_TRACKPOINT)
+		filter = create_pointer_accelerator_filter_trackpoint_fixed(device->dpi);
+	else if (device->dpi < DEFAULT_MOUSE_DPI)
+		filter = create_pointer_accelerator_filter_linear_low_dpi_fixed(device->dpi);
+	else
+		filter = create_pointer_accelerator_filter_linear_fixed(device->dpi);
+#else
 	else if (device->tags & EVDEV_TAG_TRACKPOINT)
 		filter = create_pointer_accelerator_filter_trackpoint(device->dpi);
 	else if (device->dpi < DEFAULT_MOUSE_DPI)
 		filter = create_pointer_accelerator_filter_linear_low_dpi(device->dpi);
 	else
 		filter = create_pointer_accelerator_filter_linear(device->dpi);
+#endif
 
 	if (!filter)
 		return false;
@@ -2890,6 +2955,7 @@ evdev_device_create(struct libinput_seat *seat,
 	device->dispatch = NULL;
 	device->fd = fd;
 	device->devname = libevdev_get_name(device->evdev);
+	device->sysname = udev_device_get_sysname(device->udev_device);
 	device->scroll.threshold = 5.0; /* Default may be overridden */
 	device->scroll.direction_lock_threshold = 5.0; /* Default may be overridden */
 	device->scroll.direction = 0;
@@ -2949,7 +3015,7 @@ evdev_device_get_output(struct evdev_device *device)
 const char *
 evdev_device_get_sysname(struct evdev_device *device)
 {
-	return udev_device_get_sysname(device->udev_device);
+	return device->sysname;
 }
 
 const char *
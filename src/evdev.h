@@ -88,6 +88,9 @@ enum evdev_middlebutton_state {
 	MIDDLEBUTTON_PASSTHROUGH,
 };
 
+/* Number of chord intervals used to adjust the middle button timeout */
+#define MIDDLEBUTTON_CHORD_HISTORY 32
+
 enum evdev_middlebutton_event {
 	MIDDLEBUTTON_EVENT_L_DOWN,
 	MIDDLEBUTTON_EVENT_R_DOWN,
@@ -139,6 +142,10 @@ struct mt_slot {
 	int32_t seat_slot;
 	struct device_coords point;
 	struct device_coords hysteresis_center;
+
+	/* last transformed point sent to the caller */
+	struct device_coords notified_point;
+	struct motion_prediction prediction;
 };
 
 struct evdev_device {
@@ -151,6 +158,7 @@ struct evdev_device {
 	struct udev_device *udev_device;
 	char *output_name;
 	const char *devname;
+	const char *sysname;
 	bool was_removed;
 	int fd;
 	enum evdev_device_seat_capability seat_caps;
@@ -241,6 +249,18 @@ struct evdev_device {
 		struct libinput_timer timer;
 		uint32_t button_mask;
 		uint64_t first_event_time;
+
+		/* The current timeout, adjusted to the user's chords */
+		uint64_t timeout;
+		struct {
+			/* ring buffer of left/right press intervals */
+			uint64_t intervals[MIDDLEBUTTON_CHORD_HISTORY];
+			unsigned int count;
+			unsigned int next;
+			/* the first button timed out, the second button
+			 * may still arrive within the maximum timeout */
+			bool missed;
+		} chord;
 	} middlebutton;
 };
 
@@ -339,6 +359,10 @@ struct fallback_dispatch {
 		struct device_coords point;
 		int32_t seat_slot;
 
+		/* last transformed point sent to the caller */
+		struct device_coords notified_point;
+		struct motion_prediction prediction;
+
 		struct {
 			struct device_coords min, max;
 			struct ratelimit range_warn_limit;
@@ -566,6 +590,9 @@ evdev_middlebutton_is_available(struct libinput_device *device);
 enum libinput_config_middle_emulation_state
 evdev_middlebutton_get_default(struct libinput_device *device);
 
+uint64_t
+evdev_middlebutton_get_timeout(struct libinput_device *device);
+
 static inline double
 evdev_convert_to_mm(const struct input_absinfo *absinfo, double v)
 {
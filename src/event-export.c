@@ -0,0 +1,698 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "libinput-private.h"
+#include "libinput-export.h"
+#include "event-export.h"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+#ifndef F_SEAL_FUTURE_WRITE
+#define F_SEAL_FUTURE_WRITE 0x0010
+#endif
+
+#define EVENT_EXPORT_MAX_RECORDS 65536
+#define EVENT_EXPORT_DEVICES 64
+
+struct event_export {
+	int fd;
+	size_t size;
+	struct libinput_export_header *header;
+	struct libinput_export_device *devices;
+	struct libinput_export_record *records;
+	uint32_t mask;
+
+	uint64_t head;
+	uint64_t notified; /* head at the last notification */
+
+	/* devices are announced once per export, see
+	 * event_export_device_id() */
+	uint32_t generation;
+	uint32_t next_device_id;
+
+	int *notify_fds;
+	size_t nnotify_fds;
+};
+
+static uint32_t export_generation;
+
+static_assert(sizeof(struct libinput_export_header) == 64,
+	      "export header size changed");
+static_assert(sizeof(struct libinput_export_device) == 128,
+	      "export device size changed");
+static_assert(sizeof(struct libinput_export_record) == 128,
+	      "export record size changed");
+
+static int
+memfd_create_sealable(const char *name)
+{
+#ifdef SYS_memfd_create
+	return syscall(SYS_memfd_create, name, MFD_CLOEXEC|MFD_ALLOW_SEALING);
+#else
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+/* F_SEAL_FUTURE_WRITE keeps our own writable mapping working but stops
+ * anyone from creating a new one or writing through the fd, so the
+ * readers can't corrupt the records for each other. It needs Linux 5.1,
+ * on older kernels the readers are trusted not to write. */
+static int
+memfd_seal(int fd)
+{
+	const int seals = F_SEAL_SHRINK|F_SEAL_GROW|F_SEAL_SEAL;
+
+	if (fcntl(fd, F_ADD_SEALS, seals|F_SEAL_FUTURE_WRITE) == 0)
+		return 0;
+
+	if (errno != EINVAL)
+		return -1;
+
+	return fcntl(fd, F_ADD_SEALS, seals);
+}
+
+struct event_export *
+event_export_create(unsigned int nrecords)
+{
+	struct event_export *export;
+	unsigned int n = 1;
+	int fd = -1;
+	int saved_errno;
+
+	if (nrecords == 0 || nrecords > EVENT_EXPORT_MAX_RECORDS) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	while (n < nrecords)
+		n <<= 1;
+
+	export = zalloc(sizeof *export);
+	if (!export)
+		return NULL;
+
+	export->fd = -1;
+	export->size = sizeof(*export->header) +
+		       EVENT_EXPORT_DEVICES * sizeof(*export->devices) +
+		       n * sizeof(*export->records);
+
+	fd = memfd_create_sealable("libinput-export");
+	if (fd < 0)
+		goto error;
+
+	if (ftruncate(fd, export->size) < 0)
+		goto error;
+
+	export->header = mmap(NULL,
+			      export->size,
+			      PROT_READ|PROT_WRITE,
+			      MAP_SHARED,
+			      fd,
+			      0);
+	if (export->header == MAP_FAILED) {
+		export->header = NULL;
+		goto error;
+	}
+
+	/* Sealed after mapping it, the size can't change underneath the
+	 * readers' mappings */
+	if (memfd_seal(fd) < 0)
+		goto error;
+
+	export->fd = fd;
+	fd = -1;
+
+	export->devices = (struct libinput_export_device *)(export->header + 1);
+	export->records = (struct libinput_export_record *)
+				&export->devices[EVENT_EXPORT_DEVICES];
+	export->mask = n - 1;
+	export->header->magic = LIBINPUT_EXPORT_MAGIC;
+	export->header->version = LIBINPUT_EXPORT_VERSION;
+	export->header->record_size = sizeof(*export->records);
+	export->header->nrecords = n;
+	export->header->ndevices = EVENT_EXPORT_DEVICES;
+	__atomic_store_n(&export->header->head, 0, __ATOMIC_RELEASE);
+
+	export->generation = __atomic_add_fetch(&export_generation,
+						1,
+						__ATOMIC_RELAXED);
+
+	return export;
+
+error:
+	saved_errno = errno;
+	if (fd >= 0)
+		close(fd);
+	event_export_destroy(export);
+	errno = saved_errno;
+
+	return NULL;
+}
+
+void
+event_export_destroy(struct event_export *export)
+{
+	if (!export)
+		return;
+
+	if (export->header)
+		munmap(export->header, export->size);
+	if (export->fd >= 0)
+		close(export->fd);
+	free(export->notify_fds);
+	free(export);
+}
+
+int
+event_export_get_fd(struct event_export *export)
+{
+	return export->fd;
+}
+
+static inline struct libinput_export_record *
+event_export_begin(struct event_export *export,
+		   enum libinput_event_type type,
+		   uint32_t device,
+		   uint64_t time)
+{
+	struct libinput_export_record *record;
+
+	record = &export->records[export->head & export->mask];
+
+	/* A reader that checks the sequence after reading the record
+	 * sees a mismatch from here on */
+	__atomic_store_n(&record->sequence, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	record->time = time;
+	record->type = type;
+	record->device = device;
+	memset(&record->u, 0, sizeof(record->u));
+
+	return record;
+}
+
+static inline void
+event_export_commit(struct event_export *export,
+		    struct libinput_export_record *record)
+{
+	export->head++;
+	__atomic_store_n(&record->sequence, export->head, __ATOMIC_RELEASE);
+	__atomic_store_n(&export->header->head, export->head, __ATOMIC_RELEASE);
+}
+
+static void
+event_export_write_device(struct event_export *export,
+			  enum libinput_event_type type,
+			  struct libinput_device *device)
+{
+	struct libinput_export_record *record;
+
+	record = event_export_begin(export, type, device->export.id, 0);
+	snprintf(record->u.device.sysname,
+		 sizeof(record->u.device.sysname),
+		 "%s",
+		 libinput_device_get_sysname(device));
+	snprintf(record->u.device.name,
+		 sizeof(record->u.device.name),
+		 "%s",
+		 libinput_device_get_name(device));
+	event_export_commit(export, record);
+}
+
+/* The device table entries use the same seqlock as the records */
+static void
+event_export_write_device_entry(struct event_export *export,
+				struct libinput_device *device,
+				bool removed)
+{
+	struct libinput_export_device *entry;
+	uint32_t sequence;
+
+	if (device->export.slot < 0)
+		return;
+
+	entry = &export->devices[device->export.slot];
+	sequence = entry->sequence + 1;
+
+	__atomic_store_n(&entry->sequence, sequence, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	entry->id = device->export.id;
+	entry->removed = removed;
+	snprintf(entry->sysname,
+		 sizeof(entry->sysname),
+		 "%s",
+		 libinput_device_get_sysname(device));
+	snprintf(entry->name,
+		 sizeof(entry->name),
+		 "%s",
+		 libinput_device_get_name(device));
+
+	__atomic_store_n(&entry->sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+/* Use an unused entry if there is one, otherwise the entry of the device
+ * that was removed first. Live devices are never evicted. */
+static int
+event_export_find_device_slot(struct event_export *export)
+{
+	struct libinput_export_device *entry;
+	int slot = -1;
+	int i;
+
+	for (i = 0; i < EVENT_EXPORT_DEVICES; i++) {
+		entry = &export->devices[i];
+
+		if (entry->id == 0)
+			return i;
+
+		if (entry->removed &&
+		    (slot == -1 || entry->id < export->devices[slot].id))
+			slot = i;
+	}
+
+	return slot;
+}
+
+/* Device ids are only valid within one export. A device that was added
+ * before the export was enabled gets a device added record before its
+ * first event. Either way it is added to the device table for readers
+ * that never see that record. */
+static uint32_t
+event_export_device_id(struct event_export *export,
+		       struct libinput_event *event)
+{
+	struct libinput_device *device = libinput_event_get_device(event);
+
+	if (device->export.generation == export->generation)
+		return device->export.id;
+
+	device->export.generation = export->generation;
+	device->export.id = ++export->next_device_id;
+	device->export.slot = event_export_find_device_slot(export);
+	event_export_write_device_entry(export, device, false);
+
+	if (libinput_event_get_type(event) != LIBINPUT_EVENT_DEVICE_ADDED)
+		event_export_write_device(export,
+					  LIBINPUT_EVENT_DEVICE_ADDED,
+					  device);
+
+	return device->export.id;
+}
+
+static void
+export_keyboard(struct libinput_export_record *record,
+		struct libinput_event_keyboard *event)
+{
+	record->time = libinput_event_keyboard_get_time_usec(event);
+	record->u.keyboard.key = libinput_event_keyboard_get_key(event);
+	record->u.keyboard.state = libinput_event_keyboard_get_key_state(event);
+	record->u.keyboard.seat_key_count =
+		libinput_event_keyboard_get_seat_key_count(event);
+}
+
+static void
+export_pointer(struct libinput_export_record *record,
+	       struct libinput_event_pointer *event)
+{
+	enum libinput_pointer_axis axis;
+
+	record->time = libinput_event_pointer_get_time_usec(event);
+
+	switch (record->type) {
+	case LIBINPUT_EVENT_POINTER_MOTION:
+		record->u.motion.dx = libinput_event_pointer_get_dx(event);
+		record->u.motion.dy = libinput_event_pointer_get_dy(event);
+		record->u.motion.dx_unaccelerated =
+			libinput_event_pointer_get_dx_unaccelerated(event);
+		record->u.motion.dy_unaccelerated =
+			libinput_event_pointer_get_dy_unaccelerated(event);
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+		record->u.absolute.x =
+			libinput_event_pointer_get_absolute_x(event);
+		record->u.absolute.y =
+			libinput_event_pointer_get_absolute_y(event);
+		break;
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+		record->u.button.button =
+			libinput_event_pointer_get_button(event);
+		record->u.button.state =
+			libinput_event_pointer_get_button_state(event);
+		record->u.button.seat_button_count =
+			libinput_event_pointer_get_seat_button_count(event);
+		break;
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		record->u.axis.source =
+			libinput_event_pointer_get_axis_source(event);
+		for (axis = LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL;
+		     axis <= LIBINPUT_POINTER_AXIS_SCROLL_HORIZONTAL;
+		     axis++) {
+			if (!libinput_event_pointer_has_axis(event, axis))
+				continue;
+
+			record->u.axis.axes |= 1 << axis;
+			record->u.axis.value[axis] =
+				libinput_event_pointer_get_axis_value(event,
+								      axis);
+			record->u.axis.discrete[axis] =
+				libinput_event_pointer_get_axis_value_discrete(
+									event,
+									axis);
+		}
+		break;
+	default:
+		abort();
+	}
+}
+
+static void
+export_touch(struct libinput_export_record *record,
+	     struct libinput_event_touch *event)
+{
+	record->time = libinput_event_touch_get_time_usec(event);
+
+	if (record->type == LIBINPUT_EVENT_TOUCH_FRAME) {
+		record->u.touch.slot = -1;
+		record->u.touch.seat_slot = -1;
+		return;
+	}
+
+	record->u.touch.slot = libinput_event_touch_get_slot(event);
+	record->u.touch.seat_slot = libinput_event_touch_get_seat_slot(event);
+
+	if (record->type == LIBINPUT_EVENT_TOUCH_DOWN ||
+	    record->type == LIBINPUT_EVENT_TOUCH_MOTION) {
+		record->u.touch.x = libinput_event_touch_get_x(event);
+		record->u.touch.y = libinput_event_touch_get_y(event);
+	}
+}
+
+static void
+export_tablet_tool(struct libinput_export_record *record,
+		   struct libinput_event_tablet_tool *event)
+{
+	struct libinput_tablet_tool *tool;
+
+	tool = libinput_event_tablet_tool_get_tool(event);
+
+	record->time = libinput_event_tablet_tool_get_time_usec(event);
+	record->u.tablet_tool.serial = libinput_tablet_tool_get_serial(tool);
+	record->u.tablet_tool.tool_type = libinput_tablet_tool_get_type(tool);
+	record->u.tablet_tool.proximity_state =
+		libinput_event_tablet_tool_get_proximity_state(event);
+	record->u.tablet_tool.tip_state =
+		libinput_event_tablet_tool_get_tip_state(event);
+	record->u.tablet_tool.x = libinput_event_tablet_tool_get_x(event);
+	record->u.tablet_tool.y = libinput_event_tablet_tool_get_y(event);
+	record->u.tablet_tool.pressure =
+		libinput_event_tablet_tool_get_pressure(event);
+	record->u.tablet_tool.distance =
+		libinput_event_tablet_tool_get_distance(event);
+	record->u.tablet_tool.tilt_x =
+		libinput_event_tablet_tool_get_tilt_x(event);
+	record->u.tablet_tool.tilt_y =
+		libinput_event_tablet_tool_get_tilt_y(event);
+	record->u.tablet_tool.rotation =
+		libinput_event_tablet_tool_get_rotation(event);
+	record->u.tablet_tool.slider =
+		libinput_event_tablet_tool_get_slider_position(event);
+	record->u.tablet_tool.wheel_delta =
+		libinput_event_tablet_tool_get_wheel_delta(event);
+
+	if (record->type == LIBINPUT_EVENT_TABLET_TOOL_BUTTON) {
+		record->u.tablet_tool.button =
+			libinput_event_tablet_tool_get_button(event);
+		record->u.tablet_tool.button_state =
+			libinput_event_tablet_tool_get_button_state(event);
+	}
+}
+
+static void
+export_tablet_pad(struct libinput_export_record *record,
+		  struct libinput_event_tablet_pad *event)
+{
+	record->time = libinput_event_tablet_pad_get_time_usec(event);
+	record->u.tablet_pad.mode = libinput_event_tablet_pad_get_mode(event);
+
+	switch (record->type) {
+	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
+		record->u.tablet_pad.number =
+			libinput_event_tablet_pad_get_button_number(event);
+		record->u.tablet_pad.button_state =
+			libinput_event_tablet_pad_get_button_state(event);
+		break;
+	case LIBINPUT_EVENT_TABLET_PAD_RING:
+		record->u.tablet_pad.number =
+			libinput_event_tablet_pad_get_ring_number(event);
+		record->u.tablet_pad.source =
+			libinput_event_tablet_pad_get_ring_source(event);
+		record->u.tablet_pad.position =
+			libinput_event_tablet_pad_get_ring_position(event);
+		break;
+	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
+		record->u.tablet_pad.number =
+			libinput_event_tablet_pad_get_strip_number(event);
+		record->u.tablet_pad.source =
+			libinput_event_tablet_pad_get_strip_source(event);
+		record->u.tablet_pad.position =
+			libinput_event_tablet_pad_get_strip_position(event);
+		break;
+	default:
+		abort();
+	}
+}
+
+static void
+export_gesture(struct libinput_export_record *record,
+	       struct libinput_event_gesture *event)
+{
+	enum libinput_event_type type = record->type;
+
+	record->time = libinput_event_gesture_get_time_usec(event);
+	record->u.gesture.finger_count =
+		libinput_event_gesture_get_finger_count(event);
+	record->u.gesture.dx = libinput_event_gesture_get_dx(event);
+	record->u.gesture.dy = libinput_event_gesture_get_dy(event);
+	record->u.gesture.dx_unaccelerated =
+		libinput_event_gesture_get_dx_unaccelerated(event);
+	record->u.gesture.dy_unaccelerated =
+		libinput_event_gesture_get_dy_unaccelerated(event);
+
+	if (type == LIBINPUT_EVENT_GESTURE_SWIPE_END ||
+	    type == LIBINPUT_EVENT_GESTURE_PINCH_END)
+		record->u.gesture.cancelled =
+			libinput_event_gesture_get_cancelled(event);
+
+	if (type == LIBINPUT_EVENT_GESTURE_PINCH_BEGIN ||
+	    type == LIBINPUT_EVENT_GESTURE_PINCH_UPDATE ||
+	    type == LIBINPUT_EVENT_GESTURE_PINCH_END) {
+		record->u.gesture.scale =
+			libinput_event_gesture_get_scale(event);
+		record->u.gesture.angle_delta =
+			libinput_event_gesture_get_angle_delta(event);
+	}
+}
+
+static void
+export_switch(struct libinput_export_record *record,
+	      struct libinput_event_switch *event)
+{
+	record->time = libinput_event_switch_get_time_usec(event);
+	record->u.switch_toggle.sw = libinput_event_switch_get_switch(event);
+	record->u.switch_toggle.state =
+		libinput_event_switch_get_switch_state(event);
+}
+
+void
+event_export_write(struct event_export *export, struct libinput_event *event)
+{
+	enum libinput_event_type type = libinput_event_get_type(event);
+	struct libinput_export_record *record;
+	uint32_t device;
+
+	if (!libinput_event_get_device(event))
+		return;
+
+	device = event_export_device_id(export, event);
+
+	switch (type) {
+	case LIBINPUT_EVENT_NONE:
+		return;
+	case LIBINPUT_EVENT_DEVICE_ADDED:
+		event_export_write_device(export,
+					  type,
+					  libinput_event_get_device(event));
+		return;
+	case LIBINPUT_EVENT_DEVICE_REMOVED:
+		event_export_write_device(export,
+					  type,
+					  libinput_event_get_device(event));
+		event_export_write_device_entry(export,
+						libinput_event_get_device(event),
+						true);
+		return;
+	default:
+		break;
+	}
+
+	record = event_export_begin(export, type, device, 0);
+
+	switch (type) {
+	case LIBINPUT_EVENT_NONE:
+	case LIBINPUT_EVENT_DEVICE_ADDED:
+	case LIBINPUT_EVENT_DEVICE_REMOVED:
+		abort();
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		export_keyboard(record,
+				libinput_event_get_keyboard_event(event));
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION:
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		export_pointer(record,
+			       libinput_event_get_pointer_event(event));
+		break;
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		export_touch(record,
+			     libinput_event_get_touch_event(event));
+		break;
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		export_tablet_tool(record,
+				   libinput_event_get_tablet_tool_event(event));
+		break;
+	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
+	case LIBINPUT_EVENT_TABLET_PAD_RING:
+	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
+		export_tablet_pad(record,
+				  libinput_event_get_tablet_pad_event(event));
+		break;
+	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
+	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_PINCH_END:
+		export_gesture(record,
+			       libinput_event_get_gesture_event(event));
+		break;
+	case LIBINPUT_EVENT_SWITCH_TOGGLE:
+		export_switch(record,
+			      libinput_event_get_switch_event(event));
+		break;
+	}
+
+	event_export_commit(export, record);
+}
+
+int
+event_export_add_notify_fd(struct event_export *export, int fd)
+{
+	int *fds;
+	size_t i;
+
+	for (i = 0; i < export->nnotify_fds; i++) {
+		if (export->notify_fds[i] == fd)
+			return -EEXIST;
+	}
+
+	fds = realloc(export->notify_fds,
+		      (export->nnotify_fds + 1) * sizeof(*fds));
+	if (!fds)
+		return -ENOMEM;
+
+	fds[export->nnotify_fds++] = fd;
+	export->notify_fds = fds;
+
+	return 0;
+}
+
+int
+event_export_remove_notify_fd(struct event_export *export, int fd)
+{
+	size_t i;
+
+	for (i = 0; i < export->nnotify_fds; i++) {
+		if (export->notify_fds[i] != fd)
+			continue;
+
+		export->notify_fds[i] =
+			export->notify_fds[--export->nnotify_fds];
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+void
+event_export_notify(struct event_export *export)
+{
+	const uint64_t one = 1;
+	size_t i;
+
+	if (export->notified == export->head)
+		return;
+
+	export->notified = export->head;
+
+	for (i = 0; i < export->nnotify_fds; i++) {
+		ssize_t rc = write(export->notify_fds[i], &one, sizeof(one));
+
+		/* EAGAIN means the eventfd counter is full and the reader
+		 * has a wakeup pending anyway. Other errors are for the
+		 * caller who owns the fd to handle */
+		(void)rc;
+	}
+}
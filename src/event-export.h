@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef EVENT_EXPORT_H
+#define EVENT_EXPORT_H
+
+#include "libinput.h"
+
+/* The writing side of the event export, see libinput-export.h for the
+ * layout and the reader. There is exactly one writer, the context's
+ * thread, and it never waits for the readers: a reader that falls behind
+ * by more than the number of records loses the oldest ones.
+ */
+struct event_export;
+
+/* Returns NULL and sets errno on failure */
+struct event_export *
+event_export_create(unsigned int nrecords);
+
+void
+event_export_destroy(struct event_export *export);
+
+int
+event_export_get_fd(struct event_export *export);
+
+void
+event_export_write(struct event_export *export, struct libinput_event *event);
+
+int
+event_export_add_notify_fd(struct event_export *export, int fd);
+
+int
+event_export_remove_notify_fd(struct event_export *export, int fd);
+
+/* Signals the notify fds if records were written since the last call */
+void
+event_export_notify(struct event_export *export);
+
+#endif
@@ -0,0 +1,723 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* Fixed-point implementation of the adaptive pointer acceleration in
+ * filter.c, for CPUs without an FPU. The behavior is the same as the
+ * floating point filters, see there for the description of the
+ * velocity calculation and the profiles.
+ *
+ * All values are Q16.16 in an int64_t, velocities are in units/ms
+ * instead of units/us to keep the precision. Floating point is only used
+ * to convert the API's coordinates and when the speed is changed.
+ *
+ * The output is within 0.1% plus 1/1000 of a unit of the floating point
+ * filters, see test-filter.c.
+ */
+
+#include "config.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "filter.h"
+#include "libinput-util.h"
+#include "filter-private.h"
+
+#define FIX_SHIFT 16
+#define FIX_ONE ((int64_t)1 << FIX_SHIFT)
+/* For constants only, evaluated at compile time */
+#define FIX_CONST(d_) ((int64_t)((d_) * FIX_ONE + 0.5))
+
+#define MAX_VELOCITY_DIFF_FIXED FIX_ONE /* units/ms, see MAX_VELOCITY_DIFF */
+
+struct fixed_coords {
+	int64_t x, y;
+};
+
+struct pointer_tracker_fixed {
+	struct fixed_coords pos; /* accumulated motion at time */
+	struct fixed_coords origin; /* accumulated motion before
+				       the first event */
+	uint64_t time;  /* us */
+	uint32_t dir;
+};
+
+struct pointer_accelerator_fixed;
+
+typedef int64_t (*fixed_profile_func_t)(struct pointer_accelerator_fixed *accel,
+					int64_t velocity);
+
+struct pointer_accelerator_fixed {
+	struct motion_filter base;
+
+	fixed_profile_func_t profile;
+
+	int64_t velocity;	/* units/ms */
+	int64_t last_velocity;	/* units/ms */
+
+	struct pointer_tracker_fixed trackers[NUM_POINTER_TRACKERS];
+	int cur_tracker;
+	struct fixed_coords pos;
+
+	/* in the units of the profile's speed, see the set_speed hooks */
+	int64_t threshold;
+	int64_t accel;		/* unitless factor */
+	int64_t incline;	/* incline of the function */
+	int64_t scale;		/* unitless factor */
+
+	int dpi;
+};
+
+static inline int64_t
+fix_from_double(double d)
+{
+	return (int64_t)(d * FIX_ONE + (d < 0 ? -0.5 : 0.5));
+}
+
+static inline double
+fix_to_double(int64_t f)
+{
+	return (double)f / FIX_ONE;
+}
+
+static inline int64_t
+fix_mul(int64_t a, int64_t b)
+{
+	return (a * b) / FIX_ONE;
+}
+
+static inline int64_t
+fix_abs(int64_t a)
+{
+	return a < 0 ? -a : a;
+}
+
+static inline uint64_t
+isqrt64(uint64_t v)
+{
+	uint64_t result = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while (bit > v)
+		bit >>= 2;
+
+	while (bit) {
+		if (v >= result + bit) {
+			v -= result + bit;
+			result = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return result;
+}
+
+static int64_t
+fix_hypot(int64_t x, int64_t y)
+{
+	const int64_t limit = (int64_t)1 << 31;
+	int shift = 0;
+
+	x = fix_abs(x);
+	y = fix_abs(y);
+
+	/* Keep x² + y² within 64 bits, a one-off sub-unit loss of
+	 * precision is irrelevant for motion this large */
+	while (x >= limit || y >= limit) {
+		x >>= 8;
+		y >>= 8;
+		shift += 8;
+	}
+
+	return (int64_t)isqrt64((uint64_t)(x * x + y * y)) << shift;
+}
+
+/* Equivalent to xy_get_direction() but without atan2. The octant
+ * boundaries the double version tests against are 4.5 degrees (0.1 of an
+ * octant) either side of the axes and diagonals, so compare the ratio of
+ * the shorter to the longer axis against the tangent of those angles.
+ */
+#define TAN_4_5_DEG 5158	/* tan(4.5°) in Q16 */
+#define TAN_40_5_DEG 55973	/* tan(40.5°) in Q16 */
+
+static uint32_t
+fixed_get_direction(struct fixed_coords c)
+{
+	int64_t ax = fix_abs(c.x),
+		ay = fix_abs(c.y);
+	int64_t minor, major;
+	unsigned int octant;
+	bool past_low, past_high; /* beyond 0.1 and 0.9 of the octant */
+	unsigned int d1, d2;
+
+	if (ax < 2 * FIX_ONE && ay < 2 * FIX_ONE) {
+		if (c.x > 0 && c.y > 0)
+			return S | SE | E;
+		else if (c.x > 0 && c.y < 0)
+			return N | NE | E;
+		else if (c.x < 0 && c.y > 0)
+			return S | SW | W;
+		else if (c.x < 0 && c.y < 0)
+			return N | NW | W;
+		else if (c.x > 0)
+			return NE | E | SE;
+		else if (c.x < 0)
+			return NW | W | SW;
+		else if (c.y > 0)
+			return SE | S | SW;
+		else if (c.y < 0)
+			return NE | N | NW;
+		return UNDEFINED_DIRECTION;
+	}
+
+	/* Octants are numbered clockwise starting at North, even octants
+	 * start at an axis, odd octants start at a diagonal */
+	if (c.x >= 0 && c.y < 0)
+		octant = ax < ay ? 0 : 1;
+	else if (c.x > 0 && c.y >= 0)
+		octant = ay < ax ? 2 : 3;
+	else if (c.x <= 0 && c.y > 0)
+		octant = ax < ay ? 4 : 5;
+	else
+		octant = ay < ax ? 6 : 7;
+
+	minor = min(ax, ay);
+	major = max(ax, ay);
+
+	if (octant % 2 == 0) {
+		past_low = minor * FIX_ONE >= TAN_4_5_DEG * major;
+		past_high = minor * FIX_ONE >= TAN_40_5_DEG * major;
+	} else {
+		past_low = minor * FIX_ONE <= TAN_40_5_DEG * major;
+		past_high = minor * FIX_ONE <= TAN_4_5_DEG * major;
+	}
+
+	/* Mark one or two close enough octants */
+	d1 = (octant + (past_low ? 1 : 0)) % 8;
+	d2 = (octant + (past_high ? 1 : 0)) % 8;
+
+	return (1 << d1) | (1 << d2);
+}
+
+static bool
+feed_trackers(struct pointer_accelerator_fixed *accel,
+	      struct fixed_coords delta,
+	      uint64_t time)
+{
+	struct pointer_tracker_fixed *tracker =
+		&accel->trackers[accel->cur_tracker];
+	struct fixed_coords origin = accel->pos;
+
+	accel->pos.x += delta.x;
+	accel->pos.y += delta.y;
+
+	if (time >= tracker->time &&
+	    time - tracker->time < TRACKER_MIN_INTERVAL) {
+		struct fixed_coords motion;
+
+		motion.x = accel->pos.x - tracker->origin.x;
+		motion.y = accel->pos.y - tracker->origin.y;
+		tracker->dir = fixed_get_direction(motion);
+		return false;
+	}
+
+	accel->cur_tracker = (accel->cur_tracker + 1) % NUM_POINTER_TRACKERS;
+	tracker = &accel->trackers[accel->cur_tracker];
+
+	tracker->origin = origin;
+	tracker->pos = accel->pos;
+	tracker->time = time;
+	tracker->dir = fixed_get_direction(delta);
+
+	return true;
+}
+
+static struct pointer_tracker_fixed *
+tracker_by_offset(struct pointer_accelerator_fixed *accel, unsigned int offset)
+{
+	unsigned int index =
+		(accel->cur_tracker + NUM_POINTER_TRACKERS - offset)
+		% NUM_POINTER_TRACKERS;
+	return &accel->trackers[index];
+}
+
+static int64_t
+calculate_tracker_velocity(struct pointer_accelerator_fixed *accel,
+			   struct pointer_tracker_fixed *tracker,
+			   uint64_t time)
+{
+	int64_t tdelta = time - tracker->time + 1;
+	int64_t distance = fix_hypot(accel->pos.x - tracker->pos.x,
+				     accel->pos.y - tracker->pos.y);
+
+	return distance * 1000 / tdelta; /* units/ms */
+}
+
+static int64_t
+calculate_velocity(struct pointer_accelerator_fixed *accel, uint64_t time)
+{
+	struct pointer_tracker_fixed *tracker;
+	int64_t velocity;
+	int64_t result = 0;
+	int64_t initial_velocity = 0;
+	unsigned int offset;
+
+	unsigned int dir = tracker_by_offset(accel, 0)->dir;
+
+	for (offset = 1; offset < NUM_POINTER_TRACKERS; offset++) {
+		tracker = tracker_by_offset(accel, offset);
+
+		if (tracker->time > time)
+			break;
+
+		if (time - tracker->time > MOTION_TIMEOUT) {
+			if (offset == 1)
+				result = calculate_tracker_velocity(
+						accel,
+						tracker,
+						tracker->time + MOTION_TIMEOUT);
+			break;
+		}
+
+		velocity = calculate_tracker_velocity(accel, tracker, time);
+
+		dir &= tracker->dir;
+		if (dir == 0) {
+			if (offset == 1)
+				result = velocity;
+			break;
+		}
+
+		if (initial_velocity == 0) {
+			result = initial_velocity = velocity;
+		} else {
+			if (fix_abs(initial_velocity - velocity) >
+			    MAX_VELOCITY_DIFF_FIXED)
+				break;
+
+			result = velocity;
+		}
+	}
+
+	return result; /* units/ms */
+}
+
+static int64_t
+calculate_acceleration_factor(struct pointer_accelerator_fixed *accel,
+			      struct fixed_coords delta,
+			      uint64_t time)
+{
+	int64_t velocity = accel->velocity,
+		last_velocity = accel->last_velocity;
+	int64_t factor;
+
+	if (feed_trackers(accel, delta, time)) {
+		velocity = calculate_velocity(accel, time);
+		accel->velocity = velocity;
+	}
+
+	/* Simpson's rule, see calculate_acceleration() in filter.c */
+	factor = accel->profile(accel, velocity);
+	factor += accel->profile(accel, last_velocity);
+	factor += 4 * accel->profile(accel, (last_velocity + velocity) / 2);
+	factor /= 6;
+
+	accel->last_velocity = velocity;
+
+	return factor;
+}
+
+static struct fixed_coords
+accelerator_filter_generic(struct pointer_accelerator_fixed *accel,
+			   struct fixed_coords delta,
+			   uint64_t time)
+{
+	int64_t factor = calculate_acceleration_factor(accel, delta, time);
+	struct fixed_coords accelerated;
+
+	accelerated.x = fix_mul(factor, delta.x);
+	accelerated.y = fix_mul(factor, delta.y);
+
+	return accelerated;
+}
+
+static inline struct fixed_coords
+fixed_from_device(const struct device_float_coords *coords)
+{
+	struct fixed_coords c;
+
+	c.x = fix_from_double(coords->x);
+	c.y = fix_from_double(coords->y);
+
+	return c;
+}
+
+static inline struct normalized_coords
+fixed_to_normalized(struct fixed_coords coords)
+{
+	struct normalized_coords norm;
+
+	norm.x = fix_to_double(coords.x);
+	norm.y = fix_to_double(coords.y);
+
+	return norm;
+}
+
+static inline struct fixed_coords
+fixed_normalize_for_dpi(struct fixed_coords coords, int dpi)
+{
+	coords.x = coords.x * DEFAULT_MOUSE_DPI / dpi;
+	coords.y = coords.y * DEFAULT_MOUSE_DPI / dpi;
+
+	return coords;
+}
+
+static struct normalized_coords
+accelerator_filter_pre_normalized(struct motion_filter *filter,
+				  const struct device_float_coords *unaccelerated,
+				  void *data, uint64_t time)
+{
+	struct pointer_accelerator_fixed *accel =
+		(struct pointer_accelerator_fixed *) filter;
+	struct fixed_coords delta;
+
+	delta = fixed_normalize_for_dpi(fixed_from_device(unaccelerated),
+					accel->dpi);
+
+	return fixed_to_normalized(accelerator_filter_generic(accel,
+							      delta,
+							      time));
+}
+
+static struct normalized_coords
+accelerator_filter_post_normalized(struct motion_filter *filter,
+				   const struct device_float_coords *unaccelerated,
+				   void *data, uint64_t time)
+{
+	struct pointer_accelerator_fixed *accel =
+		(struct pointer_accelerator_fixed *) filter;
+	struct fixed_coords delta = fixed_from_device(unaccelerated);
+	struct fixed_coords accelerated;
+
+	accelerated = accelerator_filter_generic(accel, delta, time);
+
+	return fixed_to_normalized(fixed_normalize_for_dpi(accelerated,
+							   accel->dpi));
+}
+
+static struct normalized_coords
+accelerator_filter_unnormalized(struct motion_filter *filter,
+				const struct device_float_coords *unaccelerated,
+				void *data, uint64_t time)
+{
+	struct pointer_accelerator_fixed *accel =
+		(struct pointer_accelerator_fixed *) filter;
+	struct fixed_coords delta = fixed_from_device(unaccelerated);
+
+	return fixed_to_normalized(accelerator_filter_generic(accel,
+							      delta,
+							      time));
+}
+
+static struct normalized_coords
+accelerator_filter_noop(struct motion_filter *filter,
+			const struct device_float_coords *unaccelerated,
+			void *data, uint64_t time)
+{
+	struct pointer_accelerator_fixed *accel =
+		(struct pointer_accelerator_fixed *) filter;
+	struct fixed_coords delta = fixed_from_device(unaccelerated);
+
+	return fixed_to_normalized(fixed_normalize_for_dpi(delta, accel->dpi));
+}
+
+static struct normalized_coords
+touchpad_constant_filter(struct motion_filter *filter,
+			 const struct device_float_coords *unaccelerated,
+			 void *data, uint64_t time)
+{
+	struct pointer_accelerator_fixed *accel =
+		(struct pointer_accelerator_fixed *) filter;
+	const int64_t slowdown = FIX_CONST(TP_MAGIC_SLOWDOWN);
+	struct fixed_coords normalized;
+
+	normalized = fixed_normalize_for_dpi(fixed_from_device(unaccelerated),
+					     accel->dpi);
+	normalized.x = fix_mul(slowdown, normalized.x);
+	normalized.y = fix_mul(slowdown, normalized.y);
+
+	return fixed_to_normalized(normalized);
+}
+
+static void
+accelerator_restart(struct motion_filter *filter,
+		    void *data,
+		    uint64_t time)
+{
+	struct pointer_accelerator_fixed *accel =
+		(struct pointer_accelerator_fixed *) filter;
+	unsigned int offset;
+	struct pointer_tracker_fixed *tracker;
+
+	for (offset = 1; offset < NUM_POINTER_TRACKERS; offset++) {
+		tracker = tracker_by_offset(accel, offset);
+		tracker->time = 0;
+		tracker->dir = 0;
+		tracker->pos = accel->pos;
+		tracker->origin = accel->pos;
+	}
+
+	tracker = tracker_by_offset(accel, 0);
+	tracker->time = time;
+	tracker->dir = UNDEFINED_DIRECTION;
+	tracker->pos = accel->pos;
+	tracker->origin = accel->pos;
+
+	accel->velocity = 0;
+}
+
+static void
+accelerator_destroy(struct motion_filter *filter)
+{
+	free(filter);
+}
+
+/* The speed setting is rare enough that we can calculate the parameters in
+ * floating point, same as accelerator_set_speed() in filter.c */
+static void
+accelerator_calculate_params(double speed_adjustment,
+			     double *threshold, /* units/ms */
+			     double *accel,
+			     double *incline)
+{
+	*threshold = v_us2ms(DEFAULT_THRESHOLD) - 0.25 * speed_adjustment;
+	if (*threshold < v_us2ms(MINIMUM_THRESHOLD))
+		*threshold = v_us2ms(MINIMUM_THRESHOLD);
+	*accel = DEFAULT_ACCELERATION + speed_adjustment * 1.5;
+	*incline = DEFAULT_INCLINE + speed_adjustment * 0.75;
+}
+
+static bool
+accelerator_set_speed(struct motion_filter *filter,
+		      double speed_adjustment)
+{
+	struct pointer_accelerator_fixed *accel =
+		(struct pointer_accelerator_fixed *) filter;
+	double threshold, max_accel, incline;
+
+	assert(speed_adjustment >= -1.0 && speed_adjustment <= 1.0);
+
+	accelerator_calculate_params(speed_adjustment,
+				     &threshold,
+				     &max_accel,
+				     &incline);
+	accel->threshold = fix_from_double(threshold);
+	accel->accel = fix_from_double(max_accel);
+	accel->incline = fix_from_double(incline);
+	filter->speed_adjustment = speed_adjustment;
+
+	return true;
+}
+
+/* Low-dpi mice and trackpoints accelerate in device units, the dpi factor
+ * is constant so it's applied to the parameters here instead of for every
+ * event */
+static bool
+accelerator_set_speed_device_units(struct motion_filter *filter,
+				   double speed_adjustment)
+{
+	struct pointer_accelerator_fixed *accel =
+		(struct pointer_accelerator_fixed *) filter;
+	double dpi_factor = accel->dpi/(double)DEFAULT_MOUSE_DPI;
+	double threshold, max_accel, incline;
+
+	assert(speed_adjustment >= -1.0 && speed_adjustment <= 1.0);
+
+	accelerator_calculate_params(speed_adjustment,
+				     &threshold,
+				     &max_accel,
+				     &incline);
+	accel->threshold = fix_from_double(threshold * dpi_factor);
+	accel->accel = fix_from_double(max_accel / dpi_factor);
+	accel->incline = fix_from_double(incline);
+	filter->speed_adjustment = speed_adjustment;
+
+	return true;
+}
+
+static bool
+touchpad_accelerator_set_speed(struct motion_filter *filter,
+			       double speed_adjustment)
+{
+	struct pointer_accelerator_fixed *accel =
+		(struct pointer_accelerator_fixed *) filter;
+
+	assert(speed_adjustment >= -1.0 && speed_adjustment <= 1.0);
+
+	accel->threshold = fix_from_double(TOUCHPAD_DEFAULT_THRESHOLD -
+			TOUCHPAD_THRESHOLD_RANGE * speed_adjustment); /* mm/s */
+	accel->accel = fix_from_double(TOUCHPAD_ACCELERATION);
+	accel->incline = fix_from_double(TOUCHPAD_INCLINE);
+	accel->scale = fix_from_double((1 + 0.5 * speed_adjustment) *
+				       TP_MAGIC_SLOWDOWN);
+	filter->speed_adjustment = speed_adjustment;
+
+	return true;
+}
+
+/* 10x + 0.3 up to 0.07 units/ms, 1 up to the threshold, linear incline
+ * after that, capped at the maximum factor. */
+static int64_t
+pointer_accel_profile_device_units_fixed(
+				struct pointer_accelerator_fixed *accel,
+				int64_t speed_in) /* units/ms */
+{
+	const int64_t low_threshold = FIX_CONST(0.07);
+	const int64_t low_offset = FIX_CONST(0.3);
+	int64_t factor;
+
+	if (speed_in < low_threshold)
+		factor = 10 * speed_in + low_offset;
+	else if (speed_in < accel->threshold)
+		factor = FIX_ONE;
+	else
+		factor = fix_mul(accel->incline,
+				 speed_in - accel->threshold) + FIX_ONE;
+
+	return min(accel->accel, factor);
+}
+
+static int64_t
+pointer_accel_profile_linear_fixed(struct pointer_accelerator_fixed *accel,
+			     int64_t speed_in) /* units/ms */
+{
+	/* Normalize to 1000dpi, because the profile relies on that */
+	speed_in = speed_in * DEFAULT_MOUSE_DPI / accel->dpi;
+
+	return pointer_accel_profile_device_units_fixed(accel, speed_in);
+}
+
+static int64_t
+touchpad_accel_profile_linear_fixed(struct pointer_accelerator_fixed *accel,
+			      int64_t speed_in) /* units/ms */
+{
+	const int64_t low_threshold = 7 * FIX_ONE;
+	const int64_t low_offset = FIX_CONST(0.3);
+	int64_t factor;
+
+	/* Convert to mm/s */
+	speed_in = speed_in * 25400 / accel->dpi;
+
+	if (speed_in < low_threshold)
+		factor = speed_in / 10 + low_offset;
+	else if (speed_in < accel->threshold)
+		factor = FIX_ONE;
+	else
+		factor = fix_mul(accel->incline,
+				 speed_in - accel->threshold) + FIX_ONE;
+
+	factor = min(accel->accel, factor);
+
+	return fix_mul(factor, accel->scale);
+}
+
+struct motion_filter_interface accelerator_interface_fixed = {
+	.type = LIBINPUT_CONFIG_ACCEL_PROFILE_ADAPTIVE,
+	.filter = accelerator_filter_pre_normalized,
+	.filter_constant = accelerator_filter_noop,
+	.restart = accelerator_restart,
+	.destroy = accelerator_destroy,
+	.set_speed = accelerator_set_speed,
+};
+
+struct motion_filter_interface accelerator_interface_device_units_fixed = {
+	.type = LIBINPUT_CONFIG_ACCEL_PROFILE_ADAPTIVE,
+	.filter = accelerator_filter_unnormalized,
+	.filter_constant = accelerator_filter_noop,
+	.restart = accelerator_restart,
+	.destroy = accelerator_destroy,
+	.set_speed = accelerator_set_speed_device_units,
+};
+
+struct motion_filter_interface accelerator_interface_touchpad_fixed = {
+	.type = LIBINPUT_CONFIG_ACCEL_PROFILE_ADAPTIVE,
+	.filter = accelerator_filter_post_normalized,
+	.filter_constant = touchpad_constant_filter,
+	.restart = accelerator_restart,
+	.destroy = accelerator_destroy,
+	.set_speed = touchpad_accelerator_set_speed,
+};
+
+static struct motion_filter *
+create_fixed_filter(int dpi,
+		    struct motion_filter_interface *interface,
+		    fixed_profile_func_t profile)
+{
+	struct pointer_accelerator_fixed *filter;
+
+	filter = zalloc(sizeof *filter);
+	if (filter == NULL)
+		return NULL;
+
+	filter->base.interface = interface;
+	filter->profile = profile;
+	filter->dpi = dpi;
+	interface->set_speed(&filter->base, 0.0);
+
+	return &filter->base;
+}
+
+struct motion_filter *
+create_pointer_accelerator_filter_linear_fixed(int dpi)
+{
+	return create_fixed_filter(dpi,
+				   &accelerator_interface_fixed,
+				   pointer_accel_profile_linear_fixed);
+}
+
+struct motion_filter *
+create_pointer_accelerator_filter_linear_low_dpi_fixed(int dpi)
+{
+	return create_fixed_filter(dpi,
+				   &accelerator_interface_device_units_fixed,
+				   pointer_accel_profile_device_units_fixed);
+}
+
+struct motion_filter *
+create_pointer_accelerator_filter_touchpad_fixed(int dpi)
+{
+	return create_fixed_filter(dpi,
+				   &accelerator_interface_touchpad_fixed,
+				   touchpad_accel_profile_linear_fixed);
+}
+
+struct motion_filter *
+create_pointer_accelerator_filter_trackpoint_fixed(int dpi)
+{
+	return create_fixed_filter(dpi,
+				   &accelerator_interface_device_units_fixed,
+				   pointer_accel_profile_device_units_fixed);
+}
@@ -27,6 +27,7 @@
 #include "config.h"
 
 #include "filter.h"
+#include "libinput-util.h"
 
 struct motion_filter_interface {
 	enum libinput_config_accel_profile type;
@@ -51,4 +52,58 @@ struct motion_filter {
 	struct motion_filter_interface *interface;
 };
 
+/* Once normalized, touchpads see the same acceleration as mice. that is
+ * technically correct but subjectively wrong, we expect a touchpad to be a
+ * lot slower than a mouse. Apply a magic factor to slow down all movements
+ */
+#define TP_MAGIC_SLOWDOWN 0.37 /* unitless factor */
+
+/* Convert speed/velocity from units/us to units/ms */
+static inline double
+v_us2ms(double units_per_us)
+{
+	return units_per_us * 1000.0;
+}
+
+static inline double
+v_us2s(double units_per_us)
+{
+	return units_per_us * 1000000.0;
+}
+
+/* Convert speed/velocity from units/ms to units/us */
+static inline double
+v_ms2us(double units_per_ms)
+{
+	return units_per_ms/1000.0;
+}
+
+/*
+ * Default parameters for pointer acceleration profiles.
+ */
+
+#define DEFAULT_THRESHOLD v_ms2us(0.4)		/* in units/us */
+#define MINIMUM_THRESHOLD v_ms2us(0.2)		/* in units/us */
+#define DEFAULT_ACCELERATION 2.0		/* unitless factor */
+#define DEFAULT_INCLINE 1.1			/* unitless factor */
+
+/* Touchpad acceleration */
+#define TOUCHPAD_DEFAULT_THRESHOLD 254		/* mm/s */
+#define TOUCHPAD_THRESHOLD_RANGE 184		/* mm/s */
+#define TOUCHPAD_ACCELERATION 9.0		/* unitless factor */
+#define TOUCHPAD_INCLINE 0.011			/* unitless factor */
+
+/*
+ * Pointer acceleration filter constants
+ */
+
+#define MAX_VELOCITY_DIFF	v_ms2us(1) /* units/us */
+#define MOTION_TIMEOUT		ms2us(1000)
+#define NUM_POINTER_TRACKERS	16
+/* Events less than this apart are merged into the same tracker, so on
+ * devices above 1000Hz the trackers and thus the velocity still span the
+ * same time as on a 1000Hz device. Slightly less than 1ms so that
+ * devices up to 1000Hz still get one tracker per event. */
+#define TRACKER_MIN_INTERVAL	us(750)
+
 #endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "config.h"
+
+#include <math.h>
+
+#include "filter-smoothing.h"
+#include "libinput-util.h"
+
+#define SMOOTHING_DERIVATIVE_CUTOFF 3.0	/* Hz */
+#define SMOOTHING_POINT_BETA 0.5	/* Hz per mm/s */
+#define SMOOTHING_TILT_BETA 0.2		/* Hz per degree/s */
+#define SMOOTHING_FADE_STRENGTH 0.1
+
+/* Smoothing factor of a first-order low-pass filter with the given
+ * cutoff frequency in Hz for a sample interval dt in seconds */
+static inline double
+smoothing_alpha(double cutoff, double dt)
+{
+	double tau = 1.0/(2 * M_PI * cutoff);
+
+	return 1.0/(1.0 + tau/dt);
+}
+
+static inline double
+smoothing_lowpass(double prev, double value, double alpha)
+{
+	return (1.0 - alpha) * prev + alpha * value;
+}
+
+/* Below SMOOTHING_FADE_STRENGTH the filter fades out linearly so that
+ * strength 0 is a pass-through without a jump at the boundary */
+static inline double
+smoothing_fade_alpha(const struct smoothing_filter *filter, double alpha)
+{
+	double fade = min(filter->strength/SMOOTHING_FADE_STRENGTH, 1.0);
+
+	return 1.0 - fade * (1.0 - alpha);
+}
+
+static void
+smoothing_box_fill(struct smoothing_filter *filter,
+		   const struct smoothing_sample *sample)
+{
+	unsigned int i;
+
+	for (i = 0; i < SMOOTHING_BOX_LENGTH; i++)
+		filter->box.samples[i] = *sample;
+
+	filter->box.sum.point.x = sample->point.x * SMOOTHING_BOX_LENGTH;
+	filter->box.sum.point.y = sample->point.y * SMOOTHING_BOX_LENGTH;
+	filter->box.sum.tilt.x = sample->tilt.x * SMOOTHING_BOX_LENGTH;
+	filter->box.sum.tilt.y = sample->tilt.y * SMOOTHING_BOX_LENGTH;
+	filter->box.index = 0;
+}
+
+/* Replaces the oldest sample and updates the running sum, the sum is
+ * recalculated from scratch on every reset so rounding errors don't
+ * accumulate beyond a single proximity */
+static struct smoothing_sample
+smoothing_box_dispatch(struct smoothing_filter *filter,
+		       const struct smoothing_sample *sample)
+{
+	struct smoothing_sample *oldest;
+	struct smoothing_sample *sum = &filter->box.sum;
+	struct smoothing_sample smooth;
+
+	oldest = &filter->box.samples[filter->box.index];
+
+	sum->point.x += sample->point.x - oldest->point.x;
+	sum->point.y += sample->point.y - oldest->point.y;
+	sum->tilt.x += sample->tilt.x - oldest->tilt.x;
+	sum->tilt.y += sample->tilt.y - oldest->tilt.y;
+
+	*oldest = *sample;
+	filter->box.index = (filter->box.index + 1) % SMOOTHING_BOX_LENGTH;
+
+	smooth.point.x = sum->point.x/SMOOTHING_BOX_LENGTH;
+	smooth.point.y = sum->point.y/SMOOTHING_BOX_LENGTH;
+	smooth.tilt.x = sum->tilt.x/SMOOTHING_BOX_LENGTH;
+	smooth.tilt.y = sum->tilt.y/SMOOTHING_BOX_LENGTH;
+
+	return smooth;
+}
+
+static void
+smoothing_adaptive_fill(struct smoothing_filter *filter,
+			const struct smoothing_sample *sample,
+			uint64_t time)
+{
+	filter->adaptive.time = time;
+	filter->adaptive.raw = *sample;
+	filter->adaptive.value = *sample;
+	filter->adaptive.point_speed = 0.0;
+	filter->adaptive.tilt_speed = 0.0;
+}
+
+static struct smoothing_sample
+smoothing_adaptive_dispatch(struct smoothing_filter *filter,
+			    const struct smoothing_sample *sample,
+			    uint64_t time)
+{
+	struct smoothing_sample *raw = &filter->adaptive.raw;
+	struct smoothing_sample *value = &filter->adaptive.value;
+	double dt, speed, alpha;
+
+	/* no time has passed, only the faded-out part of the filter moves */
+	if (time <= filter->adaptive.time) {
+		alpha = smoothing_fade_alpha(filter, 0.0);
+		value->point.x = smoothing_lowpass(value->point.x,
+						   sample->point.x,
+						   alpha);
+		value->point.y = smoothing_lowpass(value->point.y,
+						   sample->point.y,
+						   alpha);
+		value->tilt.x = smoothing_lowpass(value->tilt.x,
+						  sample->tilt.x,
+						  alpha);
+		value->tilt.y = smoothing_lowpass(value->tilt.y,
+						  sample->tilt.y,
+						  alpha);
+		*raw = *sample;
+		return *value;
+	}
+
+	dt = (time - filter->adaptive.time)/1000000.0;
+	alpha = smoothing_alpha(SMOOTHING_DERIVATIVE_CUTOFF, dt);
+
+	speed = hypot(sample->point.x - raw->point.x,
+		      sample->point.y - raw->point.y);
+	speed = speed/filter->resolution/dt;
+	filter->adaptive.point_speed = smoothing_lowpass(
+					      filter->adaptive.point_speed,
+					      speed,
+					      alpha);
+
+	speed = hypot(sample->tilt.x - raw->tilt.x,
+		      sample->tilt.y - raw->tilt.y);
+	speed = speed/dt;
+	filter->adaptive.tilt_speed = smoothing_lowpass(
+					      filter->adaptive.tilt_speed,
+					      speed,
+					      alpha);
+
+	alpha = smoothing_alpha(filter->adaptive.min_cutoff +
+				SMOOTHING_POINT_BETA *
+				filter->adaptive.point_speed,
+				dt);
+	alpha = smoothing_fade_alpha(filter, alpha);
+	value->point.x = smoothing_lowpass(value->point.x,
+					   sample->point.x,
+					   alpha);
+	value->point.y = smoothing_lowpass(value->point.y,
+					   sample->point.y,
+					   alpha);
+
+	alpha = smoothing_alpha(filter->adaptive.min_cutoff +
+				SMOOTHING_TILT_BETA *
+				filter->adaptive.tilt_speed,
+				dt);
+	alpha = smoothing_fade_alpha(filter, alpha);
+	value->tilt.x = smoothing_lowpass(value->tilt.x, sample->tilt.x, alpha);
+	value->tilt.y = smoothing_lowpass(value->tilt.y, sample->tilt.y, alpha);
+
+	filter->adaptive.time = time;
+	*raw = *sample;
+
+	return *value;
+}
+
+void
+smoothing_init(struct smoothing_filter *filter,
+	       enum smoothing_mode mode,
+	       double strength,
+	       double resolution)
+{
+	filter->mode = mode;
+	filter->resolution = resolution > 0 ? resolution : 1.0;
+	smoothing_set_strength(filter, strength);
+
+	smoothing_reset(filter);
+}
+
+void
+smoothing_set_strength(struct smoothing_filter *filter, double strength)
+{
+	filter->strength = strength;
+
+	/* strength 0.5 is a 1Hz minimum cutoff, the usual 1€ default,
+	 * every 0.5 in either direction is a factor 10 */
+	filter->adaptive.min_cutoff = pow(10.0, 1.0 - 2.0 * strength);
+}
+
+void
+smoothing_reset(struct smoothing_filter *filter)
+{
+	filter->initialized = false;
+}
+
+struct smoothing_sample
+smoothing_dispatch(struct smoothing_filter *filter,
+		   const struct smoothing_sample *sample,
+		   uint64_t time)
+{
+	if (!filter->initialized) {
+		smoothing_box_fill(filter, sample);
+		smoothing_adaptive_fill(filter, sample, time);
+		filter->initialized = true;
+		return *sample;
+	}
+
+	switch (filter->mode) {
+	case SMOOTHING_BOX:
+		return smoothing_box_dispatch(filter, sample);
+	case SMOOTHING_ADAPTIVE:
+		return smoothing_adaptive_dispatch(filter, sample, time);
+	}
+
+	return *sample;
+}
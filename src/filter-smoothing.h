@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef FILTER_SMOOTHING_H
+#define FILTER_SMOOTHING_H
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libinput-private.h"
+
+/* Smoothing for absolute axes, used for the tablet tool position and
+ * tilt. The box filter averages the last SMOOTHING_BOX_LENGTH samples,
+ * the adaptive filter is a 1€ filter: a low-pass filter whose cutoff
+ * frequency rises with the speed of the tool, so it removes jitter while
+ * the tool is slow and adds little lag when it moves fast.
+ */
+
+#define SMOOTHING_BOX_LENGTH 4
+
+enum smoothing_mode {
+	SMOOTHING_BOX,
+	SMOOTHING_ADAPTIVE,
+};
+
+struct smoothing_sample {
+	struct device_float_coords point;
+	struct tilt_degrees tilt;
+};
+
+struct smoothing_filter {
+	enum smoothing_mode mode;
+	double strength;	/* 0.0 to 1.0, adaptive filter only */
+	double resolution;	/* point units per mm */
+	bool initialized;
+
+	struct {
+		struct smoothing_sample samples[SMOOTHING_BOX_LENGTH];
+		struct smoothing_sample sum;
+		unsigned int index;
+	} box;
+
+	struct {
+		double min_cutoff;	/* Hz */
+		uint64_t time;
+		struct smoothing_sample raw;
+		struct smoothing_sample value;
+		double point_speed;	/* mm/s, low-pass filtered */
+		double tilt_speed;	/* degrees/s, low-pass filtered */
+	} adaptive;
+};
+
+/**
+ * Initialize the filter. The resolution is in point units per mm and
+ * scales the speed the adaptive filter reacts to.
+ */
+void
+smoothing_init(struct smoothing_filter *filter,
+	       enum smoothing_mode mode,
+	       double strength,
+	       double resolution);
+
+/**
+ * Change the strength of the adaptive filter. The history is kept, so
+ * this can be called while the tool is moving.
+ */
+void
+smoothing_set_strength(struct smoothing_filter *filter, double strength);
+
+/**
+ * Drop all history, the next sample is passed through unmodified.
+ */
+void
+smoothing_reset(struct smoothing_filter *filter);
+
+/**
+ * Feed a new sample into the filter and return the smoothed sample. Runs
+ * in constant time for both modes.
+ */
+struct smoothing_sample
+smoothing_dispatch(struct smoothing_filter *filter,
+		   const struct smoothing_sample *sample,
+		   uint64_t time);
+
+#endif /* FILTER_SMOOTHING_H */
@@ -36,32 +36,6 @@
 #include "libinput-util.h"
 #include "filter-private.h"
 
-/* Once normalized, touchpads see the same acceleration as mice. that is
- * technically correct but subjectively wrong, we expect a touchpad to be a
- * lot slower than a mouse. Apply a magic factor to slow down all movements
- */
-#define TP_MAGIC_SLOWDOWN 0.37 /* unitless factor */
-
-/* Convert speed/velocity from units/us to units/ms */
-static inline double
-v_us2ms(double units_per_us)
-{
-	return units_per_us * 1000.0;
-}
-
-static inline double
-v_us2s(double units_per_us)
-{
-	return units_per_us * 1000000.0;
-}
-
-/* Convert speed/velocity from units/ms to units/us */
-static inline double
-v_ms2us(double units_per_ms)
-{
-	return units_per_ms/1000.0;
-}
-
 static inline struct normalized_coords
 normalize_for_dpi(const struct device_float_coords *coords, int dpi)
 {
@@ -125,21 +99,6 @@ filter_get_type(struct motion_filter *filter)
 	return filter->interface->type;
 }
 
-/*
- * Default parameters for pointer acceleration profiles.
- */
-
-#define DEFAULT_THRESHOLD v_ms2us(0.4)		/* in units/us */
-#define MINIMUM_THRESHOLD v_ms2us(0.2)		/* in units/us */
-#define DEFAULT_ACCELERATION 2.0		/* unitless factor */
-#define DEFAULT_INCLINE 1.1			/* unitless factor */
-
-/* Touchpad acceleration */
-#define TOUCHPAD_DEFAULT_THRESHOLD 254		/* mm/s */
-#define TOUCHPAD_THRESHOLD_RANGE 184		/* mm/s */
-#define TOUCHPAD_ACCELERATION 9.0		/* unitless factor */
-#define TOUCHPAD_INCLINE 0.011			/* unitless factor */
-
 /* for the Lenovo x230 custom accel. do not touch */
 #define X230_THRESHOLD v_ms2us(0.4)		/* in units/us */
 #define X230_ACCELERATION 2.0			/* unitless factor */
@@ -147,16 +106,10 @@ filter_get_type(struct motion_filter *filter)
 #define X230_MAGIC_SLOWDOWN 0.4			/* unitless */
 #define X230_TP_MAGIC_LOW_RES_FACTOR 4.0	/* unitless */
 
-/*
- * Pointer acceleration filter constants
- */
-
-#define MAX_VELOCITY_DIFF	v_ms2us(1) /* units/us */
-#define MOTION_TIMEOUT		ms2us(1000)
-#define NUM_POINTER_TRACKERS	16
-
 struct pointer_tracker {
-	struct device_float_coords delta; /* delta to most recent event */
+	struct device_float_coords pos; /* accumulated motion at time */
+	struct device_float_coords origin; /* accumulated motion before
+					      the first event */
 	uint64_t time;  /* us */
 	uint32_t dir;
 };
@@ -171,6 +124,9 @@ struct pointer_accelerator {
 
 	struct pointer_tracker *trackers;
 	int cur_tracker;
+	/* accumulated motion of all events, the trackers store a snapshot
+	 * so we don't need to update every tracker for each event */
+	struct device_float_coords pos;
 
 	double threshold;	/* units/us */
 	double accel;		/* unitless factor */
@@ -195,26 +151,40 @@ struct tablet_accelerator_flat {
 	       yres_scale; /* 1000dpi : tablet res */
 };
 
-static void
+/* Returns true if a new tracker was started, false if the event was
+ * merged into the current tracker */
+static bool
 feed_trackers(struct pointer_accelerator *accel,
 	      const struct device_float_coords *delta,
 	      uint64_t time)
 {
-	int i, current;
-	struct pointer_tracker *trackers = accel->trackers;
-
-	for (i = 0; i < NUM_POINTER_TRACKERS; i++) {
-		trackers[i].delta.x += delta->x;
-		trackers[i].delta.y += delta->y;
+	struct pointer_tracker *tracker = &accel->trackers[accel->cur_tracker];
+	struct device_float_coords origin = accel->pos;
+
+	accel->pos.x += delta->x;
+	accel->pos.y += delta->y;
+
+	/* High-frequency device, merge into the current tracker. Its
+	 * direction is that of all the motion merged into it. */
+	if (time >= tracker->time &&
+	    time - tracker->time < TRACKER_MIN_INTERVAL) {
+		struct device_float_coords motion;
+
+		motion.x = accel->pos.x - tracker->origin.x;
+		motion.y = accel->pos.y - tracker->origin.y;
+		tracker->dir = device_float_get_direction(motion);
+		return false;
 	}
 
-	current = (accel->cur_tracker + 1) % NUM_POINTER_TRACKERS;
-	accel->cur_tracker = current;
+	accel->cur_tracker = (accel->cur_tracker + 1) % NUM_POINTER_TRACKERS;
+	tracker = &accel->trackers[accel->cur_tracker];
+
+	tracker->origin = origin;
+	tracker->pos = accel->pos;
+	tracker->time = time;
+	tracker->dir = device_float_get_direction(*delta);
 
-	trackers[current].delta.x = 0.0;
-	trackers[current].delta.y = 0.0;
-	trackers[current].time = time;
-	trackers[current].dir = device_float_get_direction(*delta);
+	return true;
 }
 
 static struct pointer_tracker *
@@ -227,14 +197,20 @@ tracker_by_offset(struct pointer_accelerator *accel, unsigned int offset)
 }
 
 static double
-calculate_tracker_velocity(struct pointer_tracker *tracker, uint64_t time)
+calculate_tracker_velocity(struct pointer_accelerator *accel,
+			   struct pointer_tracker *tracker,
+			   uint64_t time)
 {
 	double tdelta = time - tracker->time + 1;
-	return hypot(tracker->delta.x, tracker->delta.y) / tdelta; /* units/us */
+	double dx = accel->pos.x - tracker->pos.x,
+	       dy = accel->pos.y - tracker->pos.y;
+
+	return sqrt(dx * dx + dy * dy) / tdelta; /* units/us */
 }
 
 static inline double
-calculate_velocity_after_timeout(struct pointer_tracker *tracker)
+calculate_velocity_after_timeout(struct pointer_accelerator *accel,
+				 struct pointer_tracker *tracker)
 {
 	/* First movement after timeout needs special handling.
 	 *
@@ -247,7 +223,8 @@ calculate_velocity_after_timeout(struct pointer_tracker *tracker)
 	 * for really slow movements but provides much more useful initial
 	 * movement in normal use-cases (pause, move, pause, move)
 	 */
-	return calculate_tracker_velocity(tracker,
+	return calculate_tracker_velocity(accel,
+					  tracker,
 					  tracker->time + MOTION_TIMEOUT);
 }
 
@@ -282,11 +259,13 @@ calculate_velocity(struct pointer_accelerator *accel, uint64_t time)
 		/* Stop if too far away in time */
 		if (time - tracker->time > MOTION_TIMEOUT) {
 			if (offset == 1)
-				result = calculate_velocity_after_timeout(tracker);
+				result = calculate_velocity_after_timeout(
+								accel,
+								tracker);
 			break;
 		}
 
-		velocity = calculate_tracker_velocity(tracker, time);
+		velocity = calculate_tracker_velocity(accel, tracker, time);
 
 		/* Stop if direction changed */
 		dir &= tracker->dir;
@@ -384,8 +363,12 @@ calculate_acceleration_factor(struct pointer_accelerator *accel,
 	double velocity; /* units/us in device-native dpi*/
 	double accel_factor;
 
-	feed_trackers(accel, unaccelerated, time);
-	velocity = calculate_velocity(accel, time);
+	/* For events merged into the current tracker, keep the velocity
+	 * calculated when that tracker was started, the same as a 1000Hz
+	 * device would have */
+	if (feed_trackers(accel, unaccelerated, time))
+		accel->velocity = calculate_velocity(accel, time);
+	velocity = accel->velocity;
 	accel_factor = calculate_acceleration(accel,
 					      data,
 					      velocity,
@@ -536,8 +519,9 @@ accelerator_filter_x230(struct motion_filter *filter,
 	delta_normalized.x = unaccelerated.x;
 	delta_normalized.y = unaccelerated.y;
 
-	feed_trackers(accel, &delta_normalized, time);
-	velocity = calculate_velocity(accel, time);
+	if (feed_trackers(accel, &delta_normalized, time))
+		accel->velocity = calculate_velocity(accel, time);
+	velocity = accel->velocity;
 	accel_factor = calculate_acceleration(accel,
 					      data,
 					      velocity,
@@ -621,13 +605,17 @@ accelerator_restart(struct motion_filter *filter,
 		tracker = tracker_by_offset(accel, offset);
 		tracker->time = 0;
 		tracker->dir = 0;
-		tracker->delta.x = 0;
-		tracker->delta.y = 0;
+		tracker->pos = accel->pos;
+		tracker->origin = accel->pos;
 	}
 
 	tracker = tracker_by_offset(accel, 0);
 	tracker->time = time;
 	tracker->dir = UNDEFINED_DIRECTION;
+	tracker->pos = accel->pos;
+	tracker->origin = accel->pos;
+
+	accel->velocity = 0.0;
 }
 
 static void
@@ -125,6 +125,19 @@ create_pointer_accelerator_filter_trackpoint(int dpi);
 struct motion_filter *
 create_pointer_accelerator_filter_tablet(int xres, int yres);
 
+/* Fixed-point implementations of the above, see filter-fixed.c */
+struct motion_filter *
+create_pointer_accelerator_filter_linear_fixed(int dpi);
+
+struct motion_filter *
+create_pointer_accelerator_filter_linear_low_dpi_fixed(int dpi);
+
+struct motion_filter *
+create_pointer_accelerator_filter_touchpad_fixed(int dpi);
+
+struct motion_filter *
+create_pointer_accelerator_filter_trackpoint_fixed(int dpi);
+
 /*
  * Pointer acceleration profiles.
  */
@@ -0,0 +1,212 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* The client side of the event export, built into its own library so
+ * consumers don't need to link against libinput. The exports are
+ * controlled by libinput-export.sym.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "libinput-export.h"
+
+struct libinput_export_reader {
+	void *map;
+	size_t size;
+
+	const struct libinput_export_header *header;
+	const struct libinput_export_device *devices;
+	uint32_t ndevices;
+	const struct libinput_export_record *records;
+	uint64_t mask;
+
+	uint64_t position; /* number of the next record to read */
+	uint64_t lost;
+};
+
+struct libinput_export_reader *
+libinput_export_reader_new(int fd)
+{
+	struct libinput_export_reader *reader;
+	const struct libinput_export_header *header;
+	struct stat st;
+	void *map;
+	size_t size;
+
+	if (fstat(fd, &st) != 0 ||
+	    (size_t)st.st_size < sizeof(*header))
+		return NULL;
+
+	size = st.st_size;
+	map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	/* The memfd is sealed against resizing, so the size checked here
+	 * stays valid for as long as the mapping exists */
+	header = map;
+	if (header->magic != LIBINPUT_EXPORT_MAGIC ||
+	    header->version != LIBINPUT_EXPORT_VERSION ||
+	    header->record_size != sizeof(struct libinput_export_record) ||
+	    header->nrecords == 0 ||
+	    (header->nrecords & (header->nrecords - 1)) != 0 ||
+	    size < sizeof(*header) +
+		   (size_t)header->ndevices *
+			   sizeof(struct libinput_export_device) +
+		   (size_t)header->nrecords * header->record_size)
+		goto error;
+
+	reader = calloc(1, sizeof(*reader));
+	if (!reader)
+		goto error;
+
+	reader->map = map;
+	reader->size = size;
+	reader->header = header;
+	reader->devices = (const struct libinput_export_device *)(header + 1);
+	reader->ndevices = header->ndevices;
+	reader->records = (const struct libinput_export_record *)
+				&reader->devices[reader->ndevices];
+	reader->mask = header->nrecords - 1;
+	reader->position = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+
+	return reader;
+
+error:
+	munmap(map, size);
+	return NULL;
+}
+
+void
+libinput_export_reader_destroy(struct libinput_export_reader *reader)
+{
+	if (!reader)
+		return;
+
+	munmap(reader->map, reader->size);
+	free(reader);
+}
+
+const struct libinput_export_record *
+libinput_export_reader_peek(struct libinput_export_reader *reader)
+{
+	const struct libinput_export_record *record;
+	uint64_t head, sequence;
+	uint64_t nrecords = reader->mask + 1;
+
+	head = __atomic_load_n(&reader->header->head, __ATOMIC_ACQUIRE);
+
+	/* Everything older than one ring buffer length has been
+	 * overwritten already */
+	if (head - reader->position > nrecords) {
+		reader->lost += head - nrecords - reader->position;
+		reader->position = head - nrecords;
+	}
+
+	while (reader->position < head) {
+		record = &reader->records[reader->position & reader->mask];
+		sequence = __atomic_load_n(&record->sequence,
+					   __ATOMIC_ACQUIRE);
+		if (sequence == reader->position + 1)
+			return record;
+
+		/* Overwritten or being overwritten since we loaded head */
+		reader->lost++;
+		reader->position++;
+	}
+
+	return NULL;
+}
+
+bool
+libinput_export_reader_release(struct libinput_export_reader *reader,
+			       const struct libinput_export_record *record)
+{
+	uint64_t sequence;
+
+	/* Order the caller's reads of the record before the re-check of
+	 * its sequence number, this is the read side of the seqlock */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	sequence = __atomic_load_n(&record->sequence, __ATOMIC_RELAXED);
+
+	reader->position++;
+	if (sequence != reader->position) {
+		reader->lost++;
+		return false;
+	}
+
+	return true;
+}
+
+uint64_t
+libinput_export_reader_get_lost(struct libinput_export_reader *reader)
+{
+	return reader->lost;
+}
+
+bool
+libinput_export_reader_get_device(struct libinput_export_reader *reader,
+				  uint32_t id,
+				  struct libinput_export_device *device)
+{
+	const struct libinput_export_device *entry;
+	uint32_t i, sequence;
+	int attempts;
+
+	if (id == 0)
+		return false;
+
+	for (i = 0; i < reader->ndevices; i++) {
+		entry = &reader->devices[i];
+
+		/* The writer only holds an entry for a few stores, a few
+		 * attempts are enough unless it died halfway through */
+		for (attempts = 0; attempts < 3; attempts++) {
+			sequence = __atomic_load_n(&entry->sequence,
+						   __ATOMIC_ACQUIRE);
+			if (sequence & 1)
+				continue;
+
+			memcpy(device, entry, sizeof(*device));
+
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if (__atomic_load_n(&entry->sequence,
+					    __ATOMIC_RELAXED) != sequence)
+				continue;
+
+			if (device->id != id)
+				break;
+
+			device->sysname[sizeof(device->sysname) - 1] = '\0';
+			device->name[sizeof(device->name) - 1] = '\0';
+			return true;
+		}
+	}
+
+	return false;
+}
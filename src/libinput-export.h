@@ -0,0 +1,283 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef LIBINPUT_EXPORT_H
+#define LIBINPUT_EXPORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @defgroup export Reading exported events
+ *
+ * Client side of the event export, see libinput_export_enable(). The
+ * exporting process passes the file descriptor returned by
+ * libinput_export_get_fd() to the consumer, e.g. over a unix socket. The
+ * consumer maps it read-only with libinput_export_reader_new() and reads
+ * the events as flat records directly from the shared memory.
+ *
+ * The records only depend on this header and <libinput.h>'s enums, a
+ * consumer does not need a libinput context.
+ */
+
+#define LIBINPUT_EXPORT_MAGIC 0x78456c4c /* "LlEx" */
+#define LIBINPUT_EXPORT_VERSION 1
+
+/**
+ * @ingroup export
+ *
+ * The header at the start of the shared memory, followed by the device
+ * table of ndevices entries and nrecords records of record_size bytes
+ * each.
+ */
+struct libinput_export_header {
+	uint32_t magic;		/**< LIBINPUT_EXPORT_MAGIC */
+	uint32_t version;	/**< LIBINPUT_EXPORT_VERSION */
+	uint32_t record_size;	/**< sizeof(struct libinput_export_record) */
+	uint32_t nrecords;	/**< always a power of two */
+	uint64_t head;		/**< number of records written so far */
+	uint32_t ndevices;	/**< entries in the device table */
+	uint8_t reserved[36];
+};
+
+/**
+ * @ingroup export
+ *
+ * One entry of the device table, see libinput_export_reader_get_device().
+ * Both strings are null-terminated and may be truncated.
+ */
+struct libinput_export_device {
+	/** Odd while the entry is being written */
+	uint32_t sequence;
+	/** Device id as used in the records, 0 for an unused entry */
+	uint32_t id;
+	/** Non-zero once the device was removed */
+	uint32_t removed;
+	uint32_t reserved;
+	char sysname[32];
+	char name[80];
+};
+
+/**
+ * @ingroup export
+ *
+ * One flattened event, the event data is in the union member for the
+ * type, e.g. record->u.motion for pointer motion. All values are in the
+ * same units as returned by the respective libinput_event_*_get_*
+ * functions, absolute coordinates are in mm and not transformed to screen
+ * coordinates.
+ */
+struct libinput_export_record {
+	/** Index of this record plus one, 0 while it is being written */
+	uint64_t sequence;
+	/** Event time in µs, 0 for device added and removed events */
+	uint64_t time;
+	/** One of enum libinput_event_type */
+	uint32_t type;
+	/** Device id as announced with LIBINPUT_EVENT_DEVICE_ADDED */
+	uint32_t device;
+	union {
+		/** LIBINPUT_EVENT_DEVICE_ADDED, LIBINPUT_EVENT_DEVICE_REMOVED,
+		 * both strings are null-terminated and may be truncated */
+		struct {
+			char sysname[32];
+			char name[72];
+		} device;
+		/** LIBINPUT_EVENT_KEYBOARD_KEY */
+		struct {
+			uint32_t key;
+			uint32_t state;
+			uint32_t seat_key_count;
+		} keyboard;
+		/** LIBINPUT_EVENT_POINTER_MOTION */
+		struct {
+			double dx, dy;
+			double dx_unaccelerated, dy_unaccelerated;
+		} motion;
+		/** LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE */
+		struct {
+			double x, y;
+		} absolute;
+		/** LIBINPUT_EVENT_POINTER_BUTTON */
+		struct {
+			uint32_t button;
+			uint32_t state;
+			uint32_t seat_button_count;
+		} button;
+		/** LIBINPUT_EVENT_POINTER_AXIS, axes has the bit
+		 * (1 << axis) set for each axis present */
+		struct {
+			uint32_t source;
+			uint32_t axes;
+			double value[2];
+			double discrete[2];
+		} axis;
+		/** LIBINPUT_EVENT_TOUCH_*, x and y are only set for down
+		 * and motion, slots are -1 for frames */
+		struct {
+			int32_t slot;
+			int32_t seat_slot;
+			double x, y;
+		} touch;
+		/** LIBINPUT_EVENT_TABLET_TOOL_*, button and button_state
+		 * are only set for button events */
+		struct {
+			uint64_t serial;
+			uint32_t tool_type;
+			uint32_t proximity_state;
+			uint32_t tip_state;
+			uint32_t button;
+			uint32_t button_state;
+			uint32_t reserved;
+			double x, y;
+			double pressure, distance;
+			double tilt_x, tilt_y;
+			double rotation, slider, wheel_delta;
+		} tablet_tool;
+		/** LIBINPUT_EVENT_TABLET_PAD_*, number is the button, ring
+		 * or strip number. source and position are only set for
+		 * rings and strips */
+		struct {
+			uint32_t number;
+			uint32_t button_state;
+			uint32_t mode;
+			uint32_t source;
+			double position;
+		} tablet_pad;
+		/** LIBINPUT_EVENT_GESTURE_*, cancelled is only set for end
+		 * events, scale and angle only for pinch events */
+		struct {
+			int32_t finger_count;
+			int32_t cancelled;
+			double dx, dy;
+			double dx_unaccelerated, dy_unaccelerated;
+			double scale, angle_delta;
+		} gesture;
+		/** LIBINPUT_EVENT_SWITCH_TOGGLE */
+		struct {
+			uint32_t sw;
+			uint32_t state;
+		} switch_toggle;
+		uint8_t data[104];
+	} u;
+};
+
+/**
+ * @ingroup export
+ *
+ * A read-only mapping of the exported events. Each reader has its own
+ * position, any number of readers can read the same export concurrently.
+ */
+struct libinput_export_reader;
+
+/**
+ * @ingroup export
+ *
+ * Map the exported events. The reader starts at the most recent record,
+ * events exported before this call are not returned.
+ *
+ * @param fd The file descriptor from libinput_export_get_fd(), the
+ * caller keeps ownership
+ * @return A new reader or NULL if the fd is not a valid export
+ */
+struct libinput_export_reader *
+libinput_export_reader_new(int fd);
+
+/**
+ * @ingroup export
+ *
+ * Unmap the exported events and free the reader. Records returned by
+ * libinput_export_reader_peek() are invalid after this call.
+ */
+void
+libinput_export_reader_destroy(struct libinput_export_reader *reader);
+
+/**
+ * @ingroup export
+ *
+ * Get the next record. The record points into the shared memory and is
+ * not copied, it may be overwritten by the exporting process at any time.
+ * Once the caller is done with it, libinput_export_reader_release()
+ * checks whether that happened and advances to the next record.
+ *
+ * Calling this function again without releasing the record returns the
+ * same record.
+ *
+ * @return The next record or NULL if no new records are available
+ */
+const struct libinput_export_record *
+libinput_export_reader_peek(struct libinput_export_reader *reader);
+
+/**
+ * @ingroup export
+ *
+ * Advance past the record returned by libinput_export_reader_peek().
+ *
+ * @return true if the record was unchanged while it was in use. If false,
+ * the record was overwritten because the reader fell too far behind, any
+ * data read from it must be discarded. The record is counted as lost.
+ */
+bool
+libinput_export_reader_release(struct libinput_export_reader *reader,
+			       const struct libinput_export_record *record);
+
+/**
+ * @ingroup export
+ *
+ * @return The number of records that were overwritten before this reader
+ * could read them.
+ */
+uint64_t
+libinput_export_reader_get_lost(struct libinput_export_reader *reader);
+
+/**
+ * @ingroup export
+ *
+ * Look up a device in the export's device table. The table holds every
+ * device with records in the export, so a reader that attached late or
+ * lost the device's @ref LIBINPUT_EVENT_DEVICE_ADDED record can still map
+ * the id in a record to the device.
+ *
+ * Removed devices stay in the table until their entry is needed for a new
+ * device. The table has a fixed size, if more devices are present than
+ * the table holds, the excess devices are only announced by their
+ * @ref LIBINPUT_EVENT_DEVICE_ADDED record.
+ *
+ * @param reader The reader
+ * @param id The device id from a record
+ * @param device Filled in with a copy of the table entry on success
+ * @return true if the device was found, false otherwise
+ */
+bool
+libinput_export_reader_get_device(struct libinput_export_reader *reader,
+				  uint32_t id,
+				  struct libinput_export_device *device);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* LIBINPUT_EXPORT_H */
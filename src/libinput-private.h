@@ -27,6 +27,7 @@
 
 #include "config.h"
 
+#include <assert.h>
 #include <errno.h>
 #include <math.h>
 
@@ -43,6 +44,16 @@
 #endif
 
 struct libinput_source;
+struct log_ring;
+struct event_export;
+
+#define LIBINPUT_STAT_MAX LIBINPUT_STAT_TIMERFD_UPDATES
+#define LIBINPUT_EVENT_TYPE_INDEX_MAX 64
+
+struct libinput_stats {
+	uint64_t counters[LIBINPUT_STAT_MAX + 1];
+	uint64_t events[LIBINPUT_EVENT_TYPE_INDEX_MAX];
+};
 
 /* A coordinate pair in device coordinates */
 struct device_coords {
@@ -99,6 +110,20 @@ struct wheel_tilt_flags {
 	bool vertical, horizontal;
 };
 
+/* Motion deltas further apart than this don't form a trajectory */
+#define MOTION_PREDICTION_MAX_INTERVAL ms2us(50)
+/* Never extrapolate further than this past the last event */
+#define MOTION_PREDICTION_MAX_HORIZON ms2us(50)
+
+/* Velocity estimate for extrapolating motion past the last event.
+ * Works on any pair of deltas, the unit of the velocity is the unit of
+ * the delta per µs. */
+struct motion_prediction {
+	uint64_t time;		/* time of the last delta */
+	double dx, dy;		/* last delta */
+	double vx, vy;		/* velocity in units/µs */
+};
+
 struct libinput_interface_backend {
 	int (*resume)(struct libinput *libinput);
 	void (*suspend)(struct libinput *libinput);
@@ -132,12 +157,18 @@ struct libinput {
 
 	libinput_log_handler log_handler;
 	enum libinput_log_priority log_priority;
+	struct log_ring *log_ring; /* NULL unless logging is deferred */
+	struct event_export *export; /* NULL unless events are exported */
+	uint64_t log_dropped; /* from previous rings */
+	uint64_t event_mask; /* event types the caller subscribed to */
 	void *user_data;
 	int refcount;
 
 	struct list device_group_list;
 
 	uint64_t last_event_time;
+
+	struct libinput_stats stats;
 };
 
 typedef void (*libinput_seat_destroy_func) (struct libinput_seat *seat);
@@ -153,7 +184,15 @@ struct libinput_seat {
 	char *physical_name;
 	char *logical_name;
 
-	uint32_t slot_map;
+	/* Seat slots are allocated lowest-first. available has one bit per
+	 * seat slot, set if the slot is free. nonfull has one bit per
+	 * long in available, set if that long has a free slot. Both grow on
+	 * demand, slots in use never move. */
+	struct {
+		unsigned long *available;
+		unsigned long *nonfull;
+		size_t nlongs; /* number of longs in available */
+	} slot_map;
 
 	uint32_t button_count[KEY_CNT];
 };
@@ -257,6 +296,7 @@ struct libinput_device_config_middle_emulation {
 			 struct libinput_device *device);
 	enum libinput_config_middle_emulation_state (*get_default)(
 			 struct libinput_device *device);
+	uint64_t (*get_timeout)(struct libinput_device *device);
 };
 
 struct libinput_device_config_dwt {
@@ -306,9 +346,23 @@ struct libinput_device {
 	struct libinput_device_group *group;
 	struct list link;
 	struct list event_listeners;
+	uint64_t event_listener_mask; /* union of all listener masks */
+	uint64_t event_mask; /* event types the caller subscribed to */
 	void *user_data;
 	int refcount;
 	struct libinput_device_config config;
+	struct libinput_stats stats;
+
+	struct {
+		struct motion_prediction pointer;
+		struct motion_prediction gesture;
+	} prediction;
+
+	struct {
+		uint32_t generation; /* of the export the id belongs to */
+		uint32_t id;
+		int slot; /* in the device table, -1 if it didn't fit */
+	} export;
 };
 
 enum libinput_tablet_tool_axis {
@@ -337,6 +391,8 @@ struct tablet_axes {
 	int wheel_discrete;
 };
 
+#define TABLET_TOOL_SMOOTHING_DEFAULT_STRENGTH 0.5
+
 struct libinput_tablet_tool {
 	struct list link;
 	uint32_t serial;
@@ -351,6 +407,11 @@ struct libinput_tablet_tool {
 	struct threshold pressure_threshold;
 	int pressure_offset; /* in device coordinates */
 	bool has_pressure_offset;
+
+	struct {
+		enum libinput_config_tablet_tool_smoothing mode;
+		double strength;
+	} smoothing;
 };
 
 struct libinput_tablet_pad_mode_group {
@@ -379,10 +440,85 @@ struct libinput_event {
 
 struct libinput_event_listener {
 	struct list link;
+	struct libinput_device *device;
+	uint64_t event_mask;
 	void (*notify_func)(uint64_t time, struct libinput_event *ev, void *notify_func_data);
 	void *notify_func_data;
 };
 
+/**
+ * A dense index in [0, LIBINPUT_EVENT_TYPE_INDEX_MAX) for the given event
+ * type. Event types are grouped in blocks of 100 with less than 8 types
+ * per block and the blocks 100 and 200 are unused, so each block gets 8
+ * slots.
+ */
+static inline unsigned int
+event_type_index(enum libinput_event_type type)
+{
+	unsigned int block = type / 100,
+		     index = type % 100;
+
+	if (block > 0)
+		block -= 2;
+
+	assert(block < 8 && index < 8);
+
+	return block * 8 + index;
+}
+
+/**
+ * The bit for the given event type in a libinput_event_listener mask.
+ */
+static inline uint64_t
+event_listener_mask(enum libinput_event_type type)
+{
+	return 1ULL << event_type_index(type);
+}
+
+/**
+ * True if the caller subscribed to any of the event types in the mask on
+ * this device, both on the context and on the device.
+ */
+static inline bool
+libinput_device_event_subscribed(struct libinput_device *device,
+				 uint64_t mask)
+{
+	struct libinput *libinput = device->seat->libinput;
+
+	return (libinput->event_mask & device->event_mask & mask) != 0;
+}
+
+/**
+ * True if anyone will see an event of any of the types in the mask on this
+ * device, either the caller or an internal event listener. Code producing
+ * events may skip the work for events nobody wants.
+ */
+static inline bool
+libinput_device_event_wanted(struct libinput_device *device,
+			     uint64_t mask)
+{
+	return libinput_device_event_subscribed(device, mask) ||
+		(device->event_listener_mask & mask) != 0;
+}
+
+static inline void
+libinput_stats_add(struct libinput *libinput,
+		   enum libinput_stat stat,
+		   uint64_t value)
+{
+	libinput->stats.counters[stat] += value;
+}
+
+/* Adds to both the device and the context counter */
+static inline void
+libinput_device_stats_add(struct libinput_device *device,
+			  enum libinput_stat stat,
+			  uint64_t value)
+{
+	device->stats.counters[stat] += value;
+	libinput_stats_add(device->seat->libinput, stat, value);
+}
+
 typedef void (*libinput_source_dispatch_t)(void *data);
 
 #define log_debug(li_, ...) log_msg((li_), LIBINPUT_LOG_PRIORITY_DEBUG, __VA_ARGS__)
@@ -452,6 +588,12 @@ libinput_seat_init(struct libinput_seat *seat,
 		   const char *logical_name,
 		   libinput_seat_destroy_func destroy);
 
+int32_t
+libinput_seat_alloc_slot(struct libinput_seat *seat);
+
+void
+libinput_seat_release_slot(struct libinput_seat *seat, int32_t seat_slot);
+
 void
 libinput_device_init(struct libinput_device *device,
 		     struct libinput_seat *seat);
@@ -474,6 +616,7 @@ libinput_device_init_event_listener(struct libinput_event_listener *listener);
 void
 libinput_device_add_event_listener(struct libinput_device *device,
 				   struct libinput_event_listener *listener,
+				   uint64_t event_mask,
 				   void (*notify_func)(
 						uint64_t time,
 						struct libinput_event *event,
@@ -532,7 +675,8 @@ touch_notify_touch_motion(struct libinput_device *device,
 			  uint64_t time,
 			  int32_t slot,
 			  int32_t seat_slot,
-			  const struct device_coords *point);
+			  const struct device_coords *point,
+			  const struct device_float_coords *velocity);
 
 void
 touch_notify_touch_up(struct libinput_device *device,
@@ -787,4 +931,64 @@ device_float_get_direction(struct device_float_coords coords)
 {
 	return xy_get_direction(coords.x, coords.y);
 }
+
+static inline void
+motion_prediction_reset(struct motion_prediction *p, uint64_t time)
+{
+	*p = (struct motion_prediction) { .time = time };
+}
+
+/**
+ * Feed the delta of a new event into the predictor. The velocity is an
+ * exponential moving average with a factor of 0.5, so the newest event
+ * weighs as much as all older events of the motion together. It is
+ * dropped to zero if the deltas are too far apart or if the direction
+ * reversed, extrapolating across a reversal overshoots in the wrong
+ * direction.
+ */
+static inline void
+motion_prediction_update(struct motion_prediction *p,
+			 uint64_t time,
+			 double dx,
+			 double dy)
+{
+	double dt, vx, vy;
+
+	if (time <= p->time ||
+	    time - p->time > MOTION_PREDICTION_MAX_INTERVAL ||
+	    dx * p->dx + dy * p->dy < 0) {
+		p->vx = 0.0;
+		p->vy = 0.0;
+	} else {
+		dt = time - p->time;
+		vx = dx/dt;
+		vy = dy/dt;
+
+		if (p->vx == 0.0 && p->vy == 0.0) {
+			p->vx = vx;
+			p->vy = vy;
+		} else {
+			p->vx = (p->vx + vx)/2.0;
+			p->vy = (p->vy + vy)/2.0;
+		}
+	}
+
+	p->time = time;
+	p->dx = dx;
+	p->dy = dy;
+}
+
+/**
+ * @return the time in µs to extrapolate an event at time to the target
+ * time, clamped to MOTION_PREDICTION_MAX_HORIZON. Targets in the past
+ * return 0.
+ */
+static inline double
+motion_prediction_interval(uint64_t time, uint64_t target)
+{
+	if (target <= time)
+		return 0.0;
+
+	return min(target - time, MOTION_PREDICTION_MAX_HORIZON);
+}
 #endif /* LIBINPUT_PRIVATE_H */
@@ -37,6 +37,9 @@
 #include "libinput-private.h"
 #include "evdev.h"
 #include "timer.h"
+#include "log-ring.h"
+#include "event-export.h"
+#include "trace.h"
 
 #define require_event_type(li_, type_, retval_, ...)	\
 	if (type_ == LIBINPUT_EVENT_NONE) abort(); \
@@ -166,6 +169,7 @@ struct libinput_event_pointer {
 	uint64_t time;
 	struct normalized_coords delta;
 	struct device_float_coords delta_raw;
+	struct normalized_coords velocity;
 	struct device_coords absolute;
 	struct discrete_coords discrete;
 	uint32_t button;
@@ -181,6 +185,7 @@ struct libinput_event_touch {
 	int32_t slot;
 	int32_t seat_slot;
 	struct device_coords point;
+	struct device_float_coords velocity;
 };
 
 struct libinput_event_gesture {
@@ -190,6 +195,7 @@ struct libinput_event_gesture {
 	int cancelled;
 	struct normalized_coords delta;
 	struct normalized_coords delta_unaccel;
+	struct normalized_coords velocity;
 	double scale;
 	double angle;
 };
@@ -260,8 +266,13 @@ log_msg_va(struct libinput *libinput,
 	   const char *format,
 	   va_list args)
 {
-	if (libinput->log_handler &&
-	    libinput->log_priority <= priority)
+	if (!libinput->log_handler ||
+	    libinput->log_priority > priority)
+		return;
+
+	if (libinput->log_ring)
+		log_ring_push(libinput->log_ring, priority, format, args);
+	else
 		libinput->log_handler(libinput, priority, format, args);
 }
 
@@ -322,6 +333,200 @@ libinput_log_set_handler(struct libinput *libinput,
 	libinput->log_handler = log_handler;
 }
 
+LIBINPUT_ATTRIBUTE_PRINTF(3, 4)
+static void
+log_call_handler(struct libinput *libinput,
+		 enum libinput_log_priority priority,
+		 const char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	libinput->log_handler(libinput, priority, format, args);
+	va_end(args);
+}
+
+static void
+libinput_log_drain_func(enum libinput_log_priority priority,
+			const char *message,
+			void *data)
+{
+	struct libinput *libinput = data;
+
+	if (libinput->log_handler)
+		log_call_handler(libinput, priority, "%s", message);
+}
+
+LIBINPUT_EXPORT int
+libinput_log_set_deferred(struct libinput *libinput, unsigned int size)
+{
+	struct log_ring *ring = NULL;
+
+	if (size > 65536)
+		return -EINVAL;
+
+	if (size > 0) {
+		ring = log_ring_create(size);
+		if (!ring)
+			return -ENOMEM;
+	}
+
+	if (libinput->log_ring) {
+		libinput_log_drain(libinput);
+		libinput->log_dropped +=
+			log_ring_get_dropped(libinput->log_ring);
+		log_ring_destroy(libinput->log_ring);
+	}
+
+	libinput->log_ring = ring;
+
+	return 0;
+}
+
+LIBINPUT_EXPORT unsigned int
+libinput_log_drain(struct libinput *libinput)
+{
+	if (!libinput->log_ring)
+		return 0;
+
+	return log_ring_drain(libinput->log_ring,
+			      libinput_log_drain_func,
+			      libinput);
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_log_get_dropped(struct libinput *libinput)
+{
+	uint64_t dropped = libinput->log_dropped;
+
+	if (libinput->log_ring)
+		dropped += log_ring_get_dropped(libinput->log_ring);
+
+	return dropped;
+}
+
+LIBINPUT_EXPORT int
+libinput_export_enable(struct libinput *libinput, unsigned int size)
+{
+	struct event_export *export = NULL;
+
+	if (size > 0) {
+		export = event_export_create(size);
+		if (!export)
+			return -errno;
+	}
+
+	event_export_destroy(libinput->export);
+	libinput->export = export;
+
+	return 0;
+}
+
+LIBINPUT_EXPORT int
+libinput_export_get_fd(struct libinput *libinput)
+{
+	if (!libinput->export)
+		return -1;
+
+	return event_export_get_fd(libinput->export);
+}
+
+LIBINPUT_EXPORT int
+libinput_export_add_notify_fd(struct libinput *libinput, int fd)
+{
+	if (!libinput->export)
+		return -EINVAL;
+
+	return event_export_add_notify_fd(libinput->export, fd);
+}
+
+LIBINPUT_EXPORT int
+libinput_export_remove_notify_fd(struct libinput *libinput, int fd)
+{
+	if (!libinput->export)
+		return -EINVAL;
+
+	return event_export_remove_notify_fd(libinput->export, fd);
+}
+
+static inline bool
+check_stat(struct libinput *libinput, enum libinput_stat stat)
+{
+	if (stat >= 1 && stat <= LIBINPUT_STAT_MAX)
+		return true;
+
+	log_bug_client(libinput, "invalid statistics counter %d\n", stat);
+	return false;
+}
+
+static inline bool
+check_event_stat_type(struct libinput *libinput,
+		      enum libinput_event_type type)
+{
+	if (type != LIBINPUT_EVENT_NONE && event_type_to_str(type))
+		return true;
+
+	log_bug_client(libinput, "invalid event type %d\n", type);
+	return false;
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_get_stats(struct libinput *libinput, enum libinput_stat stat)
+{
+	if (!check_stat(libinput, stat))
+		return 0;
+
+	return libinput->stats.counters[stat];
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_get_event_stats(struct libinput *libinput,
+			 enum libinput_event_type type)
+{
+	if (!check_event_stat_type(libinput, type))
+		return 0;
+
+	return libinput->stats.events[event_type_index(type)];
+}
+
+static inline bool
+check_event_mask_type(struct libinput *libinput,
+		      enum libinput_event_type type)
+{
+	if (!check_event_stat_type(libinput, type))
+		return false;
+
+	/* The caller must always see devices come and go */
+	return type != LIBINPUT_EVENT_DEVICE_ADDED &&
+	       type != LIBINPUT_EVENT_DEVICE_REMOVED;
+}
+
+LIBINPUT_EXPORT int
+libinput_set_event_type_enabled(struct libinput *libinput,
+				enum libinput_event_type type,
+				int enabled)
+{
+	if (!check_event_mask_type(libinput, type))
+		return -EINVAL;
+
+	if (enabled)
+		libinput->event_mask |= event_listener_mask(type);
+	else
+		libinput->event_mask &= ~event_listener_mask(type);
+
+	return 0;
+}
+
+LIBINPUT_EXPORT int
+libinput_get_event_type_enabled(struct libinput *libinput,
+				enum libinput_event_type type)
+{
+	if (!check_event_mask_type(libinput, type))
+		return 0;
+
+	return !!(libinput->event_mask & event_listener_mask(type));
+}
+
 static void
 libinput_device_group_destroy(struct libinput_device_group *group);
 
@@ -582,6 +787,32 @@ libinput_event_pointer_get_dy_unaccelerated(
 	return event->delta_raw.y;
 }
 
+LIBINPUT_EXPORT double
+libinput_event_pointer_get_dx_predicted(struct libinput_event_pointer *event,
+					uint64_t time_usec)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_POINTER_MOTION);
+
+	return event->velocity.x *
+		motion_prediction_interval(event->time, time_usec);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_pointer_get_dy_predicted(struct libinput_event_pointer *event,
+					uint64_t time_usec)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_POINTER_MOTION);
+
+	return event->velocity.y *
+		motion_prediction_interval(event->time, time_usec);
+}
+
 LIBINPUT_EXPORT double
 libinput_event_pointer_get_absolute_x(struct libinput_event_pointer *event)
 {
@@ -872,6 +1103,86 @@ libinput_event_touch_get_y(struct libinput_event_touch *event)
 	return evdev_convert_to_mm(device->abs.absinfo_y, event->point.y);
 }
 
+LIBINPUT_EXPORT double
+libinput_event_touch_get_x_predicted(struct libinput_event_touch *event,
+				     uint64_t time_usec)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	double x;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
+
+	x = event->point.x + event->velocity.x *
+		motion_prediction_interval(event->time, time_usec);
+
+	return evdev_convert_to_mm(device->abs.absinfo_x, x);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_y_predicted(struct libinput_event_touch *event,
+				     uint64_t time_usec)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	double y;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
+
+	y = event->point.y + event->velocity.y *
+		motion_prediction_interval(event->time, time_usec);
+
+	return evdev_convert_to_mm(device->abs.absinfo_y, y);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_x_transformed_predicted(
+	struct libinput_event_touch *event,
+	uint32_t width,
+	uint64_t time_usec)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	double x;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
+
+	x = event->point.x + event->velocity.x *
+		motion_prediction_interval(event->time, time_usec);
+
+	return evdev_device_transform_x(device, x, width);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_y_transformed_predicted(
+	struct libinput_event_touch *event,
+	uint32_t height,
+	uint64_t time_usec)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	double y;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
+
+	y = event->point.y + event->velocity.y *
+		motion_prediction_interval(event->time, time_usec);
+
+	return evdev_device_transform_y(device, y, height);
+}
+
 LIBINPUT_EXPORT uint32_t
 libinput_event_gesture_get_time(struct libinput_event_gesture *event)
 {
@@ -998,6 +1309,42 @@ libinput_event_gesture_get_dy_unaccelerated(
 	return event->delta_unaccel.y;
 }
 
+LIBINPUT_EXPORT double
+libinput_event_gesture_get_dx_predicted(struct libinput_event_gesture *event,
+					uint64_t time_usec)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0.0,
+			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_PINCH_END,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+
+	return event->velocity.x *
+		motion_prediction_interval(event->time, time_usec);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_gesture_get_dy_predicted(struct libinput_event_gesture *event,
+					uint64_t time_usec)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0.0,
+			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_PINCH_END,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+
+	return event->velocity.y *
+		motion_prediction_interval(event->time, time_usec);
+}
+
 LIBINPUT_EXPORT double
 libinput_event_gesture_get_scale(struct libinput_event_gesture *event)
 {
@@ -1698,6 +2045,7 @@ libinput_init(struct libinput *libinput,
 
 	libinput->log_handler = libinput_default_log_func;
 	libinput->log_priority = LIBINPUT_LOG_PRIORITY_ERROR;
+	libinput->event_mask = ~0ULL;
 	libinput->interface = interface;
 	libinput->interface_backend = interface_backend;
 	libinput->user_data = user_data;
@@ -1788,6 +2136,8 @@ libinput_unref(struct libinput *libinput)
 	libinput_timer_subsys_destroy(libinput);
 	libinput_drop_destroyed_sources(libinput);
 	close(libinput->epoll_fd);
+	libinput_log_set_deferred(libinput, 0);
+	event_export_destroy(libinput->export);
 	free(libinput);
 
 	return NULL;
@@ -1887,11 +2237,93 @@ static void
 libinput_seat_destroy(struct libinput_seat *seat)
 {
 	list_remove(&seat->link);
+	free(seat->slot_map.available);
+	free(seat->slot_map.nonfull);
 	free(seat->logical_name);
 	free(seat->physical_name);
 	seat->destroy(seat);
 }
 
+static bool
+libinput_seat_grow_slot_map(struct libinput_seat *seat)
+{
+	size_t nlongs = seat->slot_map.nlongs;
+	size_t new_nlongs = nlongs ? nlongs * 2 : 1;
+	unsigned long *available, *nonfull;
+	size_t i;
+
+	if (new_nlongs * LONG_BITS > INT32_MAX)
+		return false;
+
+	available = realloc(seat->slot_map.available,
+			    new_nlongs * sizeof *available);
+	if (!available)
+		return false;
+	seat->slot_map.available = available;
+
+	nonfull = realloc(seat->slot_map.nonfull,
+			  NLONGS(new_nlongs) * sizeof *nonfull);
+	if (!nonfull)
+		return false;
+	seat->slot_map.nonfull = nonfull;
+
+	for (i = NLONGS(nlongs); i < NLONGS(new_nlongs); i++)
+		nonfull[i] = 0;
+
+	for (i = nlongs; i < new_nlongs; i++) {
+		available[i] = ~0UL;
+		long_set_bit(nonfull, i);
+	}
+
+	seat->slot_map.nlongs = new_nlongs;
+
+	return true;
+}
+
+/**
+ * @return the lowest free seat slot, or -1 if the slot map could not be
+ * grown
+ */
+int32_t
+libinput_seat_alloc_slot(struct libinput_seat *seat)
+{
+	unsigned long *available, *nonfull;
+	size_t i, idx;
+	unsigned int bit;
+
+	do {
+		available = seat->slot_map.available;
+		nonfull = seat->slot_map.nonfull;
+
+		for (i = 0; i < NLONGS(seat->slot_map.nlongs); i++) {
+			if (nonfull[i] == 0)
+				continue;
+
+			idx = i * LONG_BITS + __builtin_ctzl(nonfull[i]);
+			bit = __builtin_ctzl(available[idx]);
+
+			available[idx] &= ~(1UL << bit);
+			if (available[idx] == 0)
+				long_clear_bit(nonfull, idx);
+
+			return idx * LONG_BITS + bit;
+		}
+	} while (libinput_seat_grow_slot_map(seat));
+
+	return -1;
+}
+
+void
+libinput_seat_release_slot(struct libinput_seat *seat, int32_t seat_slot)
+{
+	size_t idx = seat_slot / LONG_BITS;
+
+	assert(seat_slot >= 0 && idx < seat->slot_map.nlongs);
+
+	seat->slot_map.available[idx] |= 1UL << (seat_slot % LONG_BITS);
+	long_set_bit(seat->slot_map.nonfull, idx);
+}
+
 LIBINPUT_EXPORT struct libinput_seat *
 libinput_seat_unref(struct libinput_seat *seat)
 {
@@ -1942,6 +2374,9 @@ libinput_device_init(struct libinput_device *device,
 	device->seat = seat;
 	device->refcount = 1;
 	list_init(&device->event_listeners);
+	device->event_listener_mask = 0;
+	device->event_mask = ~0ULL;
+	memset(&device->stats, 0, sizeof(device->stats));
 }
 
 LIBINPUT_EXPORT struct libinput_device *
@@ -1996,8 +2431,15 @@ libinput_dispatch(struct libinput *libinput)
 		source->dispatch(source->user_data);
 	}
 
+	/* Timers with slack may have expired without waking us up yet,
+	 * fire them now that we're awake anyway */
+	libinput_timer_flush(libinput);
+
 	libinput_drop_destroyed_sources(libinput);
 
+	if (libinput->export)
+		event_export_notify(libinput->export);
+
 	return 0;
 }
 
@@ -2005,26 +2447,49 @@ void
 libinput_device_init_event_listener(struct libinput_event_listener *listener)
 {
 	list_init(&listener->link);
+	listener->device = NULL;
+	listener->event_mask = 0;
+}
+
+static void
+libinput_device_update_event_listener_mask(struct libinput_device *device)
+{
+	struct libinput_event_listener *listener;
+	uint64_t mask = 0;
+
+	list_for_each(listener, &device->event_listeners, link)
+		mask |= listener->event_mask;
+
+	device->event_listener_mask = mask;
 }
 
 void
 libinput_device_add_event_listener(struct libinput_device *device,
 				   struct libinput_event_listener *listener,
+				   uint64_t event_mask,
 				   void (*notify_func)(
 						uint64_t time,
 						struct libinput_event *event,
 						void *notify_func_data),
 				   void *notify_func_data)
 {
+	listener->device = device;
+	listener->event_mask = event_mask;
 	listener->notify_func = notify_func;
 	listener->notify_func_data = notify_func_data;
 	list_insert(&device->event_listeners, &listener->link);
+	device->event_listener_mask |= event_mask;
 }
 
 void
 libinput_device_remove_event_listener(struct libinput_event_listener *listener)
 {
 	list_remove(&listener->link);
+
+	if (listener->device) {
+		libinput_device_update_event_listener_mask(listener->device);
+		listener->device = NULL;
+	}
 }
 
 static uint32_t
@@ -2095,6 +2560,7 @@ post_device_event(struct libinput_device *device,
 		  struct libinput_event *event)
 {
 	struct libinput_event_listener *listener, *tmp;
+	uint64_t mask;
 #if 0
 	struct libinput *libinput = device->seat->libinput;
 
@@ -2109,12 +2575,36 @@ post_device_event(struct libinput_device *device,
 
 	init_event_base(event, device, type);
 
-	list_for_each_safe(listener, tmp, &device->event_listeners, link)
-		listener->notify_func(time, event, listener->notify_func_data);
+	/* Most events have nobody listening, don't walk the list */
+	mask = event_listener_mask(type);
+	if ((device->event_listener_mask & mask) == 0)
+		goto out;
+
+	list_for_each_safe(listener, tmp, &device->event_listeners, link) {
+		if (listener->event_mask & mask)
+			listener->notify_func(time,
+					      event,
+					      listener->notify_func_data);
+	}
+
+out:
+	/* Only our own listeners wanted this one. The event was never
+	 * queued, so it doesn't hold a device reference yet */
+	if (!libinput_device_event_subscribed(device, mask)) {
+		event->device = NULL;
+		libinput_event_destroy(event);
+		return;
+	}
 
 	libinput_post_event(device->seat->libinput, event);
 }
 
+static inline bool
+event_wanted(struct libinput_device *device, enum libinput_event_type type)
+{
+	return libinput_device_event_wanted(device, event_listener_mask(type));
+}
+
 void
 notify_added_device(struct libinput_device *device)
 {
@@ -2196,12 +2686,15 @@ keyboard_notify_key(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_KEYBOARD))
 		return;
 
+	seat_key_count = update_seat_key_count(device->seat, key, state);
+
+	if (!event_wanted(device, LIBINPUT_EVENT_KEYBOARD_KEY))
+		return;
+
 	key_event = zalloc(sizeof *key_event);
 	if (!key_event)
 		return;
 
-	seat_key_count = update_seat_key_count(device->seat, key, state);
-
 	*key_event = (struct libinput_event_keyboard) {
 		.time = time,
 		.key = key,
@@ -2221,18 +2714,27 @@ pointer_notify_motion(struct libinput_device *device,
 		      const struct device_float_coords *raw)
 {
 	struct libinput_event_pointer *motion_event;
+	struct motion_prediction *prediction = &device->prediction.pointer;
 
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_POINTER_MOTION))
+		return;
+
 	motion_event = zalloc(sizeof *motion_event);
 	if (!motion_event)
 		return;
 
+	/* Updated for every event, only the getters are optional */
+	motion_prediction_update(prediction, time, delta->x, delta->y);
+
 	*motion_event = (struct libinput_event_pointer) {
 		.time = time,
 		.delta = *delta,
 		.delta_raw = *raw,
+		.velocity.x = prediction->vx,
+		.velocity.y = prediction->vy,
 	};
 
 	post_device_event(device, time,
@@ -2250,6 +2752,9 @@ pointer_notify_motion_absolute(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE))
+		return;
+
 	motion_absolute_event = zalloc(sizeof *motion_absolute_event);
 	if (!motion_absolute_event)
 		return;
@@ -2276,14 +2781,17 @@ pointer_notify_button(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
-	button_event = zalloc(sizeof *button_event);
-	if (!button_event)
-		return;
-
 	seat_button_count = update_seat_button_count(device->seat,
 						     button,
 						     state);
 
+	if (!event_wanted(device, LIBINPUT_EVENT_POINTER_BUTTON))
+		return;
+
+	button_event = zalloc(sizeof *button_event);
+	if (!button_event)
+		return;
+
 	*button_event = (struct libinput_event_pointer) {
 		.time = time,
 		.button = button,
@@ -2309,6 +2817,9 @@ pointer_notify_axis(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_POINTER_AXIS))
+		return;
+
 	axis_event = zalloc(sizeof *axis_event);
 	if (!axis_event)
 		return;
@@ -2338,6 +2849,9 @@ touch_notify_touch_down(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TOUCH_DOWN))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 	if (!touch_event)
 		return;
@@ -2359,13 +2873,17 @@ touch_notify_touch_motion(struct libinput_device *device,
 			  uint64_t time,
 			  int32_t slot,
 			  int32_t seat_slot,
-			  const struct device_coords *point)
+			  const struct device_coords *point,
+			  const struct device_float_coords *velocity)
 {
 	struct libinput_event_touch *touch_event;
 
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TOUCH_MOTION))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 	if (!touch_event)
 		return;
@@ -2375,6 +2893,7 @@ touch_notify_touch_motion(struct libinput_device *device,
 		.slot = slot,
 		.seat_slot = seat_slot,
 		.point = *point,
+		.velocity = *velocity,
 	};
 
 	post_device_event(device, time,
@@ -2393,6 +2912,9 @@ touch_notify_touch_up(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TOUCH_UP))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 	if (!touch_event)
 		return;
@@ -2417,6 +2939,9 @@ touch_notify_frame(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TOUCH_FRAME))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 	if (!touch_event)
 		return;
@@ -2440,6 +2965,9 @@ tablet_notify_axis(struct libinput_device *device,
 {
 	struct libinput_event_tablet_tool *axis_event;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TABLET_TOOL_AXIS))
+		return;
+
 	axis_event = zalloc(sizeof *axis_event);
 	if (!axis_event)
 		return;
@@ -2472,6 +3000,9 @@ tablet_notify_proximity(struct libinput_device *device,
 {
 	struct libinput_event_tablet_tool *proximity_event;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY))
+		return;
+
 	proximity_event = zalloc(sizeof *proximity_event);
 	if (!proximity_event)
 		return;
@@ -2503,6 +3034,9 @@ tablet_notify_tip(struct libinput_device *device,
 {
 	struct libinput_event_tablet_tool *tip_event;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TABLET_TOOL_TIP))
+		return;
+
 	tip_event = zalloc(sizeof *tip_event);
 	if (!tip_event)
 		return;
@@ -2536,14 +3070,17 @@ tablet_notify_button(struct libinput_device *device,
 	struct libinput_event_tablet_tool *button_event;
 	int32_t seat_button_count;
 
-	button_event = zalloc(sizeof *button_event);
-	if (!button_event)
-		return;
-
 	seat_button_count = update_seat_button_count(device->seat,
 						     button,
 						     state);
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TABLET_TOOL_BUTTON))
+		return;
+
+	button_event = zalloc(sizeof *button_event);
+	if (!button_event)
+		return;
+
 	*button_event = (struct libinput_event_tablet_tool) {
 		.time = time,
 		.tool = libinput_tablet_tool_ref(tool),
@@ -2571,6 +3108,9 @@ tablet_pad_notify_button(struct libinput_device *device,
 	struct libinput_event_tablet_pad *button_event;
 	unsigned int mode;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TABLET_PAD_BUTTON))
+		return;
+
 	button_event = zalloc(sizeof *button_event);
 	if (!button_event)
 		return;
@@ -2602,6 +3142,9 @@ tablet_pad_notify_ring(struct libinput_device *device,
 	struct libinput_event_tablet_pad *ring_event;
 	unsigned int mode;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TABLET_PAD_RING))
+		return;
+
 	ring_event = zalloc(sizeof *ring_event);
 	if (!ring_event)
 		return;
@@ -2634,6 +3177,9 @@ tablet_pad_notify_strip(struct libinput_device *device,
 	struct libinput_event_tablet_pad *strip_event;
 	unsigned int mode;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_TABLET_PAD_STRIP))
+		return;
+
 	strip_event = zalloc(sizeof *strip_event);
 	if (!strip_event)
 		return;
@@ -2667,20 +3213,36 @@ gesture_notify(struct libinput_device *device,
 	       double angle)
 {
 	struct libinput_event_gesture *gesture_event;
+	struct motion_prediction *prediction = &device->prediction.gesture;
 
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_GESTURE))
 		return;
 
+	if (!event_wanted(device, type))
+		return;
+
 	gesture_event = zalloc(sizeof *gesture_event);
 	if (!gesture_event)
 		return;
 
+	switch (type) {
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+		motion_prediction_update(prediction, time, delta->x, delta->y);
+		break;
+	default:
+		motion_prediction_reset(prediction, time);
+		break;
+	}
+
 	*gesture_event = (struct libinput_event_gesture) {
 		.time = time,
 		.finger_count = finger_count,
 		.cancelled = cancelled,
 		.delta = *delta,
 		.delta_unaccel = *unaccel,
+		.velocity.x = prediction->vx,
+		.velocity.y = prediction->vy,
 		.scale = scale,
 		.angle = angle,
 	};
@@ -2751,6 +3313,9 @@ switch_notify_toggle(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_SWITCH))
 		return;
 
+	if (!event_wanted(device, LIBINPUT_EVENT_SWITCH_TOGGLE))
+		return;
+
 	switch_event = zalloc(sizeof *switch_event);
 	if (!switch_event)
 		return;
@@ -2813,6 +3378,27 @@ libinput_post_event(struct libinput *libinput,
 	libinput->events_count = events_count;
 	events[libinput->events_in] = event;
 	libinput->events_in = (libinput->events_in + 1) % libinput->events_len;
+
+	libinput->stats.events[event_type_index(event->type)]++;
+	if (event->device) {
+		event->device->stats.events[event_type_index(event->type)]++;
+		libinput_device_stats_add(event->device,
+					  LIBINPUT_STAT_EVENTS_POSTED,
+					  1);
+	} else {
+		libinput_stats_add(libinput, LIBINPUT_STAT_EVENTS_POSTED, 1);
+	}
+	if (events_count > libinput->stats.counters[LIBINPUT_STAT_QUEUE_PEAK])
+		libinput->stats.counters[LIBINPUT_STAT_QUEUE_PEAK] = events_count;
+
+	if (libinput->export)
+		event_export_write(libinput->export, event);
+
+	trace_probe4(event_post,
+		     event->device ? evdev_device(event->device)->sysname : NULL,
+		     event->type,
+		     events_count,
+		     libinput_now(libinput));
 }
 
 LIBINPUT_EXPORT struct libinput_event *
@@ -2828,6 +3414,12 @@ libinput_get_event(struct libinput *libinput)
 		(libinput->events_out + 1) % libinput->events_len;
 	libinput->events_count--;
 
+	trace_probe4(event_get,
+		     event->device ? evdev_device(event->device)->sysname : NULL,
+		     event->type,
+		     libinput->events_count,
+		     libinput_now(libinput));
+
 	return event;
 }
 
@@ -2898,6 +3490,52 @@ libinput_device_get_sysname(struct libinput_device *device)
 	return evdev_device_get_sysname((struct evdev_device *) device);
 }
 
+LIBINPUT_EXPORT uint64_t
+libinput_device_get_stats(struct libinput_device *device,
+			  enum libinput_stat stat)
+{
+	if (!check_stat(device->seat->libinput, stat))
+		return 0;
+
+	return device->stats.counters[stat];
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_device_get_event_stats(struct libinput_device *device,
+				enum libinput_event_type type)
+{
+	if (!check_event_stat_type(device->seat->libinput, type))
+		return 0;
+
+	return device->stats.events[event_type_index(type)];
+}
+
+LIBINPUT_EXPORT int
+libinput_device_set_event_type_enabled(struct libinput_device *device,
+				       enum libinput_event_type type,
+				       int enabled)
+{
+	if (!check_event_mask_type(device->seat->libinput, type))
+		return -EINVAL;
+
+	if (enabled)
+		device->event_mask |= event_listener_mask(type);
+	else
+		device->event_mask &= ~event_listener_mask(type);
+
+	return 0;
+}
+
+LIBINPUT_EXPORT int
+libinput_device_get_event_type_enabled(struct libinput_device *device,
+				       enum libinput_event_type type)
+{
+	if (!check_event_mask_type(device->seat->libinput, type))
+		return 0;
+
+	return !!(device->event_mask & event_listener_mask(type));
+}
+
 LIBINPUT_EXPORT const char *
 libinput_device_get_name(struct libinput_device *device)
 {
@@ -3942,6 +4580,16 @@ libinput_device_config_middle_emulation_get_default_enabled(
 	return device->config.middle_emulation->get_default(device);
 }
 
+LIBINPUT_EXPORT uint64_t
+libinput_device_config_middle_emulation_get_timeout_usec(
+		struct libinput_device *device)
+{
+	if (!device->config.middle_emulation)
+		return 0;
+
+	return device->config.middle_emulation->get_timeout(device);
+}
+
 LIBINPUT_EXPORT uint32_t
 libinput_device_config_scroll_get_methods(struct libinput_device *device)
 {
@@ -4109,3 +4757,62 @@ libinput_device_config_rotation_get_default_angle(struct libinput_device *device
 
 	return device->config.rotation->get_default_angle(device);
 }
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_tablet_tool_config_smoothing_set_mode(
+	struct libinput_tablet_tool *tool,
+	enum libinput_config_tablet_tool_smoothing mode)
+{
+	switch (mode) {
+	case LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_AVERAGE:
+	case LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_ADAPTIVE:
+		break;
+	default:
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+	}
+
+	tool->smoothing.mode = mode;
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+LIBINPUT_EXPORT enum libinput_config_tablet_tool_smoothing
+libinput_tablet_tool_config_smoothing_get_mode(
+	struct libinput_tablet_tool *tool)
+{
+	return tool->smoothing.mode;
+}
+
+LIBINPUT_EXPORT enum libinput_config_tablet_tool_smoothing
+libinput_tablet_tool_config_smoothing_get_default_mode(
+	struct libinput_tablet_tool *tool)
+{
+	return LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_AVERAGE;
+}
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_tablet_tool_config_smoothing_set_strength(
+	struct libinput_tablet_tool *tool,
+	double strength)
+{
+	if (strength < 0.0 || strength > 1.0)
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	tool->smoothing.strength = strength;
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+LIBINPUT_EXPORT double
+libinput_tablet_tool_config_smoothing_get_strength(
+	struct libinput_tablet_tool *tool)
+{
+	return tool->smoothing.strength;
+}
+
+LIBINPUT_EXPORT double
+libinput_tablet_tool_config_smoothing_get_default_strength(
+	struct libinput_tablet_tool *tool)
+{
+	return TABLET_TOOL_SMOOTHING_DEFAULT_STRENGTH;
+}
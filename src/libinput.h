@@ -1152,6 +1152,80 @@ double
 libinput_event_pointer_get_dy_unaccelerated(
 	struct libinput_event_pointer *event);
 
+/**
+ * @ingroup event_pointer
+ *
+ * Return the predicted additional x delta between the time of this
+ * event and the given target time, e.g. the time of the next display
+ * refresh. The prediction extrapolates the accelerated motion of the
+ * recent events. The result is in the same coordinate space as
+ * libinput_event_pointer_get_dx().
+ *
+ * The prediction is a display-only offset from the current position, e.g.
+ * a cursor is drawn at the current position plus this offset to hide
+ * latency between the event and the target time. It must not be
+ * accumulated into the position, the dx of the following events already
+ * contains the motion it predicts.
+ *
+ * The prediction is 0 for the first event of a motion, after a pause in
+ * motion and when the direction of motion reversed. The target time is
+ * clamped to 50ms after the event time, target times before the event
+ * time return 0.
+ *
+ * Only calling this function is optional. The velocity estimate it is
+ * based on is updated for every motion event, so its small per-event
+ * cost applies whether or not the prediction is used.
+ *
+ * @note It is an application bug to call this function for events other than
+ * @ref LIBINPUT_EVENT_POINTER_MOTION.
+ *
+ * @param event The libinput pointer event
+ * @param time_usec The target time in microseconds, in the same clock as
+ * libinput_event_pointer_get_time_usec()
+ * @return The predicted relative x movement between the event time and
+ * the target time
+ */
+double
+libinput_event_pointer_get_dx_predicted(struct libinput_event_pointer *event,
+					uint64_t time_usec);
+
+/**
+ * @ingroup event_pointer
+ *
+ * Return the predicted additional y delta between the time of this
+ * event and the given target time, e.g. the time of the next display
+ * refresh. The prediction extrapolates the accelerated motion of the
+ * recent events. The result is in the same coordinate space as
+ * libinput_event_pointer_get_dy().
+ *
+ * The prediction is a display-only offset from the current position, e.g.
+ * a cursor is drawn at the current position plus this offset to hide
+ * latency between the event and the target time. It must not be
+ * accumulated into the position, the dy of the following events already
+ * contains the motion it predicts.
+ *
+ * The prediction is 0 for the first event of a motion, after a pause in
+ * motion and when the direction of motion reversed. The target time is
+ * clamped to 50ms after the event time, target times before the event
+ * time return 0.
+ *
+ * Only calling this function is optional. The velocity estimate it is
+ * based on is updated for every motion event, so its small per-event
+ * cost applies whether or not the prediction is used.
+ *
+ * @note It is an application bug to call this function for events other than
+ * @ref LIBINPUT_EVENT_POINTER_MOTION.
+ *
+ * @param event The libinput pointer event
+ * @param time_usec The target time in microseconds, in the same clock as
+ * libinput_event_pointer_get_time_usec()
+ * @return The predicted relative y movement between the event time and
+ * the target time
+ */
+double
+libinput_event_pointer_get_dy_predicted(struct libinput_event_pointer *event,
+					uint64_t time_usec);
+
 /**
  * @ingroup event_pointer
  *
@@ -1557,6 +1631,156 @@ double
 libinput_event_touch_get_y_transformed(struct libinput_event_touch *event,
 				       uint32_t height);
 
+/**
+ * @ingroup event_touch
+ *
+ * Return the x coordinate of the touch event extrapolated to the given
+ * target time, e.g. the time of the next display refresh. The
+ * coordinate is in mm from the top left corner of the device, see
+ * libinput_event_touch_get_x().
+ *
+ * The prediction extrapolates the recent motion of this touch point. For
+ * @ref LIBINPUT_EVENT_TOUCH_DOWN events, at the start of a motion, after a
+ * pause and when the direction of motion reversed, this function returns
+ * the same value as libinput_event_touch_get_x().
+ * The target time is clamped to 50ms after the event time.
+ *
+ * The predicted coordinate is for display only, e.g. to draw feedback
+ * ahead of the touch point. It must not be used in place of the touch
+ * position, the following events already contain the motion it predicts.
+ * The estimate is updated for every touch event, whether or not this
+ * function is called.
+ *
+ * For events not of type @ref LIBINPUT_EVENT_TOUCH_DOWN, @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @param time_usec The target time in microseconds, in the same clock as
+ * libinput_event_touch_get_time_usec()
+ * @return The predicted x coordinate at the target time
+ */
+double
+libinput_event_touch_get_x_predicted(struct libinput_event_touch *event,
+				     uint64_t time_usec);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the y coordinate of the touch event extrapolated to the given
+ * target time, e.g. the time of the next display refresh. The
+ * coordinate is in mm from the top left corner of the device, see
+ * libinput_event_touch_get_y().
+ *
+ * The prediction extrapolates the recent motion of this touch point. For
+ * @ref LIBINPUT_EVENT_TOUCH_DOWN events, at the start of a motion, after a
+ * pause and when the direction of motion reversed, this function returns
+ * the same value as libinput_event_touch_get_y().
+ * The target time is clamped to 50ms after the event time.
+ *
+ * The predicted coordinate is for display only, e.g. to draw feedback
+ * ahead of the touch point. It must not be used in place of the touch
+ * position, the following events already contain the motion it predicts.
+ * The estimate is updated for every touch event, whether or not this
+ * function is called.
+ *
+ * For events not of type @ref LIBINPUT_EVENT_TOUCH_DOWN, @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @param time_usec The target time in microseconds, in the same clock as
+ * libinput_event_touch_get_time_usec()
+ * @return The predicted y coordinate at the target time
+ */
+double
+libinput_event_touch_get_y_predicted(struct libinput_event_touch *event,
+				     uint64_t time_usec);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the x coordinate of the touch event extrapolated to the given
+ * target time, e.g. the time of the next display refresh. The
+ * coordinate is transformed to screen coordinates, see
+ * libinput_event_touch_get_x_transformed().
+ *
+ * The prediction extrapolates the recent motion of this touch point. For
+ * @ref LIBINPUT_EVENT_TOUCH_DOWN events, at the start of a motion, after a
+ * pause and when the direction of motion reversed, this function returns
+ * the same value as libinput_event_touch_get_x_transformed().
+ * The target time is clamped to 50ms after the event time.
+ *
+ * The predicted coordinate is for display only, e.g. to draw feedback
+ * ahead of the touch point. It must not be used in place of the touch
+ * position, the following events already contain the motion it predicts.
+ * The estimate is updated for every touch event, whether or not this
+ * function is called.
+ *
+ * For events not of type @ref LIBINPUT_EVENT_TOUCH_DOWN, @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @param width The current output screen width
+ * @param time_usec The target time in microseconds, in the same clock as
+ * libinput_event_touch_get_time_usec()
+ * @return The predicted x coordinate at the target time
+ */
+double
+libinput_event_touch_get_x_transformed_predicted(
+	struct libinput_event_touch *event,
+	uint32_t width,
+	uint64_t time_usec);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the y coordinate of the touch event extrapolated to the given
+ * target time, e.g. the time of the next display refresh. The
+ * coordinate is transformed to screen coordinates, see
+ * libinput_event_touch_get_y_transformed().
+ *
+ * The prediction extrapolates the recent motion of this touch point. For
+ * @ref LIBINPUT_EVENT_TOUCH_DOWN events, at the start of a motion, after a
+ * pause and when the direction of motion reversed, this function returns
+ * the same value as libinput_event_touch_get_y_transformed().
+ * The target time is clamped to 50ms after the event time.
+ *
+ * The predicted coordinate is for display only, e.g. to draw feedback
+ * ahead of the touch point. It must not be used in place of the touch
+ * position, the following events already contain the motion it predicts.
+ * The estimate is updated for every touch event, whether or not this
+ * function is called.
+ *
+ * For events not of type @ref LIBINPUT_EVENT_TOUCH_DOWN, @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @param height The current output screen height
+ * @param time_usec The target time in microseconds, in the same clock as
+ * libinput_event_touch_get_time_usec()
+ * @return The predicted y coordinate at the target time
+ */
+double
+libinput_event_touch_get_y_transformed_predicted(
+	struct libinput_event_touch *event,
+	uint32_t height,
+	uint64_t time_usec);
+
 /**
  * @ingroup event_touch
  *
@@ -1720,6 +1944,56 @@ double
 libinput_event_gesture_get_dy_unaccelerated(
 	struct libinput_event_gesture *event);
 
+/**
+ * @ingroup event_gesture
+ *
+ * Return the predicted additional x delta between the time of this
+ * event and the given target time, e.g. the time of the next display
+ * refresh. The prediction extrapolates the accelerated motion of the
+ * recent events of the current gesture, see
+ * libinput_event_pointer_get_dx_predicted() for details. Like the pointer
+ * prediction, this is a display-only offset that must not be accumulated
+ * into the gesture's position.
+ *
+ * For gesture events that are not of type
+ * @ref LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE or
+ * @ref LIBINPUT_EVENT_GESTURE_PINCH_UPDATE, this function returns 0.
+ *
+ * @param event The libinput gesture event
+ * @param time_usec The target time in microseconds, in the same clock as
+ * libinput_event_gesture_get_time_usec()
+ * @return the predicted relative x movement between the event time and
+ * the target time
+ */
+double
+libinput_event_gesture_get_dx_predicted(struct libinput_event_gesture *event,
+					uint64_t time_usec);
+
+/**
+ * @ingroup event_gesture
+ *
+ * Return the predicted additional y delta between the time of this
+ * event and the given target time, e.g. the time of the next display
+ * refresh. The prediction extrapolates the accelerated motion of the
+ * recent events of the current gesture, see
+ * libinput_event_pointer_get_dy_predicted() for details. Like the pointer
+ * prediction, this is a display-only offset that must not be accumulated
+ * into the gesture's position.
+ *
+ * For gesture events that are not of type
+ * @ref LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE or
+ * @ref LIBINPUT_EVENT_GESTURE_PINCH_UPDATE, this function returns 0.
+ *
+ * @param event The libinput gesture event
+ * @param time_usec The target time in microseconds, in the same clock as
+ * libinput_event_gesture_get_time_usec()
+ * @return the predicted relative y movement between the event time and
+ * the target time
+ */
+double
+libinput_event_gesture_get_dy_predicted(struct libinput_event_gesture *event,
+					uint64_t time_usec);
+
 /**
  * @ingroup event_gesture
  *
@@ -3236,6 +3510,355 @@ void
 libinput_log_set_handler(struct libinput *libinput,
 			 libinput_log_handler log_handler);
 
+/**
+ * @ingroup base
+ *
+ * Defer the formatting of log messages. Once enabled, messages that pass
+ * the context's log priority are stored in a ring buffer of the given
+ * number of messages instead of being passed to the log handler. The
+ * log handler is only invoked from libinput_log_drain(), with a format
+ * of "%s" and the fully formatted message. This keeps the cost of
+ * debug logging on the input path low.
+ *
+ * Where the ring buffer is full, new messages are discarded and counted,
+ * see libinput_log_get_dropped().
+ *
+ * The ring buffer is lock-free: libinput_log_drain() may be called from
+ * one other thread while the context is in use on its own thread. All
+ * other functions must be called from the context's thread.
+ *
+ * Calling this function with a size of 0 drains any pending messages and
+ * restores immediate logging. Changing the size while messages are
+ * pending drains them first.
+ *
+ * Deferred logging is disabled by default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param size The maximum number of pending log messages, or 0
+ * @return 0 on success or a negative errno on failure
+ *
+ * @see libinput_log_drain
+ * @see libinput_log_get_dropped
+ */
+int
+libinput_log_set_deferred(struct libinput *libinput, unsigned int size);
+
+/**
+ * @ingroup base
+ *
+ * Format all pending deferred log messages and pass them to the log
+ * handler. This function does nothing unless deferred logging was
+ * enabled with libinput_log_set_deferred().
+ *
+ * @param libinput A previously initialized libinput context
+ * @return The number of messages passed to the log handler
+ *
+ * @see libinput_log_set_deferred
+ */
+unsigned int
+libinput_log_drain(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Get the number of log messages discarded because the deferred log
+ * ring buffer was full. The counter is never reset.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return The number of discarded log messages
+ *
+ * @see libinput_log_set_deferred
+ */
+uint64_t
+libinput_log_get_dropped(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Export all events of this context into shared memory, for other
+ * processes to read without a libinput context of their own. Events are
+ * written as flat records into a ring buffer of the given number of
+ * records, rounded up to a power of two. The ring buffer is in a sealed
+ * memfd, see libinput_export_get_fd(). The records and the reader are
+ * described in libinput-export.h, the reader is in the separate
+ * libinput-export library.
+ *
+ * Events are exported when libinput queues them, regardless of whether
+ * the caller reads them with libinput_get_event(). The export never
+ * blocks: a reader that falls behind by more than the size of the ring
+ * buffer loses the oldest records.
+ *
+ * Devices are identified by a number. Each device's first record in an
+ * export is a @ref LIBINPUT_EVENT_DEVICE_ADDED record with its sysname
+ * and name, including for devices that were added before the export was
+ * enabled. The device is also added to a device table next to the ring
+ * buffer, so readers that missed that record can still look it up, see
+ * libinput_export_reader_get_device().
+ *
+ * Calling this function with a size of 0 disables the export. Calling it
+ * while the export is enabled replaces the export with a new one, the
+ * file descriptor and notify fds of the previous export are not used
+ * anymore.
+ *
+ * The export is disabled by default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param size The number of records in the ring buffer, at most 65536,
+ * or 0
+ * @return 0 on success or a negative errno on failure
+ *
+ * @see libinput_export_get_fd
+ * @see libinput_export_add_notify_fd
+ */
+int
+libinput_export_enable(struct libinput *libinput, unsigned int size);
+
+/**
+ * @ingroup base
+ *
+ * Get the file descriptor of the event export. The fd is owned by
+ * libinput, pass it (or a dup() of it) to the reading processes, e.g.
+ * with SCM_RIGHTS. Readers map it with libinput_export_reader_new().
+ *
+ * On Linux 5.1 and later the memfd is sealed against writes, readers
+ * cannot modify the records. On older kernels any process with the fd
+ * can map it writable, only pass it to trusted readers.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return The file descriptor or -1 if the export is not enabled
+ *
+ * @see libinput_export_enable
+ */
+int
+libinput_export_get_fd(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Add an eventfd to be signalled when new records were exported. The fd
+ * is signalled at most once per libinput_dispatch(), at the end of it. Use
+ * one eventfd per reading process, the fd should be non-blocking.
+ *
+ * The caller keeps ownership of the fd and must remove it with
+ * libinput_export_remove_notify_fd() before closing it.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param fd An eventfd
+ * @return 0 on success or a negative errno on failure
+ *
+ * @see libinput_export_remove_notify_fd
+ */
+int
+libinput_export_add_notify_fd(struct libinput *libinput, int fd);
+
+/**
+ * @ingroup base
+ *
+ * Remove an eventfd previously added with
+ * libinput_export_add_notify_fd().
+ *
+ * @param libinput A previously initialized libinput context
+ * @param fd The eventfd to remove
+ * @return 0 on success or a negative errno on failure
+ *
+ * @see libinput_export_add_notify_fd
+ */
+int
+libinput_export_remove_notify_fd(struct libinput *libinput, int fd);
+
+/**
+ * @ingroup base
+ *
+ * Runtime statistics counters, see libinput_get_stats() and
+ * libinput_device_get_stats(). All counters start at zero when the
+ * context or device is created and never decrease. Most count
+ * occurrences, @ref LIBINPUT_STAT_QUEUE_PEAK is a high-water mark instead.
+ */
+enum libinput_stat {
+	/** evdev events read from the kernel */
+	LIBINPUT_STAT_KERNEL_EVENTS = 1,
+	/** evdev frames (SYN_REPORT) processed */
+	LIBINPUT_STAT_FRAMES,
+	/** SYN_DROPPED occurrences, i.e. the kernel buffer overflowed */
+	LIBINPUT_STAT_SYN_DROPPED,
+	/** libinput events posted, of any type */
+	LIBINPUT_STAT_EVENTS_POSTED,
+	/** touches ignored by palm detection, excluding disable-while-typing.
+	 * A touch is counted once, by the first reason it was ignored. */
+	LIBINPUT_STAT_PALM_TOUCHES,
+	/** touches ignored by thumb detection */
+	LIBINPUT_STAT_THUMB_TOUCHES,
+	/** touches ignored by disable-while-typing */
+	LIBINPUT_STAT_DWT_TOUCHES,
+	/** timers armed, context only */
+	LIBINPUT_STAT_TIMERS_ARMED,
+	/** timers expired, context only */
+	LIBINPUT_STAT_TIMERS_FIRED,
+	/** the highest number of events in the event queue, context only */
+	LIBINPUT_STAT_QUEUE_PEAK,
+	/** time spent reading and processing device events in µs */
+	LIBINPUT_STAT_DISPATCH_TIME_US,
+	/** wakeups caused by timer expiry, context only. Multiple timers
+	 * may fire in one wakeup. */
+	LIBINPUT_STAT_TIMER_WAKEUPS,
+	/** updates of the context's timerfd, context only. Arming or
+	 * cancelling several timers may be a single update. */
+	LIBINPUT_STAT_TIMERFD_UPDATES,
+};
+
+/**
+ * @ingroup base
+ *
+ * Get the current value of a statistics counter for this context. The
+ * context's counters are the sum of the counters of all devices,
+ * including devices that have since been removed.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param stat The counter to return
+ * @return The counter value, or 0 for an invalid counter
+ *
+ * @see libinput_device_get_stats
+ * @see libinput_get_event_stats
+ */
+uint64_t
+libinput_get_stats(struct libinput *libinput, enum libinput_stat stat);
+
+/**
+ * @ingroup base
+ *
+ * Get the number of events of the given type posted by this context.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param type The event type
+ * @return The number of events posted, or 0 for an invalid event type
+ *
+ * @see libinput_get_stats
+ */
+uint64_t
+libinput_get_event_stats(struct libinput *libinput,
+			 enum libinput_event_type type);
+
+/**
+ * @ingroup base
+ *
+ * Enable or disable events of the given type for all devices in this
+ * context. Disabled events are never created, and where possible libinput
+ * skips the processing that produces them. For example, if none of the
+ * gesture events are enabled, touchpads do not try to detect swipe and
+ * pinch gestures and treat two fingers as scrolling. Disabled events are
+ * not exported either, see libinput_export_enable().
+ *
+ * An event is only created if it is enabled both on the context and on
+ * the device, see libinput_device_set_event_type_enabled().
+ *
+ * Disabling an event type only affects events created after this call,
+ * events already in the queue are still returned by libinput_get_event().
+ * Gestures or tablet tool interactions in progress are not ended, the
+ * caller may see e.g. a @ref LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN without
+ * the matching end event.
+ *
+ * @ref LIBINPUT_EVENT_DEVICE_ADDED and @ref LIBINPUT_EVENT_DEVICE_REMOVED
+ * cannot be disabled.
+ *
+ * All event types are enabled by default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param type The event type
+ * @param enabled Non-zero to enable the event type, zero to disable it
+ * @return 0 on success or -EINVAL for an invalid event type
+ *
+ * @see libinput_get_event_type_enabled
+ */
+int
+libinput_set_event_type_enabled(struct libinput *libinput,
+				enum libinput_event_type type,
+				int enabled);
+
+/**
+ * @ingroup base
+ *
+ * Check whether events of the given type are enabled on this context.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param type The event type
+ * @return 1 if the event type is enabled, 0 if it is disabled or invalid
+ *
+ * @see libinput_set_event_type_enabled
+ */
+int
+libinput_get_event_type_enabled(struct libinput *libinput,
+				enum libinput_event_type type);
+
+/**
+ * @ingroup device
+ *
+ * Get the current value of a statistics counter for this device.
+ * Counters marked as context only in @ref libinput_stat are always 0.
+ *
+ * @param device The device to query
+ * @param stat The counter to return
+ * @return The counter value, or 0 for an invalid counter
+ *
+ * @see libinput_get_stats
+ * @see libinput_device_get_event_stats
+ */
+uint64_t
+libinput_device_get_stats(struct libinput_device *device,
+			  enum libinput_stat stat);
+
+/**
+ * @ingroup device
+ *
+ * Get the number of events of the given type posted for this device.
+ *
+ * @param device The device to query
+ * @param type The event type
+ * @return The number of events posted, or 0 for an invalid event type
+ *
+ * @see libinput_device_get_stats
+ */
+uint64_t
+libinput_device_get_event_stats(struct libinput_device *device,
+				enum libinput_event_type type);
+
+/**
+ * @ingroup device
+ *
+ * Enable or disable events of the given type for this device. This works
+ * like libinput_set_event_type_enabled() but only affects this device. An
+ * event is only created if it is enabled both on the context and on the
+ * device.
+ *
+ * All event types are enabled by default.
+ *
+ * @param device The device to configure
+ * @param type The event type
+ * @param enabled Non-zero to enable the event type, zero to disable it
+ * @return 0 on success or -EINVAL for an invalid event type
+ *
+ * @see libinput_device_get_event_type_enabled
+ */
+int
+libinput_device_set_event_type_enabled(struct libinput_device *device,
+				       enum libinput_event_type type,
+				       int enabled);
+
+/**
+ * @ingroup device
+ *
+ * Check whether events of the given type are enabled on this device. The
+ * context's setting is not taken into account.
+ *
+ * @param device The device to query
+ * @param type The event type
+ * @return 1 if the event type is enabled, 0 if it is disabled or invalid
+ *
+ * @see libinput_device_set_event_type_enabled
+ */
+int
+libinput_device_get_event_type_enabled(struct libinput_device *device,
+				       enum libinput_event_type type);
+
 /**
  * @defgroup seat Initialization and manipulation of seats
  *
@@ -4947,6 +5570,33 @@ enum libinput_config_middle_emulation_state
 libinput_device_config_middle_emulation_get_default_enabled(
 		struct libinput_device *device);
 
+/**
+ * @ingroup config
+ *
+ * Get the current middle button emulation timeout in microseconds. This is
+ * the maximum time a left or right button press is held back while waiting
+ * for the other button to complete a middle button chord. A button press
+ * that does not become part of a chord is delayed by up to this time and
+ * no longer.
+ *
+ * The timeout adapts to the time between the two button presses of the
+ * chords performed by the user, it never exceeds the default timeout. See
+ * @ref middle_button_emulation for details.
+ *
+ * Unlike the other middle button emulation configuration functions, this
+ * function also works on devices that have middle button emulation
+ * enabled but not configurable.
+ *
+ * @param device The device to query
+ * @return The timeout in microseconds, or 0 if middle button emulation is
+ * disabled or does not delay button presses on this device
+ *
+ * @see libinput_device_config_middle_emulation_get_enabled
+ */
+uint64_t
+libinput_device_config_middle_emulation_get_timeout_usec(
+		struct libinput_device *device);
+
 /**
  * @ingroup config
  *
@@ -5324,6 +5974,120 @@ libinput_device_config_rotation_get_angle(struct libinput_device *device);
 unsigned int
 libinput_device_config_rotation_get_default_angle(struct libinput_device *device);
 
+/**
+ * @ingroup config
+ *
+ * Smoothing modes for the position and tilt of a tablet tool.
+ */
+enum libinput_config_tablet_tool_smoothing {
+	/**
+	 * Average over the last few events. This removes jitter but adds a
+	 * constant lag of a few events to the tool's motion.
+	 */
+	LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_AVERAGE = 0,
+	/**
+	 * Smooth strongly while the tool moves slowly and less the faster
+	 * it moves, so fast strokes see little lag. The amount of
+	 * smoothing is set with
+	 * libinput_tablet_tool_config_smoothing_set_strength().
+	 */
+	LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_ADAPTIVE,
+};
+
+/**
+ * @ingroup config
+ *
+ * Set the smoothing mode for the position and tilt of this tool. The mode
+ * applies to all tablets the tool is used on, it takes effect with the
+ * next event of the tool.
+ *
+ * @param tool The libinput tool
+ * @param mode The smoothing mode
+ * @return A config status code
+ *
+ * @see libinput_tablet_tool_config_smoothing_get_mode
+ * @see libinput_tablet_tool_config_smoothing_get_default_mode
+ */
+enum libinput_config_status
+libinput_tablet_tool_config_smoothing_set_mode(
+	struct libinput_tablet_tool *tool,
+	enum libinput_config_tablet_tool_smoothing mode);
+
+/**
+ * @ingroup config
+ *
+ * @param tool The libinput tool
+ * @return The current smoothing mode of this tool
+ *
+ * @see libinput_tablet_tool_config_smoothing_set_mode
+ * @see libinput_tablet_tool_config_smoothing_get_default_mode
+ */
+enum libinput_config_tablet_tool_smoothing
+libinput_tablet_tool_config_smoothing_get_mode(
+	struct libinput_tablet_tool *tool);
+
+/**
+ * @ingroup config
+ *
+ * @param tool The libinput tool
+ * @return The default smoothing mode of this tool
+ *
+ * @see libinput_tablet_tool_config_smoothing_set_mode
+ * @see libinput_tablet_tool_config_smoothing_get_mode
+ */
+enum libinput_config_tablet_tool_smoothing
+libinput_tablet_tool_config_smoothing_get_default_mode(
+	struct libinput_tablet_tool *tool);
+
+/**
+ * @ingroup config
+ *
+ * Set the strength of the @ref
+ * LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_ADAPTIVE smoothing mode, in the
+ * range [0.0, 1.0]. 0.0 disables smoothing, higher values remove more
+ * jitter while the tool moves slowly. Values close to 0.0 fade the
+ * smoothing out gradually. A new strength takes effect on the next event
+ * without dropping the filter history. The strength has no effect in the
+ * other modes.
+ *
+ * @param tool The libinput tool
+ * @param strength The smoothing strength in the range [0.0, 1.0]
+ * @return A config status code
+ *
+ * @see libinput_tablet_tool_config_smoothing_get_strength
+ * @see libinput_tablet_tool_config_smoothing_get_default_strength
+ */
+enum libinput_config_status
+libinput_tablet_tool_config_smoothing_set_strength(
+	struct libinput_tablet_tool *tool,
+	double strength);
+
+/**
+ * @ingroup config
+ *
+ * @param tool The libinput tool
+ * @return The current smoothing strength of this tool
+ *
+ * @see libinput_tablet_tool_config_smoothing_set_strength
+ * @see libinput_tablet_tool_config_smoothing_get_default_strength
+ */
+double
+libinput_tablet_tool_config_smoothing_get_strength(
+	struct libinput_tablet_tool *tool);
+
+/**
+ * @ingroup config
+ *
+ * @param tool The libinput tool
+ * @return The default smoothing strength of this tool
+ *
+ * @see libinput_tablet_tool_config_smoothing_set_strength
+ * @see libinput_tablet_tool_config_smoothing_get_strength
+ */
+double
+libinput_tablet_tool_config_smoothing_get_default_strength(
+	struct libinput_tablet_tool *tool);
+
 #ifdef __cplusplus
 }
 #endif
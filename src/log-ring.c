@@ -0,0 +1,496 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libinput-util.h"
+#include "log-ring.h"
+
+#define LOG_RING_MAX_ARGS 12
+#define LOG_RING_DATA_SIZE 192
+#define LOG_RING_MESSAGE_SIZE 1024
+#define LOG_RING_SPEC_SIZE 24
+
+#define LOG_RING_NULL_STRING ((size_t)-1)
+
+enum log_arg_type {
+	LOG_ARG_INVALID,
+	LOG_ARG_INT,
+	LOG_ARG_LONG,
+	LOG_ARG_LLONG,
+	LOG_ARG_SIZE,
+	LOG_ARG_INTMAX,
+	LOG_ARG_PTRDIFF,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_STRING,
+	LOG_ARG_POINTER,
+};
+
+union log_arg {
+	int i;
+	long l;
+	long long ll;
+	size_t z;
+	intmax_t j;
+	ptrdiff_t t;
+	double d;
+	const void *p;
+	size_t str; /* offset into the entry's data */
+};
+
+struct log_ring_entry {
+	enum libinput_log_priority priority;
+	const char *format; /* NULL if data is the formatted message */
+	unsigned int nargs;
+	union log_arg args[LOG_RING_MAX_ARGS];
+	char data[LOG_RING_DATA_SIZE];
+};
+
+struct log_ring {
+	struct log_ring_entry *entries;
+	unsigned int mask;
+
+	/* head is only written by the producer, tail only by the
+	 * consumer. Both only ever increase */
+	uint64_t head;
+	uint64_t tail;
+	uint64_t dropped;
+};
+
+struct log_conversion {
+	const char *start;	/* the '%' */
+	size_t len;		/* including the conversion character */
+	unsigned int nstars;	/* '*' width and precision arguments */
+	enum log_arg_type type;
+};
+
+static enum log_arg_type
+log_conversion_type(char conversion, const char *length)
+{
+	switch (conversion) {
+	case 'd':
+	case 'i':
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		if (strneq(length, "hh", 2) || length[0] == 'h')
+			return LOG_ARG_INT; /* promoted */
+		if (strneq(length, "ll", 2))
+			return LOG_ARG_LLONG;
+		switch (length[0]) {
+		case 'l': return LOG_ARG_LONG;
+		case 'z': return LOG_ARG_SIZE;
+		case 'j': return LOG_ARG_INTMAX;
+		case 't': return LOG_ARG_PTRDIFF;
+		case 'L': return LOG_ARG_INVALID;
+		}
+		return LOG_ARG_INT;
+	case 'c':
+		return length[0] == '\0' ? LOG_ARG_INT : LOG_ARG_INVALID;
+	case 'e':
+	case 'E':
+	case 'f':
+	case 'F':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		/* %Lf would need a long double */
+		return length[0] == 'L' ? LOG_ARG_INVALID : LOG_ARG_DOUBLE;
+	case 's':
+		return length[0] == '\0' ? LOG_ARG_STRING : LOG_ARG_INVALID;
+	case 'p':
+		return LOG_ARG_POINTER;
+	default:
+		/* %n, %m, wide characters, etc. */
+		return LOG_ARG_INVALID;
+	}
+}
+
+/* Finds the next conversion in format, skipping over "%%". Returns false
+ * if there is none */
+static bool
+log_format_next(const char *format, struct log_conversion *conv)
+{
+	const char *p = format;
+	const char *length;
+	char lenbuf[3] = { 0 };
+	size_t lenlen;
+
+	while ((p = strchr(p, '%')) && p[1] == '%')
+		p += 2;
+
+	if (!p)
+		return false;
+
+	conv->start = p++;
+	conv->nstars = 0;
+
+	p += strspn(p, "-+ #0'");
+	if (*p == '*') {
+		conv->nstars++;
+		p++;
+	} else {
+		p += strspn(p, "0123456789");
+	}
+
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			conv->nstars++;
+			p++;
+		} else {
+			p += strspn(p, "0123456789");
+		}
+	}
+
+	length = p;
+	lenlen = strspn(p, "hlLzjt");
+	if (lenlen < sizeof(lenbuf))
+		memcpy(lenbuf, length, lenlen);
+	else
+		lenbuf[0] = 'L'; /* garbage, force invalid */
+	p += lenlen;
+
+	if (*p == '\0') {
+		conv->type = LOG_ARG_INVALID;
+		conv->len = p - conv->start;
+		return true;
+	}
+
+	conv->type = log_conversion_type(*p, lenbuf);
+	conv->len = p + 1 - conv->start;
+
+	if (conv->len >= LOG_RING_SPEC_SIZE)
+		conv->type = LOG_ARG_INVALID;
+
+	return true;
+}
+
+/* Copies the arguments into the entry, returns false if the format
+ * can't be deferred */
+static bool
+log_ring_capture(struct log_ring_entry *entry,
+		 const char *format,
+		 va_list args)
+{
+	struct log_conversion conv;
+	unsigned int nargs = 0;
+	size_t used = 0;
+	unsigned int i;
+
+	while (log_format_next(format, &conv)) {
+		union log_arg *arg;
+
+		if (conv.type == LOG_ARG_INVALID ||
+		    nargs + conv.nstars + 1 > LOG_RING_MAX_ARGS)
+			return false;
+
+		for (i = 0; i < conv.nstars; i++)
+			entry->args[nargs++].i = va_arg(args, int);
+
+		arg = &entry->args[nargs++];
+
+		switch (conv.type) {
+		case LOG_ARG_INT:
+			arg->i = va_arg(args, int);
+			break;
+		case LOG_ARG_LONG:
+			arg->l = va_arg(args, long);
+			break;
+		case LOG_ARG_LLONG:
+			arg->ll = va_arg(args, long long);
+			break;
+		case LOG_ARG_SIZE:
+			arg->z = va_arg(args, size_t);
+			break;
+		case LOG_ARG_INTMAX:
+			arg->j = va_arg(args, intmax_t);
+			break;
+		case LOG_ARG_PTRDIFF:
+			arg->t = va_arg(args, ptrdiff_t);
+			break;
+		case LOG_ARG_DOUBLE:
+			arg->d = va_arg(args, double);
+			break;
+		case LOG_ARG_POINTER:
+			arg->p = va_arg(args, void *);
+			break;
+		case LOG_ARG_STRING: {
+			const char *str = va_arg(args, const char *);
+			size_t len;
+
+			if (!str) {
+				arg->str = LOG_RING_NULL_STRING;
+				break;
+			}
+
+			len = strlen(str) + 1;
+			if (used + len > sizeof(entry->data))
+				return false;
+
+			memcpy(&entry->data[used], str, len);
+			arg->str = used;
+			used += len;
+			break;
+		}
+		case LOG_ARG_INVALID:
+			return false;
+		}
+
+		format = conv.start + conv.len;
+	}
+
+	entry->nargs = nargs;
+
+	return true;
+}
+
+/* Appends literal text to buf, collapsing "%%". Returns the new length */
+static size_t
+log_append_literal(char *buf, size_t size, size_t len,
+		   const char *text, size_t textlen)
+{
+	size_t i;
+
+	for (i = 0; i < textlen && len < size - 1; i++) {
+		buf[len++] = text[i];
+		if (text[i] == '%' && i + 1 < textlen && text[i + 1] == '%')
+			i++;
+	}
+	buf[len] = '\0';
+
+	return len;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+
+#define log_snprintf(buf_, size_, spec_, stars_, nstars_, value_)	\
+	((nstars_) == 0 ?						\
+		snprintf((buf_), (size_), (spec_), (value_)) :		\
+	 (nstars_) == 1 ?						\
+		snprintf((buf_), (size_), (spec_), (stars_)[0], (value_)) : \
+		snprintf((buf_), (size_), (spec_),			\
+			 (stars_)[0], (stars_)[1], (value_)))
+
+static void
+log_ring_format(const struct log_ring_entry *entry, char *buf, size_t size)
+{
+	const char *format = entry->format;
+	struct log_conversion conv;
+	unsigned int nargs = 0;
+	size_t len = 0;
+
+	buf[0] = '\0';
+
+	while (log_format_next(format, &conv)) {
+		char spec[LOG_RING_SPEC_SIZE];
+		const union log_arg *arg;
+		int stars[2] = { 0, 0 };
+		unsigned int i;
+		int rc = 0;
+
+		len = log_append_literal(buf, size, len,
+					 format, conv.start - format);
+
+		memcpy(spec, conv.start, conv.len);
+		spec[conv.len] = '\0';
+
+		for (i = 0; i < conv.nstars; i++)
+			stars[i] = entry->args[nargs++].i;
+
+		arg = &entry->args[nargs++];
+
+		switch (conv.type) {
+		case LOG_ARG_INT:
+			rc = log_snprintf(&buf[len], size - len,
+					  spec, stars, conv.nstars, arg->i);
+			break;
+		case LOG_ARG_LONG:
+			rc = log_snprintf(&buf[len], size - len,
+					  spec, stars, conv.nstars, arg->l);
+			break;
+		case LOG_ARG_LLONG:
+			rc = log_snprintf(&buf[len], size - len,
+					  spec, stars, conv.nstars, arg->ll);
+			break;
+		case LOG_ARG_SIZE:
+			rc = log_snprintf(&buf[len], size - len,
+					  spec, stars, conv.nstars, arg->z);
+			break;
+		case LOG_ARG_INTMAX:
+			rc = log_snprintf(&buf[len], size - len,
+					  spec, stars, conv.nstars, arg->j);
+			break;
+		case LOG_ARG_PTRDIFF:
+			rc = log_snprintf(&buf[len], size - len,
+					  spec, stars, conv.nstars, arg->t);
+			break;
+		case LOG_ARG_DOUBLE:
+			rc = log_snprintf(&buf[len], size - len,
+					  spec, stars, conv.nstars, arg->d);
+			break;
+		case LOG_ARG_POINTER:
+			rc = log_snprintf(&buf[len], size - len,
+					  spec, stars, conv.nstars, arg->p);
+			break;
+		case LOG_ARG_STRING: {
+			const char *str = NULL;
+
+			if (arg->str != LOG_RING_NULL_STRING)
+				str = &entry->data[arg->str];
+			rc = log_snprintf(&buf[len], size - len,
+					  spec, stars, conv.nstars, str);
+			break;
+		}
+		case LOG_ARG_INVALID:
+			/* can't happen, those are formatted on push */
+			break;
+		}
+
+		if (rc > 0)
+			len = min(len + (size_t)rc, size - 1);
+
+		format = conv.start + conv.len;
+	}
+
+	log_append_literal(buf, size, len, format, strlen(format));
+}
+
+#pragma GCC diagnostic pop
+
+struct log_ring *
+log_ring_create(unsigned int size)
+{
+	struct log_ring *ring;
+	unsigned int n = 1;
+
+	if (size == 0)
+		return NULL;
+
+	while (n < size)
+		n <<= 1;
+
+	ring = zalloc(sizeof(*ring));
+	if (!ring)
+		return NULL;
+
+	ring->entries = zalloc(n * sizeof(*ring->entries));
+	if (!ring->entries) {
+		free(ring);
+		return NULL;
+	}
+
+	ring->mask = n - 1;
+
+	return ring;
+}
+
+void
+log_ring_destroy(struct log_ring *ring)
+{
+	if (!ring)
+		return;
+
+	free(ring->entries);
+	free(ring);
+}
+
+bool
+log_ring_push(struct log_ring *ring,
+	      enum libinput_log_priority priority,
+	      const char *format,
+	      va_list args)
+{
+	struct log_ring_entry *entry;
+	uint64_t head, tail;
+	va_list copy;
+
+	head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	if (head - tail > ring->mask) {
+		__atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+		return false;
+	}
+
+	entry = &ring->entries[head & ring->mask];
+	entry->priority = priority;
+	entry->format = format;
+
+	/* Anything we can't defer is formatted now, truncated to the
+	 * entry size if need be */
+	va_copy(copy, args);
+	if (!log_ring_capture(entry, format, copy)) {
+		entry->format = NULL;
+		entry->nargs = 0;
+		vsnprintf(entry->data, sizeof(entry->data), format, args);
+	}
+	va_end(copy);
+
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+unsigned int
+log_ring_drain(struct log_ring *ring, log_ring_drain_func func, void *data)
+{
+	char message[LOG_RING_MESSAGE_SIZE];
+	uint64_t head, tail;
+	unsigned int count = 0;
+
+	tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+	head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	while (tail != head) {
+		const struct log_ring_entry *entry;
+
+		entry = &ring->entries[tail & ring->mask];
+		if (entry->format)
+			log_ring_format(entry, message, sizeof(message));
+
+		func(entry->priority,
+		     entry->format ? message : entry->data,
+		     data);
+
+		tail++;
+		count++;
+		__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+	}
+
+	return count;
+}
+
+uint64_t
+log_ring_get_dropped(struct log_ring *ring)
+{
+	return __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+}
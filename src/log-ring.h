@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libinput.h"
+
+/* A single-producer, single-consumer ring of log messages. The producer
+ * only stores the format string pointer and the raw arguments, the
+ * message is formatted when the consumer drains the ring.
+ *
+ * The format string must outlive the ring, i.e. it must be a string
+ * literal. String arguments are copied. */
+struct log_ring;
+
+typedef void (*log_ring_drain_func)(enum libinput_log_priority priority,
+				    const char *message,
+				    void *data);
+
+struct log_ring *
+log_ring_create(unsigned int size);
+
+void
+log_ring_destroy(struct log_ring *ring);
+
+/* Returns false if the ring was full and the message was dropped */
+bool
+log_ring_push(struct log_ring *ring,
+	      enum libinput_log_priority priority,
+	      const char *format,
+	      va_list args);
+
+/* Formats all pending messages and passes them to func, returns the
+ * number of messages drained */
+unsigned int
+log_ring_drain(struct log_ring *ring, log_ring_drain_func func, void *data);
+
+uint64_t
+log_ring_get_dropped(struct log_ring *ring);
+
+#endif
@@ -32,6 +32,7 @@
 
 #include "libinput-private.h"
 #include "timer.h"
+#include "trace.h"
 
 void
 libinput_timer_init(struct libinput_timer *timer, struct libinput *libinput,
@@ -41,6 +42,13 @@ libinput_timer_init(struct libinput_timer *timer, struct libinput *libinput,
 	timer->libinput = libinput;
 	timer->timer_func = timer_func;
 	timer->timer_func_data = timer_func_data;
+	timer->slack = 0;
+}
+
+void
+libinput_timer_set_slack(struct libinput_timer *timer, uint64_t slack)
+{
+	timer->slack = slack;
 }
 
 static void
@@ -49,18 +57,22 @@ libinput_timer_arm_timer_fd(struct libinput *libinput)
 	int r;
 	struct libinput_timer *timer;
 	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
-	uint64_t earliest_expire = UINT64_MAX;
+	uint64_t deadline = UINT64_MAX;
 
+	/* Wake up at the latest time that is still within every timer's
+	 * slack, all timers expired by then fire in the same wakeup */
 	list_for_each(timer, &libinput->timer.list, link) {
-		if (timer->expire < earliest_expire)
-			earliest_expire = timer->expire;
+		if (timer->expire + timer->slack < deadline)
+			deadline = timer->expire + timer->slack;
 	}
 
-	if (earliest_expire != UINT64_MAX) {
-		its.it_value.tv_sec = earliest_expire / ms2us(1000);
-		its.it_value.tv_nsec = (earliest_expire % ms2us(1000)) * 1000;
+	if (deadline != UINT64_MAX) {
+		its.it_value.tv_sec = deadline / ms2us(1000);
+		its.it_value.tv_nsec = (deadline % ms2us(1000)) * 1000;
 	}
 
+	libinput_stats_add(libinput, LIBINPUT_STAT_TIMERFD_UPDATES, 1);
+
 	r = timerfd_settime(libinput->timer.fd, TFD_TIMER_ABSTIME, &its, NULL);
 	if (r)
 		log_error(libinput, "timer: timerfd_settime error: %s\n", strerror(errno));
@@ -88,10 +100,13 @@ libinput_timer_set_flags(struct libinput_timer *timer,
 
 	assert(expire);
 
+	libinput_stats_add(timer->libinput, LIBINPUT_STAT_TIMERS_ARMED, 1);
+
 	if (!timer->expire)
 		list_insert(&timer->libinput->timer.list, &timer->link);
 
 	timer->expire = expire;
+	timer->extended = 0;
 	libinput_timer_arm_timer_fd(timer->libinput);
 }
 
@@ -101,6 +116,18 @@ libinput_timer_set(struct libinput_timer *timer, uint64_t expire)
 	libinput_timer_set_flags(timer, expire, TIMER_FLAG_NONE);
 }
 
+void
+libinput_timer_extend(struct libinput_timer *timer, uint64_t expire)
+{
+	if (!timer->expire || expire < timer->expire) {
+		libinput_timer_set(timer, expire);
+		return;
+	}
+
+	libinput_stats_add(timer->libinput, LIBINPUT_STAT_TIMERS_ARMED, 1);
+	timer->extended = expire > timer->expire ? expire : 0;
+}
+
 void
 libinput_timer_cancel(struct libinput_timer *timer)
 {
@@ -108,6 +135,7 @@ libinput_timer_cancel(struct libinput_timer *timer)
 		return;
 
 	timer->expire = 0;
+	timer->extended = 0;
 	list_remove(&timer->link);
 	libinput_timer_arm_timer_fd(timer->libinput);
 }
@@ -116,8 +144,6 @@ static void
 libinput_timer_handler(void *data)
 {
 	struct libinput *libinput = data;
-	struct libinput_timer *timer, *tmp;
-	uint64_t now;
 	uint64_t discard;
 	int r;
 
@@ -128,18 +154,51 @@ libinput_timer_handler(void *data)
 				 errno,
 				 strerror(errno));
 
+	libinput_stats_add(libinput, LIBINPUT_STAT_TIMER_WAKEUPS, 1);
+
+	libinput_timer_flush(libinput);
+}
+
+void
+libinput_timer_flush(struct libinput *libinput)
+{
+	struct libinput_timer *timer, *tmp;
+	uint64_t now;
+	bool rearm = false;
+
+	if (list_empty(&libinput->timer.list))
+		return;
+
 	now = libinput_now(libinput);
 	if (now == 0)
 		return;
 
 	list_for_each_safe(timer, tmp, &libinput->timer.list, link) {
-		if (timer->expire <= now) {
+		if (timer->expire <= now && timer->extended > now) {
+			/* Extended since it was armed, wait for the real
+			   expire time */
+			timer->expire = timer->extended;
+			timer->extended = 0;
+			rearm = true;
+		} else if (timer->expire <= now) {
+			uint64_t expire = timer->expire;
+
 			/* Clear the timer before calling timer_func,
 			   as timer_func may re-arm it */
 			libinput_timer_cancel(timer);
+			libinput_stats_add(libinput,
+					   LIBINPUT_STAT_TIMERS_FIRED,
+					   1);
+			trace_probe3(timer_fire,
+				     timer->timer_func,
+				     expire,
+				     now);
 			timer->timer_func(now, timer->timer_func_data);
 		}
 	}
+
+	if (rearm)
+		libinput_timer_arm_timer_fd(libinput);
 }
 
 int
@@ -30,10 +30,19 @@
 
 struct libinput;
 
+/* Slack for timers where a few ms of delay are not noticeable. Timers
+ * that hold back a click or a button state the user waits for have no
+ * slack: a lone timer always fires at expire + slack. */
+#define TIMER_SLACK_DEFAULT ms2us(5)
+/* Slack for timeouts of several hundred ms, e.g. disable-while-typing */
+#define TIMER_SLACK_LONG ms2us(20)
+
 struct libinput_timer {
 	struct libinput *libinput;
 	struct list link;
 	uint64_t expire; /* in absolute us CLOCK_MONOTONIC */
+	uint64_t extended; /* real expire time if later than expire, or 0 */
+	uint64_t slack; /* in us, how much later than expire it may fire */
 	void (*timer_func)(uint64_t now, void *timer_func_data);
 	void *timer_func_data;
 };
@@ -43,10 +52,27 @@ libinput_timer_init(struct libinput_timer *timer, struct libinput *libinput,
 		    void (*timer_func)(uint64_t now, void *timer_func_data),
 		    void *timer_func_data);
 
+/* Allow the timer to fire up to slack us after its expire time, so it
+ * can share a wakeup with other timers. Timers without slack fire
+ * exactly. */
+void
+libinput_timer_set_slack(struct libinput_timer *timer, uint64_t slack);
+
 /* Set timer expire time, in absolute us CLOCK_MONOTONIC */
 void
 libinput_timer_set(struct libinput_timer *timer, uint64_t expire);
 
+/* Move the expire time of an armed timer to a later time. Unlike
+ * libinput_timer_set(), this only stores the new expire time. The timer
+ * still wakes us up at the previous expire time and is then silently
+ * re-armed for the new one, so timers that are pushed forward on every
+ * event cost one wakeup per timeout instead of one syscall per event.
+ *
+ * If the timer is not armed or expire is earlier than the current expire
+ * time, this is the same as libinput_timer_set(). */
+void
+libinput_timer_extend(struct libinput_timer *timer, uint64_t expire);
+
 enum timer_flags {
 	TIMER_FLAG_NONE = 0,
 	TIMER_FLAG_ALLOW_NEGATIVE = (1 << 0),
@@ -60,6 +86,10 @@ libinput_timer_set_flags(struct libinput_timer *timer,
 void
 libinput_timer_cancel(struct libinput_timer *timer);
 
+/* Fire all timers that have expired, regardless of their slack */
+void
+libinput_timer_flush(struct libinput *libinput);
+
 int
 libinput_timer_subsys_init(struct libinput *libinput);
 
@@ -0,0 +1,58 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/* Static tracepoints for perf, bpftrace, systemtap, etc. All probes are
+ * in the "libinput" provider, e.g. usdt:libinput.so:libinput:frame.
+ *
+ * Probes are only compiled in when configured with tracepoints enabled,
+ * otherwise the macros expand to nothing and the arguments are not
+ * evaluated. When compiled in, an unattached probe is a single nop but
+ * the arguments are still evaluated, so keep them to cheap expressions.
+ * The event_post and event_get probes read the clock for this, so queue
+ * latency can be taken from the probes alone.
+ */
+
+#if HAVE_TRACEPOINTS
+#include <sys/sdt.h>
+
+#define trace_probe2(name_, a1_, a2_) \
+	DTRACE_PROBE2(libinput, name_, a1_, a2_)
+#define trace_probe3(name_, a1_, a2_, a3_) \
+	DTRACE_PROBE3(libinput, name_, a1_, a2_, a3_)
+#define trace_probe4(name_, a1_, a2_, a3_, a4_) \
+	DTRACE_PROBE4(libinput, name_, a1_, a2_, a3_, a4_)
+#else
+/* sizeof() marks the arguments as used without evaluating them */
+#define trace_probe2(name_, a1_, a2_) \
+	do { (void)sizeof(a1_); (void)sizeof(a2_); } while (0)
+#define trace_probe3(name_, a1_, a2_, a3_) \
+	do { (void)sizeof(a1_); (void)sizeof(a2_); (void)sizeof(a3_); } while (0)
+#define trace_probe4(name_, a1_, a2_, a3_, a4_) \
+	do { (void)sizeof(a1_); (void)sizeof(a2_); (void)sizeof(a3_); \
+	     (void)sizeof(a4_); } while (0)
+#endif
+
+#endif
@@ -30,6 +30,7 @@
 #include <fcntl.h>
 #include <fnmatch.h>
 #include <getopt.h>
+#include <limits.h>
 #include <poll.h>
 #include <signal.h>
 #include <stdint.h>
@@ -958,23 +959,263 @@ litest_free_test_list(struct list *tests)
 }
 
 static int
-litest_run_suite(char *argv0, struct list *tests, int which, int max)
+litest_run_suite(struct list *tests)
 {
 	int failed = 0;
 	SRunner *sr = NULL;
 	struct suite *s;
-	int argvlen = strlen(argv0);
-	int count = -1;
 
-	if (max > 1)
-		snprintf(argv0, argvlen, "libinput-test-%-50d", which);
+	list_for_each(s, tests, node) {
+		if (!sr)
+			sr = srunner_create(s->suite);
+		else
+			srunner_add_suite(sr, s->suite);
+
+		s->used = true;
+	}
+
+	if (!sr)
+		return 0;
+
+	srunner_run_all(sr, CK_ENV);
+	failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+	return failed;
+}
+
+/* A job is one test case for one device (or "no device") in one suite.
+ * Jobs are handed out to the forked workers through a pipe, longest
+ * jobs first, so a worker that finishes early picks up the next job
+ * instead of idling while another worker is stuck with a long suite. The
+ * expected duration of each job is taken from the previous run, see
+ * litest_load_durations().
+ */
+struct job {
+	struct suite *suite;
+	struct test *test;
+	struct duration *history;
+};
+
+struct job_result {
+	uint32_t job;
+	uint32_t duration_ms;
+	uint32_t checks;
+	uint32_t failures;
+	uint32_t errors;
+};
+
+/* Jobs run silently, each worker prints only the failures of its jobs
+ * and the parent prints a single summary over all jobs, in the same
+ * format check uses. */
+static void
+litest_print_job_failures(SRunner *sr,
+			  int first,
+			  int last,
+			  struct job_result *result)
+{
+	TestResult **failures;
+	int i;
+
+	failures = srunner_failures(sr);
+	if (!failures)
+		return;
+
+	for (i = first; i < last; i++) {
+		TestResult *tr = failures[i];
+		char type;
+
+		if (tr_rtype(tr) == CK_ERROR) {
+			result->errors++;
+			type = 'E';
+		} else {
+			result->failures++;
+			type = 'F';
+		}
+
+		fprintf(stderr,
+			"%s:%d:%c:%s: %s\n",
+			tr_lfile(tr),
+			tr_lno(tr),
+			type,
+			tr_tcname(tr),
+			tr_msg(tr));
+	}
+
+	free(failures);
+}
+
+/* Duration history, one line per job: "<ms> <suite>/<test>" */
+struct duration {
+	struct list node;
+	char *name;
+	unsigned int ms;
+};
+
+static const char *
+litest_durations_path(void)
+{
+	const char *path = getenv("LITEST_DURATIONS");
+
+	if (!path)
+		return ".litest-durations";
+	if (*path == '\0')
+		return NULL;
+
+	return path;
+}
+
+static void
+litest_load_durations(const char *path, struct list *durations)
+{
+	FILE *fp;
+	char name[512];
+	unsigned int ms;
+
+	if (!path)
+		return;
+
+	fp = fopen(path, "r");
+	if (!fp)
+		return;
+
+	while (fscanf(fp, "%u %511[^\n]\n", &ms, name) == 2) {
+		struct duration *d;
+
+		d = zalloc(sizeof(*d));
+		litest_assert(d != NULL);
+		d->name = strdup(name);
+		d->ms = ms;
+		list_insert(durations, &d->node);
+	}
+
+	fclose(fp);
+}
+
+static void
+litest_save_durations(const char *path, struct list *durations)
+{
+	FILE *fp;
+	struct duration *d;
+	char tmppath[PATH_MAX];
+
+	if (!path)
+		return;
+
+	snprintf(tmppath, sizeof(tmppath), "%s.tmp", path);
+	fp = fopen(tmppath, "w");
+	if (!fp)
+		return;
+
+	list_for_each(d, durations, node)
+		fprintf(fp, "%u %s\n", d->ms, d->name);
+
+	if (fclose(fp) == 0)
+		rename(tmppath, path);
+	else
+		unlink(tmppath);
+}
+
+static void
+litest_free_durations(struct list *durations)
+{
+	struct duration *d, *tmp;
+
+	list_for_each_safe(d, tmp, durations, node) {
+		list_remove(&d->node);
+		free(d->name);
+		free(d);
+	}
+}
+
+static int
+litest_job_cmp(const void *a, const void *b)
+{
+	const struct job *ja = a,
+			 *jb = b;
+
+	/* longest first, jobs without history have UINT_MAX */
+	if (ja->history->ms == jb->history->ms)
+		return 0;
+
+	return ja->history->ms > jb->history->ms ? -1 : 1;
+}
+
+static struct job *
+litest_create_jobs(struct list *tests,
+		   struct list *durations,
+		   size_t *njobs_out)
+{
+	struct suite *s;
+	struct test *t;
+	struct job *jobs;
+	size_t njobs = 0;
 
 	list_for_each(s, tests, node) {
-		++count;
-		if (max != 1 && (count % max) != which) {
-			continue;
+		list_for_each(t, &s->tests, node)
+			njobs++;
+	}
+
+	/* +1 so we never zalloc(0) if all suites were filtered empty */
+	jobs = zalloc((njobs + 1) * sizeof(*jobs));
+	litest_assert(jobs != NULL);
+
+	njobs = 0;
+	list_for_each(s, tests, node) {
+		list_for_each(t, &s->tests, node) {
+			struct job *job = &jobs[njobs++];
+			struct duration *d;
+			char name[512];
+
+			job->suite = s;
+			job->test = t;
+
+			snprintf(name, sizeof(name), "%s/%s", s->name, t->name);
+			list_for_each(d, durations, node) {
+				if (streq(d->name, name)) {
+					job->history = d;
+					break;
+				}
+			}
+
+			/* No history, we don't know how long it takes, so
+			 * schedule it early */
+			if (!job->history) {
+				d = zalloc(sizeof(*d));
+				litest_assert(d != NULL);
+				d->name = strdup(name);
+				d->ms = UINT_MAX;
+				list_insert(durations, &d->node);
+				job->history = d;
+			}
 		}
+	}
+
+	qsort(jobs, njobs, sizeof(*jobs), litest_job_cmp);
+
+	*njobs_out = njobs;
+	return jobs;
+}
+
+static int
+litest_run_jobs(char *argv0,
+		int worker,
+		struct list *tests,
+		const struct job *jobs,
+		int jobfd,
+		int resultfd)
+{
+	int failed = 0;
+	SRunner *sr = NULL;
+	struct suite *s;
+	int argvlen = strlen(argv0);
+	uint32_t idx;
+	int nrun = 0;
 
+	snprintf(argv0, argvlen, "libinput-test-%-50d", worker);
+
+	/* All suites are added to the runner so they get freed with it,
+	 * each job then selects its suite and test case by name */
+	list_for_each(s, tests, node) {
 		if (!sr)
 			sr = srunner_create(s->suite);
 		else
@@ -986,12 +1227,72 @@ litest_run_suite(char *argv0, struct list *tests, int which, int max)
 	if (!sr)
 		return 0;
 
-	srunner_run_all(sr, CK_ENV);
-	failed = srunner_ntests_failed(sr);
+	while (read(jobfd, &idx, sizeof(idx)) == sizeof(idx)) {
+		const struct job *job = &jobs[idx];
+		struct job_result result = { .job = idx };
+		struct timespec start, end;
+		uint64_t ms;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		srunner_run(sr, job->suite->name, job->test->name, CK_SILENT);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		ms = (end.tv_sec - start.tv_sec) * 1000 +
+		     (end.tv_nsec - start.tv_nsec) / 1000000;
+		result.duration_ms = min(ms, (uint64_t)UINT_MAX - 1);
+
+		/* check accumulates the results over all srunner_run()
+		 * calls, the difference is this job's share */
+		result.checks = srunner_ntests_run(sr) - nrun;
+		nrun = srunner_ntests_run(sr);
+		litest_print_job_failures(sr,
+					  failed,
+					  srunner_ntests_failed(sr),
+					  &result);
+		failed = srunner_ntests_failed(sr);
+
+		if (write(resultfd, &result, sizeof(result)) != sizeof(result))
+			break;
+	}
+
 	srunner_free(sr);
 	return failed;
 }
 
+static void
+litest_read_job_results(int fd,
+			const struct job *jobs,
+			size_t njobs,
+			struct job_result *total,
+			bool *eof)
+{
+	struct job_result results[64];
+	ssize_t len;
+	size_t i;
+
+	len = read(fd, results, sizeof(results));
+	if (len == 0) {
+		*eof = true;
+		return;
+	}
+	if (len < 0)
+		return;
+
+	/* results are written atomically and are smaller than PIPE_BUF, so
+	 * we never get a partial result */
+	for (i = 0; i < len/sizeof(results[0]); i++) {
+		const struct job_result *r = &results[i];
+
+		if (r->job >= njobs)
+			continue;
+
+		jobs[r->job].history->ms = r->duration_ms;
+		total->checks += r->checks;
+		total->failures += r->failures;
+		total->errors += r->errors;
+	}
+}
+
 static int
 litest_fork_subtests(char *argv0, struct list *tests, int max_forks)
 {
@@ -999,11 +1300,33 @@ litest_fork_subtests(char *argv0, struct list *tests, int max_forks)
 	int status;
 	pid_t pid;
 	int f;
+	int jobpipe[2], resultpipe[2];
+	struct job *jobs;
+	size_t njobs, next_job = 0;
+	struct list durations;
+	const char *durations_path = litest_durations_path();
+	struct job_result total = {0};
+	unsigned int percent = 0;
+	bool eof = false;
+
+	list_init(&durations);
+	litest_load_durations(durations_path, &durations);
+	jobs = litest_create_jobs(tests, &durations, &njobs);
+
+	litest_assert_int_eq(pipe2(jobpipe, O_CLOEXEC), 0);
+	litest_assert_int_eq(pipe2(resultpipe, O_CLOEXEC), 0);
 
 	for (f = 0; f < max_forks; f++) {
 		pid = fork();
 		if (pid == 0) {
-			failed = litest_run_suite(argv0, tests, f, max_forks);
+			close(jobpipe[1]);
+			close(resultpipe[0]);
+			failed = litest_run_jobs(argv0,
+						 f,
+						 tests,
+						 jobs,
+						 jobpipe[0],
+						 resultpipe[1]);
 			litest_free_test_list(&all_tests);
 			exit(failed);
 			/* child always exits here */
@@ -1011,11 +1334,81 @@ litest_fork_subtests(char *argv0, struct list *tests, int max_forks)
 	}
 
 	/* parent process only */
+	close(jobpipe[0]);
+	close(resultpipe[1]);
+
+	/* If all workers die, writing to the job pipe must not kill us */
+	signal(SIGPIPE, SIG_IGN);
+	fcntl(jobpipe[1], F_SETFL, O_NONBLOCK);
+
+	/* Keep the job pipe filled and collect the durations. Results must
+	 * be read while jobs are still pending, otherwise a full result
+	 * pipe blocks the workers while we're blocked on the job pipe. */
+	while (!eof) {
+		struct pollfd fds[2] = {
+			{ .fd = resultpipe[0], .events = POLLIN },
+			{ .fd = jobpipe[1], .events = POLLOUT },
+		};
+		int nfds = jobpipe[1] != -1 ? 2 : 1;
+
+		if (poll(fds, nfds, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		if (fds[0].revents)
+			litest_read_job_results(resultpipe[0],
+						jobs,
+						njobs,
+						&total,
+						&eof);
+
+		if (nfds < 2 || fds[1].revents == 0)
+			continue;
+
+		while (next_job < njobs) {
+			uint32_t idx = next_job;
+			ssize_t len;
+
+			len = write(jobpipe[1], &idx, sizeof(idx));
+			if (len != sizeof(idx)) {
+				/* all workers are gone */
+				if (errno == EPIPE)
+					next_job = njobs;
+				break;
+			}
+			next_job++;
+		}
+
+		if (next_job == njobs) {
+			close(jobpipe[1]);
+			jobpipe[1] = -1;
+		}
+	}
+
+	if (jobpipe[1] != -1)
+		close(jobpipe[1]);
+	close(resultpipe[0]);
+
 	while (wait(&status) != -1 && errno != ECHILD) {
 		if (WEXITSTATUS(status) != 0)
 			failed = 1;
 	}
 
+	if (total.checks > 0)
+		percent = (total.checks - total.failures - total.errors) *
+			  100/total.checks;
+	printf("%u%%: Checks: %u, Failures: %u, Errors: %u\n",
+	       percent,
+	       total.checks,
+	       total.failures,
+	       total.errors);
+
+	litest_save_durations(durations_path, &durations);
+	litest_free_durations(&durations);
+	free(jobs);
+
 	return failed;
 }
 
@@ -1040,7 +1433,7 @@ litest_run(int argc, char **argv)
 	litest_setup_sighandler(SIGINT);
 
 	if (jobs == 1)
-		failed = litest_run_suite(argv[0], &all_tests, 1, 1);
+		failed = litest_run_suite(&all_tests);
 	else
 		failed = litest_fork_subtests(argv[0], &all_tests, jobs);
 
@@ -3628,6 +4021,8 @@ main(int argc, char **argv)
 	litest_setup_tests_device();
 	litest_setup_tests_gestures();
 	litest_setup_tests_lid();
+	litest_setup_tests_filter();
+	litest_setup_tests_export();
 
 	if (mode == LITEST_MODE_LIST) {
 		litest_list_tests(&all_tests);
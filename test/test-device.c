@@ -28,6 +28,7 @@
 #include <fcntl.h>
 #include <libinput.h>
 #include <libudev.h>
+#include <poll.h>
 #include <unistd.h>
 
 #include "litest.h"
@@ -1595,6 +1596,271 @@ START_TEST(device_seat_phys_name)
 }
 END_TEST
 
+START_TEST(device_stats)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_device *device = dev->libinput_device;
+	uint64_t events, frames, motion, posted;
+
+	litest_drain_events(li);
+
+	events = libinput_device_get_stats(device,
+					   LIBINPUT_STAT_KERNEL_EVENTS);
+	frames = libinput_device_get_stats(device, LIBINPUT_STAT_FRAMES);
+	motion = libinput_device_get_event_stats(device,
+						 LIBINPUT_EVENT_POINTER_MOTION);
+	posted = libinput_get_stats(li, LIBINPUT_STAT_EVENTS_POSTED);
+
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_REL, REL_Y, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	ck_assert_int_eq(libinput_device_get_stats(device,
+						   LIBINPUT_STAT_KERNEL_EVENTS),
+			 events + 3);
+	ck_assert_int_eq(libinput_device_get_stats(device,
+						   LIBINPUT_STAT_FRAMES),
+			 frames + 1);
+	ck_assert_int_eq(libinput_device_get_event_stats(device,
+						LIBINPUT_EVENT_POINTER_MOTION),
+			 motion + 1);
+	ck_assert_int_eq(libinput_get_stats(li, LIBINPUT_STAT_EVENTS_POSTED),
+			 posted + 1);
+
+	/* the context counts at least what the device counts */
+	ck_assert_int_ge(libinput_get_stats(li, LIBINPUT_STAT_FRAMES),
+			 libinput_device_get_stats(device,
+						   LIBINPUT_STAT_FRAMES));
+	ck_assert_int_ge(libinput_get_stats(li, LIBINPUT_STAT_QUEUE_PEAK), 1);
+	ck_assert_int_eq(libinput_device_get_stats(device,
+						   LIBINPUT_STAT_QUEUE_PEAK),
+			 0);
+
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(device_stats_timer_wakeups)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	uint64_t wakeups, fired;
+
+	litest_enable_tap(dev->libinput_device);
+	litest_drain_events(li);
+
+	wakeups = libinput_get_stats(li, LIBINPUT_STAT_TIMER_WAKEUPS);
+	fired = libinput_get_stats(li, LIBINPUT_STAT_TIMERS_FIRED);
+
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+	litest_timeout_tap();
+	libinput_dispatch(li);
+
+	litest_assert_button_event(li,
+				   BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_button_event(li,
+				   BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_RELEASED);
+
+	ck_assert_int_gt(libinput_get_stats(li, LIBINPUT_STAT_TIMER_WAKEUPS),
+			 wakeups);
+	/* every wakeup fires at least one timer */
+	ck_assert_int_ge(libinput_get_stats(li, LIBINPUT_STAT_TIMERS_FIRED) -
+			 fired,
+			 libinput_get_stats(li, LIBINPUT_STAT_TIMER_WAKEUPS) -
+			 wakeups);
+	ck_assert_int_eq(libinput_device_get_stats(dev->libinput_device,
+					   LIBINPUT_STAT_TIMER_WAKEUPS),
+			 0);
+}
+END_TEST
+
+START_TEST(device_stats_timer_slack)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	uint64_t wakeups, fired;
+
+	litest_disable_tap(dev->libinput_device);
+	litest_enable_edge_scroll(dev);
+	litest_drain_events(li);
+
+	wakeups = libinput_get_stats(li, LIBINPUT_STAT_TIMER_WAKEUPS);
+	fired = libinput_get_stats(li, LIBINPUT_STAT_TIMERS_FIRED);
+
+	/* Two edge scroll lock timers, the second one expires within the
+	 * slack of the first one */
+	litest_touch_down(dev, 0, 99, 30);
+	libinput_dispatch(li);
+	msleep(2);
+	litest_touch_down(dev, 1, 99, 70);
+	libinput_dispatch(li);
+
+	/* Only dispatch when the fd wakes us up, both timers must fire
+	 * in the same wakeup */
+	while (libinput_get_stats(li, LIBINPUT_STAT_TIMERS_FIRED) -
+	       fired < 2) {
+		struct pollfd fds = {
+			.fd = libinput_get_fd(li),
+			.events = POLLIN,
+		};
+
+		ck_assert_int_eq(poll(&fds, 1, 1000), 1);
+		libinput_dispatch(li);
+	}
+
+	ck_assert_int_eq(libinput_get_stats(li, LIBINPUT_STAT_TIMER_WAKEUPS),
+			 wakeups + 1);
+	ck_assert_int_eq(libinput_get_stats(li, LIBINPUT_STAT_TIMERS_FIRED),
+			 fired + 2);
+
+	litest_touch_up(dev, 0);
+	litest_touch_up(dev, 1);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(device_stats_invalid)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_device *device = dev->libinput_device;
+
+	litest_set_log_handler_bug(li);
+
+	ck_assert_int_eq(libinput_get_stats(li, 0), 0);
+	ck_assert_int_eq(libinput_device_get_stats(device,
+				LIBINPUT_STAT_TIMERFD_UPDATES + 1),
+			 0);
+	ck_assert_int_eq(libinput_get_event_stats(li, LIBINPUT_EVENT_NONE),
+			 0);
+	ck_assert_int_eq(libinput_device_get_event_stats(device, 301), 0);
+
+	litest_restore_log_handler(li);
+}
+END_TEST
+
+START_TEST(device_event_mask)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_event_type motion = LIBINPUT_EVENT_POINTER_MOTION;
+	uint64_t posted;
+
+	litest_drain_events(li);
+
+	ck_assert_int_eq(libinput_device_get_event_type_enabled(device,
+								motion),
+			 1);
+	ck_assert_int_eq(libinput_device_set_event_type_enabled(device,
+								motion,
+								0),
+			 0);
+	ck_assert_int_eq(libinput_device_get_event_type_enabled(device,
+								motion),
+			 0);
+	ck_assert_int_eq(libinput_get_event_type_enabled(li, motion), 1);
+
+	posted = libinput_device_get_event_stats(device, motion);
+
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_button_click(dev, BTN_LEFT, true);
+	litest_button_click(dev, BTN_LEFT, false);
+	libinput_dispatch(li);
+
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_POINTER_BUTTON);
+	ck_assert_int_eq(libinput_device_get_event_stats(device, motion),
+			 posted);
+
+	/* disabled on the context overrides the device */
+	ck_assert_int_eq(libinput_device_set_event_type_enabled(device,
+								motion,
+								1),
+			 0);
+	ck_assert_int_eq(libinput_set_event_type_enabled(li, motion, 0), 0);
+
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	ck_assert_int_eq(libinput_set_event_type_enabled(li, motion, 1), 0);
+
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_POINTER_MOTION);
+}
+END_TEST
+
+START_TEST(device_event_mask_seat_count)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_keyboard *kevent;
+
+	litest_drain_events(li);
+
+	/* the seat key count is kept while the events are disabled */
+	libinput_set_event_type_enabled(li, LIBINPUT_EVENT_KEYBOARD_KEY, 0);
+	litest_keyboard_key(dev, KEY_A, true);
+	litest_assert_empty_queue(li);
+	libinput_set_event_type_enabled(li, LIBINPUT_EVENT_KEYBOARD_KEY, 1);
+
+	litest_keyboard_key(dev, KEY_A, false);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	kevent = litest_is_keyboard_event(event,
+					  KEY_A,
+					  LIBINPUT_KEY_STATE_RELEASED);
+	ck_assert_int_eq(libinput_event_keyboard_get_seat_key_count(kevent),
+			 0);
+	libinput_event_destroy(event);
+}
+END_TEST
+
+START_TEST(device_event_mask_invalid)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_device *device = dev->libinput_device;
+
+	/* devices always come and go */
+	ck_assert_int_eq(libinput_set_event_type_enabled(li,
+					LIBINPUT_EVENT_DEVICE_ADDED,
+					0),
+			 -EINVAL);
+	ck_assert_int_eq(libinput_device_set_event_type_enabled(device,
+					LIBINPUT_EVENT_DEVICE_REMOVED,
+					0),
+			 -EINVAL);
+
+	litest_set_log_handler_bug(li);
+
+	ck_assert_int_eq(libinput_set_event_type_enabled(li,
+							 LIBINPUT_EVENT_NONE,
+							 0),
+			 -EINVAL);
+	ck_assert_int_eq(libinput_device_set_event_type_enabled(device,
+								301,
+								1),
+			 -EINVAL);
+	ck_assert_int_eq(libinput_device_get_event_type_enabled(device, 301),
+			 0);
+
+	litest_restore_log_handler(li);
+}
+END_TEST
+
 void
 litest_setup_tests_device(void)
 {
@@ -1675,4 +1941,13 @@ litest_setup_tests_device(void)
 	litest_add("device:output", device_no_output, LITEST_KEYS, LITEST_ANY);
 
 	litest_add("device:seat", device_seat_phys_name, LITEST_ANY, LITEST_ANY);
+
+	litest_add("device:stats", device_stats, LITEST_RELATIVE, LITEST_ANY);
+	litest_add("device:stats", device_stats_timer_wakeups, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add_for_device("device:stats", device_stats_timer_slack, LITEST_ELANTECH_TOUCHPAD);
+	litest_add("device:stats", device_stats_invalid, LITEST_ANY, LITEST_ANY);
+
+	litest_add("device:event-mask", device_event_mask, LITEST_RELATIVE, LITEST_ANY);
+	litest_add("device:event-mask", device_event_mask_seat_count, LITEST_KEYS, LITEST_ANY);
+	litest_add("device:event-mask", device_event_mask_invalid, LITEST_ANY, LITEST_ANY);
 }
@@ -0,0 +1,272 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <config.h>
+
+#include <check.h>
+#include <errno.h>
+#include <libinput.h>
+#include <libinput-export.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "litest.h"
+
+START_TEST(export_disabled)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+
+	ck_assert_int_eq(libinput_export_get_fd(li), -1);
+	ck_assert_int_eq(libinput_export_add_notify_fd(li, 0), -EINVAL);
+	ck_assert_int_eq(libinput_export_remove_notify_fd(li, 0), -EINVAL);
+	ck_assert_int_eq(libinput_export_enable(li, 65537), -EINVAL);
+	ck_assert_int_eq(libinput_export_enable(li, 0), 0);
+	ck_assert_int_eq(libinput_export_get_fd(li), -1);
+}
+END_TEST
+
+START_TEST(export_pointer)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_export_reader *reader;
+	const struct libinput_export_record *record;
+	uint32_t id;
+	int fd;
+
+	litest_drain_events(li);
+
+	ck_assert_int_eq(libinput_export_enable(li, 64), 0);
+	fd = libinput_export_get_fd(li);
+	ck_assert_int_ge(fd, 0);
+
+	reader = libinput_export_reader_new(fd);
+	ck_assert_notnull(reader);
+	ck_assert(libinput_export_reader_peek(reader) == NULL);
+
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_REL, REL_Y, -1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_button_click(dev, BTN_LEFT, true);
+	libinput_dispatch(li);
+
+	/* The device was added before the export, it's announced anyway */
+	record = libinput_export_reader_peek(reader);
+	ck_assert_notnull(record);
+	ck_assert_int_eq(record->type, LIBINPUT_EVENT_DEVICE_ADDED);
+	ck_assert_str_eq(record->u.device.sysname,
+			 libinput_device_get_sysname(dev->libinput_device));
+	id = record->device;
+	ck_assert(libinput_export_reader_release(reader, record));
+
+	record = libinput_export_reader_peek(reader);
+	ck_assert_notnull(record);
+	ck_assert_int_eq(record->type, LIBINPUT_EVENT_POINTER_MOTION);
+	ck_assert_int_eq(record->device, id);
+	ck_assert_int_ne(record->time, 0);
+	ck_assert_double_gt(record->u.motion.dx, 0.0);
+	ck_assert_double_lt(record->u.motion.dy, 0.0);
+	ck_assert_double_eq(record->u.motion.dx_unaccelerated, 1.0);
+	ck_assert_double_eq(record->u.motion.dy_unaccelerated, -1.0);
+
+	/* peeking again without releasing returns the same record */
+	ck_assert(libinput_export_reader_peek(reader) == record);
+	ck_assert(libinput_export_reader_release(reader, record));
+
+	record = libinput_export_reader_peek(reader);
+	ck_assert_notnull(record);
+	ck_assert_int_eq(record->type, LIBINPUT_EVENT_POINTER_BUTTON);
+	ck_assert_int_eq(record->device, id);
+	ck_assert_int_eq(record->u.button.button, BTN_LEFT);
+	ck_assert_int_eq(record->u.button.state,
+			 LIBINPUT_BUTTON_STATE_PRESSED);
+	ck_assert(libinput_export_reader_release(reader, record));
+
+	ck_assert(libinput_export_reader_peek(reader) == NULL);
+	ck_assert_int_eq(libinput_export_reader_get_lost(reader), 0);
+
+	/* exported regardless of whether the caller reads the events */
+	litest_assert_button_event(li,
+				   BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+
+	libinput_export_reader_destroy(reader);
+	ck_assert_int_eq(libinput_export_enable(li, 0), 0);
+}
+END_TEST
+
+START_TEST(export_lost)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_export_reader *reader;
+	const struct libinput_export_record *record;
+	int i, nrecords = 0;
+
+	litest_drain_events(li);
+
+	/* rounded up to 4 */
+	ck_assert_int_eq(libinput_export_enable(li, 3), 0);
+	reader = libinput_export_reader_new(libinput_export_get_fd(li));
+	ck_assert_notnull(reader);
+
+	/* device added plus 10 motion events */
+	for (i = 0; i < 10; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+	libinput_dispatch(li);
+
+	while ((record = libinput_export_reader_peek(reader))) {
+		ck_assert_int_eq(record->type, LIBINPUT_EVENT_POINTER_MOTION);
+		ck_assert(libinput_export_reader_release(reader, record));
+		nrecords++;
+	}
+
+	ck_assert_int_eq(nrecords, 4);
+	ck_assert_int_eq(libinput_export_reader_get_lost(reader), 7);
+
+	libinput_export_reader_destroy(reader);
+	ck_assert_int_eq(libinput_export_enable(li, 0), 0);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(export_late_reader)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct litest_device *mouse;
+	struct libinput_export_reader *reader;
+	const struct libinput_export_record *record;
+	struct libinput_export_device device;
+	uint32_t id;
+	int i;
+
+	litest_drain_events(li);
+
+	ck_assert_int_eq(libinput_export_enable(li, 4), 0);
+
+	/* The device added record is overwritten before the reader
+	 * attaches */
+	mouse = litest_add_device(li, LITEST_MOUSE);
+	for (i = 0; i < 10; i++) {
+		litest_event(mouse, EV_REL, REL_X, 1);
+		litest_event(mouse, EV_SYN, SYN_REPORT, 0);
+	}
+	libinput_dispatch(li);
+
+	reader = libinput_export_reader_new(libinput_export_get_fd(li));
+	ck_assert_notnull(reader);
+	ck_assert(libinput_export_reader_peek(reader) == NULL);
+
+	litest_event(mouse, EV_REL, REL_X, 1);
+	litest_event(mouse, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	record = libinput_export_reader_peek(reader);
+	ck_assert_notnull(record);
+	ck_assert_int_eq(record->type, LIBINPUT_EVENT_POINTER_MOTION);
+	id = record->device;
+	ck_assert(libinput_export_reader_release(reader, record));
+
+	ck_assert(libinput_export_reader_get_device(reader, id, &device));
+	ck_assert_int_eq(device.id, id);
+	ck_assert_int_eq(device.removed, 0);
+	ck_assert_str_eq(device.sysname,
+			 libinput_device_get_sysname(mouse->libinput_device));
+	ck_assert_str_eq(device.name,
+			 libinput_device_get_name(mouse->libinput_device));
+
+	ck_assert(!libinput_export_reader_get_device(reader, 0, &device));
+	ck_assert(!libinput_export_reader_get_device(reader, id + 100,
+						     &device));
+
+	/* Removed devices stay in the table */
+	litest_delete_device(mouse);
+	libinput_dispatch(li);
+	ck_assert(libinput_export_reader_get_device(reader, id, &device));
+	ck_assert_int_ne(device.removed, 0);
+
+	libinput_export_reader_destroy(reader);
+	ck_assert_int_eq(libinput_export_enable(li, 0), 0);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(export_notify)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	uint64_t count;
+	int efd;
+
+	litest_drain_events(li);
+
+	efd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+	ck_assert_int_ge(efd, 0);
+
+	ck_assert_int_eq(libinput_export_enable(li, 64), 0);
+	ck_assert_int_eq(libinput_export_add_notify_fd(li, efd), 0);
+	ck_assert_int_eq(libinput_export_add_notify_fd(li, efd), -EEXIST);
+
+	/* nothing exported, nothing signalled */
+	libinput_dispatch(li);
+	ck_assert_int_eq(read(efd, &count, sizeof(count)), -1);
+	ck_assert_int_eq(errno, EAGAIN);
+
+	/* one notification per dispatch, not per event */
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+	ck_assert_int_eq(read(efd, &count, sizeof(count)), sizeof(count));
+	ck_assert_int_eq(count, 1);
+
+	ck_assert_int_eq(libinput_export_remove_notify_fd(li, efd), 0);
+	ck_assert_int_eq(libinput_export_remove_notify_fd(li, efd), -ENOENT);
+
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+	ck_assert_int_eq(read(efd, &count, sizeof(count)), -1);
+	ck_assert_int_eq(errno, EAGAIN);
+
+	ck_assert_int_eq(libinput_export_enable(li, 0), 0);
+	close(efd);
+	litest_drain_events(li);
+}
+END_TEST
+
+void
+litest_setup_tests_export(void)
+{
+	litest_add_for_device("export:api", export_disabled, LITEST_MOUSE);
+	litest_add_for_device("export:pointer", export_pointer, LITEST_MOUSE);
+	litest_add_for_device("export:pointer", export_lost, LITEST_MOUSE);
+	litest_add_for_device("export:devices", export_late_reader, LITEST_MOUSE);
+	litest_add_for_device("export:notify", export_notify, LITEST_MOUSE);
+}
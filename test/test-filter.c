@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <config.h>
+
+#include <check.h>
+#include <math.h>
+
+#include "litest.h"
+#include "filter.h"
+
+struct accel_filter_pair {
+	struct motion_filter *(*reference)(int dpi);
+	struct motion_filter *(*fixed)(int dpi);
+	int dpi;
+};
+
+START_TEST(filter_fixed_point_accel)
+{
+	struct accel_filter_pair filters[] = {
+		{ create_pointer_accelerator_filter_linear,
+		  create_pointer_accelerator_filter_linear_fixed, 1000 },
+		{ create_pointer_accelerator_filter_linear,
+		  create_pointer_accelerator_filter_linear_fixed, 1600 },
+		{ create_pointer_accelerator_filter_linear_low_dpi,
+		  create_pointer_accelerator_filter_linear_low_dpi_fixed, 400 },
+		{ create_pointer_accelerator_filter_touchpad,
+		  create_pointer_accelerator_filter_touchpad_fixed, 1000 },
+		{ create_pointer_accelerator_filter_trackpoint,
+		  create_pointer_accelerator_filter_trackpoint_fixed, 1000 },
+	};
+	struct accel_filter_pair *p;
+	double speed;
+
+	ARRAY_FOR_EACH(filters, p) {
+		for (speed = -1.0; speed <= 1.0; speed += 0.5) {
+			struct motion_filter *reference, *fixed;
+			uint64_t time = 0;
+			int i;
+
+			reference = p->reference(p->dpi);
+			fixed = p->fixed(p->dpi);
+			filter_set_speed(reference, speed);
+			filter_set_speed(fixed, speed);
+
+			/* A mix of slow and fast motion, direction changes,
+			 * uneven timestamps and the occasional pause */
+			for (i = 0; i < 4000; i++) {
+				struct device_float_coords delta;
+				struct normalized_coords r, f;
+				double error, bound;
+
+				time += ms2us(i % 7 == 0 ? 8 : 1);
+				if (i % 1000 == 0)
+					time += ms2us(500);
+
+				if (i % 3 == 0) {
+					delta.x = (i/40) % 40;
+					delta.y = 0;
+				} else {
+					delta.x = (i * 7) % 31 - 15;
+					delta.y = (i * 3) % 11 - 5;
+				}
+
+				r = filter_dispatch(reference,
+						    &delta,
+						    NULL,
+						    time);
+				f = filter_dispatch(fixed, &delta, NULL, time);
+
+				/* within 0.1% plus 1/1000 of a unit */
+				error = hypot(r.x - f.x, r.y - f.y);
+				bound = 0.001 + 0.001 * hypot(r.x, r.y);
+				litest_assert_double_le(error, bound);
+			}
+
+			filter_destroy(reference);
+			filter_destroy(fixed);
+		}
+	}
+}
+END_TEST
+
+void
+litest_setup_tests_filter(void)
+{
+	litest_add_no_device("filter:fixed-point", filter_fixed_point_accel);
+}
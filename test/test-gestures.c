@@ -1266,6 +1266,51 @@ START_TEST(gestures_3fg_buttonarea_scroll_btntool)
 }
 END_TEST
 
+START_TEST(gestures_disabled_events)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	enum libinput_event_type types[] = {
+		LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
+		LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+		LIBINPUT_EVENT_GESTURE_SWIPE_END,
+		LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
+		LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
+		LIBINPUT_EVENT_GESTURE_PINCH_END,
+	};
+	enum libinput_event_type *t;
+
+	if (libevdev_get_num_slots(dev->evdev) < 3)
+		return;
+
+	ARRAY_FOR_EACH(types, t)
+		libinput_set_event_type_enabled(li, *t, 0);
+
+	litest_drain_events(li);
+
+	/* no gestures wanted, three fingers don't do anything */
+	litest_touch_down(dev, 0, 40, 40);
+	litest_touch_down(dev, 1, 50, 40);
+	litest_touch_down(dev, 2, 60, 40);
+	libinput_dispatch(li);
+	litest_touch_move_three_touches(dev,
+					40, 40,
+					50, 40,
+					60, 40,
+					0, 30,
+					10, 2);
+	litest_touch_up(dev, 2);
+	litest_touch_up(dev, 1);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+
+	litest_assert_empty_queue(li);
+
+	ARRAY_FOR_EACH(types, t)
+		libinput_set_event_type_enabled(li, *t, 1);
+}
+END_TEST
+
 void
 litest_setup_tests_gestures(void)
 {
@@ -1292,4 +1337,6 @@ litest_setup_tests_gestures(void)
 	litest_add("gestures:swipe", gestures_3fg_buttonarea_scroll_btntool, LITEST_CLICKPAD, LITEST_SINGLE_TOUCH);
 
 	litest_add("gestures:time", gestures_time_usec, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
+
+	litest_add("gestures:event-mask", gestures_disabled_events, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
 }
@@ -140,6 +140,68 @@ START_TEST(log_priority)
 }
 END_TEST
 
+START_TEST(log_deferred)
+{
+	struct libinput *li;
+
+	li = libinput_path_create_context(&simple_interface, NULL);
+	libinput_log_set_priority(li, LIBINPUT_LOG_PRIORITY_ERROR);
+	libinput_log_set_handler(li, simple_log_handler);
+	log_handler_context = li;
+
+	ck_assert_int_eq(libinput_log_set_deferred(li, 16), 0);
+
+	libinput_path_add_device(li, "/tmp");
+	ck_assert_int_eq(log_handler_called, 0);
+
+	ck_assert_int_eq(libinput_log_drain(li), 1);
+	ck_assert_int_eq(log_handler_called, 1);
+	ck_assert_int_eq(libinput_log_drain(li), 0);
+	ck_assert_int_eq(libinput_log_get_dropped(li), 0);
+
+	/* back to immediate logging */
+	ck_assert_int_eq(libinput_log_set_deferred(li, 0), 0);
+	libinput_path_add_device(li, "/tmp");
+	ck_assert_int_eq(log_handler_called, 2);
+	ck_assert_int_eq(libinput_log_drain(li), 0);
+
+	log_handler_called = 0;
+
+	libinput_unref(li);
+	log_handler_context = NULL;
+}
+END_TEST
+
+START_TEST(log_deferred_dropped)
+{
+	struct libinput *li;
+
+	li = libinput_path_create_context(&simple_interface, NULL);
+	libinput_log_set_priority(li, LIBINPUT_LOG_PRIORITY_ERROR);
+	libinput_log_set_handler(li, simple_log_handler);
+	log_handler_context = li;
+
+	ck_assert_int_eq(libinput_log_set_deferred(li, 1), 0);
+
+	libinput_path_add_device(li, "/tmp");
+	libinput_path_add_device(li, "/tmp");
+	libinput_path_add_device(li, "/tmp");
+	ck_assert_int_eq(libinput_log_get_dropped(li), 2);
+
+	ck_assert_int_eq(libinput_log_drain(li), 1);
+	ck_assert_int_eq(log_handler_called, 1);
+
+	/* dropped count survives a new ring */
+	ck_assert_int_eq(libinput_log_set_deferred(li, 4), 0);
+	ck_assert_int_eq(libinput_log_get_dropped(li), 2);
+
+	log_handler_called = 0;
+
+	libinput_unref(li);
+	log_handler_context = NULL;
+}
+END_TEST
+
 static int axisrange_log_handler_called = 0;
 
 static void
@@ -194,6 +256,8 @@ litest_setup_tests_log(void)
 	litest_add_no_device("log:logging", log_handler_invoked);
 	litest_add_no_device("log:logging", log_handler_NULL);
 	litest_add_no_device("log:logging", log_priority);
+	litest_add_no_device("log:logging", log_deferred);
+	litest_add_no_device("log:logging", log_deferred_dropped);
 
 	litest_add_ranged("log:warnings", log_axisrange_warning, LITEST_TOUCH, LITEST_ANY, &axes);
 	litest_add_ranged("log:warnings", log_axisrange_warning, LITEST_TOUCHPAD, LITEST_ANY, &axes);
@@ -343,6 +343,69 @@ START_TEST(pointer_motion_unaccel)
 }
 END_TEST
 
+static struct libinput_event_pointer *
+motion_prediction_event(struct litest_device *dev, int dx)
+{
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+
+	msleep(5);
+	litest_event(dev, EV_REL, REL_X, dx);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	litest_assert_empty_queue(li);
+
+	return litest_is_motion_event(event);
+}
+
+START_TEST(pointer_motion_prediction)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_event_pointer *ptrev;
+	struct libinput_event *event;
+	uint64_t time;
+	double dx, dy;
+	int i;
+
+	litest_drain_events(dev->libinput);
+
+	for (i = 0; i < 5; i++) {
+		ptrev = motion_prediction_event(dev, 5);
+		event = libinput_event_pointer_get_base_event(ptrev);
+		libinput_event_destroy(event);
+	}
+
+	ptrev = motion_prediction_event(dev, 5);
+	time = libinput_event_pointer_get_time_usec(ptrev);
+
+	dx = libinput_event_pointer_get_dx_predicted(ptrev, time + ms2us(10));
+	dy = libinput_event_pointer_get_dy_predicted(ptrev, time + ms2us(10));
+	litest_assert_double_gt(dx, 0.0);
+	litest_assert_double_eq(dy, 0.0);
+
+	/* target in the past or present */
+	dx = libinput_event_pointer_get_dx_predicted(ptrev, time);
+	litest_assert_double_eq(dx, 0.0);
+	dx = libinput_event_pointer_get_dx_predicted(ptrev, time - 1);
+	litest_assert_double_eq(dx, 0.0);
+
+	/* horizon is clamped */
+	dx = libinput_event_pointer_get_dx_predicted(ptrev, time + ms2us(50));
+	dy = libinput_event_pointer_get_dx_predicted(ptrev, time + ms2us(500));
+	litest_assert_double_eq(dx, dy);
+	libinput_event_destroy(libinput_event_pointer_get_base_event(ptrev));
+
+	/* direction change clamps the prediction */
+	ptrev = motion_prediction_event(dev, -5);
+	time = libinput_event_pointer_get_time_usec(ptrev);
+	dx = libinput_event_pointer_get_dx_predicted(ptrev, time + ms2us(10));
+	litest_assert_double_eq(dx, 0.0);
+	libinput_event_destroy(libinput_event_pointer_get_base_event(ptrev));
+}
+END_TEST
+
 static void
 test_button_event(struct litest_device *dev, unsigned int button, int state)
 {
@@ -1782,6 +1845,77 @@ START_TEST(middlebutton_middleclick_during)
 }
 END_TEST
 
+START_TEST(middlebutton_adaptive_timeout)
+{
+	struct litest_device *device = litest_current_device();
+	struct libinput *li = device->libinput;
+	enum libinput_config_status status;
+	uint64_t timeout;
+	int i;
+
+	disable_button_scrolling(device);
+
+	status = libinput_device_config_middle_emulation_set_enabled(
+					    device->libinput_device,
+					    LIBINPUT_CONFIG_MIDDLE_EMULATION_ENABLED);
+	if (status == LIBINPUT_CONFIG_STATUS_UNSUPPORTED)
+		return;
+
+	timeout = libinput_device_config_middle_emulation_get_timeout_usec(
+					    device->libinput_device);
+	ck_assert_int_eq(timeout, 50000);
+
+	litest_drain_events(li);
+
+	/* fast chords shrink the timeout */
+	for (i = 0; i < 10; i++) {
+		litest_button_click(device, BTN_LEFT, true);
+		litest_button_click(device, BTN_RIGHT, true);
+		litest_button_click(device, BTN_LEFT, false);
+		litest_button_click(device, BTN_RIGHT, false);
+		litest_assert_button_event(li,
+					   BTN_MIDDLE,
+					   LIBINPUT_BUTTON_STATE_PRESSED);
+		litest_assert_button_event(li,
+					   BTN_MIDDLE,
+					   LIBINPUT_BUTTON_STATE_RELEASED);
+	}
+
+	timeout = libinput_device_config_middle_emulation_get_timeout_usec(
+					    device->libinput_device);
+	ck_assert_int_lt(timeout, 50000);
+
+	/* a normal click is now released earlier */
+	litest_button_click(device, BTN_LEFT, true);
+	litest_assert_empty_queue(li);
+	msleep(timeout/1000 + 5);
+	libinput_dispatch(li);
+	litest_assert_button_event(li,
+				   BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+
+	/* a slow chord that missed the timeout grows it again */
+	msleep(10);
+	litest_button_click(device, BTN_RIGHT, true);
+	litest_button_click(device, BTN_LEFT, false);
+	litest_button_click(device, BTN_RIGHT, false);
+	litest_drain_events(li);
+
+	ck_assert_int_gt(
+		 libinput_device_config_middle_emulation_get_timeout_usec(
+					    device->libinput_device),
+		 timeout);
+
+	status = libinput_device_config_middle_emulation_set_enabled(
+					    device->libinput_device,
+					    LIBINPUT_CONFIG_MIDDLE_EMULATION_DISABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	timeout = libinput_device_config_middle_emulation_get_timeout_usec(
+					    device->libinput_device);
+	ck_assert_int_eq(timeout, 0);
+}
+END_TEST
+
 START_TEST(middlebutton_default_enabled)
 {
 	struct litest_device *dev = litest_current_device();
@@ -2084,6 +2218,7 @@ litest_setup_tests_pointer(void)
 	litest_add_ranged("pointer:motion", pointer_motion_relative_min_decel, LITEST_RELATIVE, LITEST_ANY, &compass);
 	litest_add("pointer:motion", pointer_motion_absolute, LITEST_ABSOLUTE, LITEST_ANY);
 	litest_add("pointer:motion", pointer_motion_unaccel, LITEST_RELATIVE, LITEST_ANY);
+	litest_add("pointer:motion", pointer_motion_prediction, LITEST_RELATIVE, LITEST_ANY);
 	litest_add("pointer:button", pointer_button, LITEST_BUTTON, LITEST_CLICKPAD);
 	litest_add_no_device("pointer:button", pointer_button_auto_release);
 	litest_add_no_device("pointer:button", pointer_seat_button_count);
@@ -2127,6 +2262,7 @@ litest_setup_tests_pointer(void)
 	litest_add("pointer:middlebutton", middlebutton_doubleclick, LITEST_BUTTON, LITEST_CLICKPAD);
 	litest_add("pointer:middlebutton", middlebutton_middleclick, LITEST_BUTTON, LITEST_CLICKPAD);
 	litest_add("pointer:middlebutton", middlebutton_middleclick_during, LITEST_BUTTON, LITEST_CLICKPAD);
+	litest_add("pointer:middlebutton", middlebutton_adaptive_timeout, LITEST_BUTTON, LITEST_CLICKPAD);
 	litest_add("pointer:middlebutton", middlebutton_default_enabled, LITEST_BUTTON, LITEST_TOUCHPAD|LITEST_POINTINGSTICK);
 	litest_add("pointer:middlebutton", middlebutton_default_clickpad, LITEST_CLICKPAD, LITEST_ANY);
 	litest_add("pointer:middlebutton", middlebutton_default_touchpad, LITEST_TOUCHPAD, LITEST_CLICKPAD);
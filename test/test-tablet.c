@@ -2109,6 +2109,213 @@ START_TEST(tool_user_data)
 }
 END_TEST
 
+START_TEST(tool_smoothing_config)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_tablet_tool *tablet_event;
+	struct libinput_event *event;
+	struct libinput_tablet_tool *tool;
+	enum libinput_config_status status;
+	enum libinput_config_tablet_tool_smoothing mode;
+	double strength;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+
+	litest_drain_events(li);
+
+	litest_tablet_proximity_in(dev, 50, 50, axes);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tablet_event = litest_is_tablet_event(event,
+				LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+	tool = libinput_event_tablet_tool_get_tool(tablet_event);
+
+	mode = libinput_tablet_tool_config_smoothing_get_mode(tool);
+	ck_assert_int_eq(mode, LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_AVERAGE);
+	mode = libinput_tablet_tool_config_smoothing_get_default_mode(tool);
+	ck_assert_int_eq(mode, LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_AVERAGE);
+	strength = libinput_tablet_tool_config_smoothing_get_default_strength(tool);
+	ck_assert_double_eq(strength,
+			    libinput_tablet_tool_config_smoothing_get_strength(tool));
+
+	mode = LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_ADAPTIVE;
+	status = libinput_tablet_tool_config_smoothing_set_mode(tool, mode);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_tablet_tool_config_smoothing_get_mode(tool),
+			 mode);
+
+	status = libinput_tablet_tool_config_smoothing_set_mode(tool,
+								mode + 1);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+
+	status = libinput_tablet_tool_config_smoothing_set_strength(tool, 0.0);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	status = libinput_tablet_tool_config_smoothing_set_strength(tool, 1.0);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	strength = libinput_tablet_tool_config_smoothing_get_strength(tool);
+	ck_assert_double_eq(strength, 1.0);
+
+	status = libinput_tablet_tool_config_smoothing_set_strength(tool, -0.1);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+	status = libinput_tablet_tool_config_smoothing_set_strength(tool, 1.1);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+	strength = libinput_tablet_tool_config_smoothing_get_strength(tool);
+	ck_assert_double_eq(strength, 1.0);
+
+	/* motion keeps working after changing the config in proximity */
+	litest_tablet_motion(dev, 60, 60, axes);
+	libinput_dispatch(li);
+	litest_assert_only_typed_events(li,
+					LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+
+	libinput_event_destroy(event);
+}
+END_TEST
+
+static double
+tool_smoothing_next_x(struct libinput *li, enum libinput_event_type type)
+{
+	struct libinput_event *event;
+	struct libinput_event_tablet_tool *tablet_event;
+	double x;
+
+	libinput_dispatch(li);
+	event = libinput_get_event(li);
+	tablet_event = litest_is_tablet_event(event, type);
+	x = libinput_event_tablet_tool_get_x(tablet_event);
+	libinput_event_destroy(event);
+	litest_drain_events(li);
+
+	return x;
+}
+
+START_TEST(tool_smoothing_adaptive)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_tablet_tool *tablet_event;
+	struct libinput_event *event;
+	struct libinput_tablet_tool *tool;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+	double x_raw, x;
+
+	litest_drain_events(li);
+
+	/* the first event in proximity is never smoothed */
+	litest_tablet_proximity_in(dev, 60, 50, axes);
+	libinput_dispatch(li);
+	event = libinput_get_event(li);
+	tablet_event = litest_is_tablet_event(event,
+				LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+	tool = libinput_event_tablet_tool_get_tool(tablet_event);
+	libinput_tablet_tool_ref(tool);
+	x_raw = libinput_event_tablet_tool_get_x(tablet_event);
+	libinput_event_destroy(event);
+	litest_drain_events(li);
+
+	litest_tablet_proximity_out(dev);
+	litest_drain_events(li);
+
+	/* the default averaging lags behind a jump */
+	litest_tablet_proximity_in(dev, 40, 50, axes);
+	litest_drain_events(li);
+	litest_tablet_motion(dev, 60, 50, axes);
+	x = tool_smoothing_next_x(li, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	ck_assert_double_lt(x, x_raw);
+
+	litest_tablet_proximity_out(dev);
+	litest_drain_events(li);
+
+	/* adaptive with zero strength doesn't */
+	libinput_tablet_tool_config_smoothing_set_mode(tool,
+			LIBINPUT_CONFIG_TABLET_TOOL_SMOOTHING_ADAPTIVE);
+	libinput_tablet_tool_config_smoothing_set_strength(tool, 0.0);
+
+	litest_tablet_proximity_in(dev, 40, 50, axes);
+	litest_drain_events(li);
+	litest_tablet_motion(dev, 60, 50, axes);
+	x = tool_smoothing_next_x(li, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	ck_assert_double_eq(x, x_raw);
+
+	litest_tablet_proximity_out(dev);
+	litest_drain_events(li);
+
+	/* with a non-zero strength the adaptive filter smoothes too */
+	libinput_tablet_tool_config_smoothing_set_strength(tool, 1.0);
+
+	litest_tablet_proximity_in(dev, 40, 50, axes);
+	litest_drain_events(li);
+	msleep(5);
+	litest_tablet_motion(dev, 60, 50, axes);
+	x = tool_smoothing_next_x(li, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	ck_assert_double_lt(x, x_raw);
+
+	litest_tablet_proximity_out(dev);
+	litest_drain_events(li);
+
+	libinput_tablet_tool_unref(tool);
+}
+END_TEST
+
+START_TEST(tool_smoothing_strength_change)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_tablet_tool *tablet_event;
+	struct libinput_event *event;
+	struct libinput_tablet_tool *tool;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+	double x_raw, x;
+
+	litest_drain_events(li);
+
+	litest_tablet_proximity_in(dev, 60, 50, axes);
+	libinput_dispatch(li);
+	event = libinput_get_event(li);
+	tablet_event = litest_is_tablet_event(event,
+				LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+	tool = libinput_event_tablet_tool_get_tool(tablet_event);
+	libinput_tablet_tool_ref(tool);
+	x_raw = libinput_event_tablet_tool_get_x(tablet_event);
+	libinput_event_destroy(event);
+	litest_drain_events(li);
+
+	litest_tablet_proximity_out(dev);
+	litest_drain_events(li);
+
+	litest_tablet_proximity_in(dev, 40, 50, axes);
+	litest_drain_events(li);
+	litest_tablet_motion(dev, 60, 50, axes);
+	x = tool_smoothing_next_x(li, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	ck_assert_double_lt(x, x_raw);
+
+	/* a strength change mid-stroke keeps the history, the box filter
+	 * still averages the earlier samples in */
+	libinput_tablet_tool_config_smoothing_set_strength(tool, 0.7);
+	litest_tablet_motion(dev, 60, 51, axes);
+	x = tool_smoothing_next_x(li, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	ck_assert_double_lt(x, x_raw);
+
+	litest_tablet_proximity_out(dev);
+	litest_drain_events(li);
+
+	libinput_tablet_tool_unref(tool);
+}
+END_TEST
+
 START_TEST(pad_buttons_ignored)
 {
 	struct litest_device *dev = litest_current_device();
@@ -4325,6 +4532,9 @@ litest_setup_tests_tablet(void)
 {
 	litest_add("tablet:tool", tool_ref, LITEST_TABLET | LITEST_TOOL_SERIAL, LITEST_ANY);
 	litest_add("tablet:tool", tool_user_data, LITEST_TABLET | LITEST_TOOL_SERIAL, LITEST_ANY);
+	litest_add("tablet:tool", tool_smoothing_config, LITEST_TABLET, LITEST_ANY);
+	litest_add("tablet:tool", tool_smoothing_adaptive, LITEST_TABLET | LITEST_TOOL_SERIAL, LITEST_ANY);
+	litest_add("tablet:tool", tool_smoothing_strength_change, LITEST_TABLET | LITEST_TOOL_SERIAL, LITEST_ANY);
 	litest_add("tablet:tool", tool_capability, LITEST_TABLET, LITEST_ANY);
 	litest_add_no_device("tablet:tool", tool_capabilities);
 	litest_add("tablet:tool", tool_type, LITEST_TABLET, LITEST_ANY);
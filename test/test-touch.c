@@ -241,6 +241,85 @@ START_TEST(touch_many_slots)
 }
 END_TEST
 
+START_TEST(touch_seat_slot_many_devices)
+{
+	struct litest_device *devices[4];
+	struct libinput *li;
+	const int ndevices = ARRAY_LENGTH(devices);
+	const int num_tps = 100;
+	const char *name = "litest Touch wall";
+	int i, slot;
+
+	struct input_absinfo abs[] = {
+		{ ABS_MT_SLOT, 0, num_tps - 1, 0, 0, 0 },
+		{ .value = -1 },
+	};
+
+	devices[0] = litest_create_device_with_overrides(LITEST_WACOM_TOUCH,
+							 name, NULL, abs, NULL);
+	li = devices[0]->libinput;
+	for (i = 1; i < ndevices; i++)
+		devices[i] = litest_add_device_with_overrides(li,
+							      LITEST_WACOM_TOUCH,
+							      name, NULL,
+							      abs, NULL);
+	litest_drain_events(li);
+
+	/* seat slots are handed out lowest-first across all devices */
+	for (i = 0; i < ndevices; i++) {
+		for (slot = 0; slot < num_tps; slot++) {
+			litest_touch_down(devices[i], slot, 10 + slot/2, 50);
+			touch_assert_seat_slot(li,
+					       LIBINPUT_EVENT_TOUCH_DOWN,
+					       slot,
+					       i * num_tps + slot);
+		}
+	}
+
+	/* freed slots are reused, the others keep their numbers */
+	for (slot = 0; slot < num_tps; slot += 2) {
+		litest_touch_up(devices[1], slot);
+		touch_assert_seat_slot(li,
+				       LIBINPUT_EVENT_TOUCH_UP,
+				       slot,
+				       num_tps + slot);
+	}
+
+	for (slot = 0; slot < num_tps; slot += 2) {
+		litest_touch_down(devices[1], slot, 10 + slot/2, 60);
+		touch_assert_seat_slot(li,
+				       LIBINPUT_EVENT_TOUCH_DOWN,
+				       slot,
+				       num_tps + slot);
+	}
+
+	litest_touch_move(devices[3], num_tps - 1, 80, 80);
+	touch_assert_seat_slot(li,
+			       LIBINPUT_EVENT_TOUCH_MOTION,
+			       num_tps - 1,
+			       ndevices * num_tps - 1);
+
+	for (i = 0; i < ndevices; i++) {
+		for (slot = 0; slot < num_tps; slot++) {
+			litest_touch_up(devices[i], slot);
+			touch_assert_seat_slot(li,
+					       LIBINPUT_EVENT_TOUCH_UP,
+					       slot,
+					       i * num_tps + slot);
+		}
+	}
+
+	/* all slots are free again */
+	litest_touch_down(devices[2], 0, 50, 50);
+	touch_assert_seat_slot(li, LIBINPUT_EVENT_TOUCH_DOWN, 0, 0);
+	litest_touch_up(devices[2], 0);
+	touch_assert_seat_slot(li, LIBINPUT_EVENT_TOUCH_UP, 0, 0);
+
+	for (i = ndevices - 1; i >= 0; i--)
+		litest_delete_device(devices[i]);
+}
+END_TEST
+
 START_TEST(touch_double_touch_down_up)
 {
 	struct libinput *libinput;
@@ -843,6 +922,79 @@ START_TEST(touch_time_usec)
 }
 END_TEST
 
+static struct libinput_event *
+touch_prediction_move(struct litest_device *dev, double x)
+{
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event, *frame;
+
+	msleep(5);
+	litest_touch_move(dev, 0, x, 50);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_MOTION);
+	frame = libinput_get_event(li);
+	litest_is_touch_event(frame, LIBINPUT_EVENT_TOUCH_FRAME);
+	libinput_event_destroy(frame);
+
+	return event;
+}
+
+START_TEST(touch_motion_prediction)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_touch *tev;
+	uint64_t time;
+	double x, y, xp, yp;
+	int i;
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 20, 50);
+	litest_drain_events(li);
+
+	for (i = 0; i < 5; i++) {
+		event = touch_prediction_move(dev, 22 + i * 2);
+		libinput_event_destroy(event);
+	}
+
+	event = touch_prediction_move(dev, 40);
+	tev = libinput_event_get_touch_event(event);
+	time = libinput_event_touch_get_time_usec(tev);
+	x = libinput_event_touch_get_x(tev);
+	y = libinput_event_touch_get_y(tev);
+
+	xp = libinput_event_touch_get_x_predicted(tev, time + ms2us(10));
+	yp = libinput_event_touch_get_y_predicted(tev, time + ms2us(10));
+	litest_assert_double_gt(xp, x);
+	litest_assert_double_eq(yp, y);
+
+	xp = libinput_event_touch_get_x_predicted(tev, time);
+	litest_assert_double_eq(xp, x);
+
+	x = libinput_event_touch_get_x_transformed(tev, 1000);
+	xp = libinput_event_touch_get_x_transformed_predicted(tev,
+							       1000,
+							       time + ms2us(10));
+	litest_assert_double_gt(xp, x);
+	libinput_event_destroy(event);
+
+	/* direction change clamps the prediction */
+	event = touch_prediction_move(dev, 30);
+	tev = libinput_event_get_touch_event(event);
+	time = libinput_event_touch_get_time_usec(tev);
+	x = libinput_event_touch_get_x(tev);
+	xp = libinput_event_touch_get_x_predicted(tev, time + ms2us(10));
+	litest_assert_double_eq(xp, x);
+	libinput_event_destroy(event);
+
+	litest_touch_up(dev, 0);
+}
+END_TEST
+
 START_TEST(touch_fuzz)
 {
 	struct litest_device *dev = litest_current_device();
@@ -896,6 +1048,7 @@ litest_setup_tests_touch(void)
 	litest_add_no_device("touch:abs-transform", touch_abs_transform);
 	litest_add("touch:slots", touch_seat_slot, LITEST_TOUCH, LITEST_TOUCHPAD);
 	litest_add_no_device("touch:slots", touch_many_slots);
+	litest_add_no_device("touch:slots", touch_seat_slot_many_devices);
 	litest_add("touch:double-touch-down-up", touch_double_touch_down_up, LITEST_TOUCH, LITEST_ANY);
 	litest_add("touch:calibration", touch_calibration_scale, LITEST_TOUCH, LITEST_TOUCHPAD);
 	litest_add("touch:calibration", touch_calibration_scale, LITEST_SINGLE_TOUCH, LITEST_TOUCHPAD);
@@ -918,6 +1071,7 @@ litest_setup_tests_touch(void)
 	litest_add_ranged("touch:state", touch_initial_state, LITEST_TOUCH, LITEST_PROTOCOL_A, &axes);
 
 	litest_add("touch:time", touch_time_usec, LITEST_TOUCH, LITEST_TOUCHPAD);
+	litest_add("touch:prediction", touch_motion_prediction, LITEST_TOUCH, LITEST_TOUCHPAD);
 
 	litest_add_for_device("touch:fuzz", touch_fuzz, LITEST_MULTITOUCH_FUZZ_SCREEN);
 }
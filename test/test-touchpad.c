@@ -65,6 +65,89 @@ START_TEST(touchpad_1fg_motion)
 }
 END_TEST
 
+START_TEST(touchpad_1fg_motion_small)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+	double width, height;
+	double x = 50, step;
+	int i, nevents = 0;
+
+	/* without a resolution the hysteresis margin is 0 */
+	if (libinput_device_get_size(dev->libinput_device, &width, &height))
+		return;
+
+	litest_disable_tap(dev->libinput_device);
+	litest_drain_events(li);
+
+	/* 0.4mm total, less than the hysteresis margin. On a touchpad that
+	 * doesn't wobble this must not be swallowed. */
+	step = 0.05/width * 100;
+
+	litest_touch_down(dev, 0, x, 50);
+	for (i = 0; i < 8; i++) {
+		x += step;
+		litest_touch_move(dev, 0, x, 50);
+	}
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		ptrev = litest_is_motion_event(event);
+		ck_assert_double_ge(libinput_event_pointer_get_dx(ptrev), 0.0);
+		libinput_event_destroy(event);
+		nevents++;
+	}
+
+	ck_assert_int_gt(nevents, 0);
+}
+END_TEST
+
+START_TEST(touchpad_1fg_motion_wobbling)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	double width, height;
+	double step;
+	int i, nevents = 0;
+
+	if (libinput_device_get_size(dev->libinput_device, &width, &height))
+		return;
+
+	litest_disable_tap(dev->libinput_device);
+	litest_drain_events(li);
+
+	/* back and forth by 0.3mm, within the hysteresis margin */
+	step = 0.3/width * 100;
+
+	litest_touch_down(dev, 0, 50, 50);
+	for (i = 0; i < 10; i++)
+		litest_touch_move(dev, 0, 50 + (i % 2) * step, 50);
+	libinput_dispatch(li);
+
+	/* the first few wobbles get through before it's detected */
+	while ((event = libinput_get_event(li))) {
+		litest_is_motion_event(event);
+		libinput_event_destroy(event);
+		nevents++;
+	}
+	ck_assert_int_gt(nevents, 0);
+
+	/* now hysteresis is enabled and swallows the wobbling */
+	for (i = 0; i < 10; i++)
+		litest_touch_move(dev, 0, 50 + (i % 2) * step, 50);
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
 START_TEST(touchpad_2fg_no_motion)
 {
 	struct litest_device *dev = litest_current_device();
@@ -659,6 +742,96 @@ START_TEST(touchpad_edge_scroll_timeout)
 }
 END_TEST
 
+START_TEST(touchpad_edge_scroll_lazy_timers_unused)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_device *device = dev->libinput_device;
+	struct litest_device *second;
+
+	/* Neither software buttons nor edge scrolling, so the per-touch
+	 * timers are never allocated */
+	ck_assert_int_eq(libinput_device_config_scroll_get_method(device),
+			 LIBINPUT_CONFIG_SCROLL_2FG);
+	ck_assert_int_eq(libinput_device_config_click_get_method(device),
+			 LIBINPUT_CONFIG_CLICK_METHOD_NONE);
+
+	litest_disable_tap(device);
+	litest_drain_events(li);
+
+	/* edge and button area touches are plain motion */
+	litest_touch_down(dev, 0, 99, 20);
+	litest_timeout_edgescroll();
+	litest_touch_move_to(dev, 0, 99, 20, 99, 80, 10, 0);
+	litest_touch_up(dev, 0);
+	litest_touch_down(dev, 0, 50, 99);
+	litest_timeout_softbuttons();
+	litest_touch_move_to(dev, 0, 50, 99, 80, 99, 10, 0);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_POINTER_MOTION);
+
+	/* removing a device without any timers, with a touch down */
+	second = litest_add_device(li, LITEST_ELANTECH_TOUCHPAD);
+	litest_drain_events(li);
+	litest_touch_down(second, 0, 99, 50);
+	libinput_dispatch(li);
+	litest_delete_device(second);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(touchpad_edge_scroll_lazy_timers_enable)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_device *device = dev->libinput_device;
+	struct litest_device *second;
+	double width = 0, height = 0;
+	double mm; /* one mm in percent of the device */
+
+	ck_assert_int_eq(libinput_device_get_size(device, &width, &height), 0);
+	mm = 100.0/height;
+
+	litest_disable_tap(device);
+	litest_drain_events(li);
+
+	/* First enable after init allocates the timers, enabling it again
+	 * keeps them */
+	ck_assert_int_eq(libinput_device_config_scroll_get_method(device),
+			 LIBINPUT_CONFIG_SCROLL_2FG);
+	litest_enable_edge_scroll(dev);
+	litest_enable_2fg_scroll(dev);
+	litest_enable_edge_scroll(dev);
+
+	/* the edge scroll lock timeout needs the timer */
+	litest_touch_down(dev, 0, 99, 20);
+	litest_touch_move_to(dev, 0, 99, 20, 99, 20 + mm/2, 8, 0);
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	litest_timeout_edgescroll();
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	litest_touch_move_to(dev, 0, 99, 20 + mm/2, 99, 20 + mm * 2, 20, 0);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+
+	litest_wait_for_event_of_type(li, LIBINPUT_EVENT_POINTER_AXIS, -1);
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_POINTER_AXIS);
+
+	/* removing a device with the timers allocated and armed */
+	second = litest_add_device(li, LITEST_ELANTECH_TOUCHPAD);
+	litest_enable_edge_scroll(second);
+	litest_drain_events(li);
+	litest_touch_down(second, 0, 99, 50);
+	libinput_dispatch(li);
+	litest_delete_device(second);
+	litest_drain_events(li);
+}
+END_TEST
+
 START_TEST(touchpad_edge_scroll_no_motion)
 {
 	struct litest_device *dev = litest_current_device();
@@ -977,6 +1150,40 @@ START_TEST(touchpad_palm_detect_at_edge)
 }
 END_TEST
 
+START_TEST(touchpad_palm_detect_at_edge_stats)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_device *device = dev->libinput_device;
+	uint64_t palms;
+
+	if (!touchpad_has_palm_detect_size(dev) ||
+	    !litest_has_2fg_scroll(dev))
+		return;
+
+	litest_enable_2fg_scroll(dev);
+	litest_disable_tap(device);
+	litest_drain_events(li);
+
+	palms = libinput_device_get_stats(device, LIBINPUT_STAT_PALM_TOUCHES);
+
+	/* one palm, however many frames it is detected in */
+	litest_touch_down(dev, 0, 99, 50);
+	litest_touch_move_to(dev, 0, 99, 50, 99, 70, 10, 0);
+	litest_touch_move_to(dev, 0, 99, 70, 99, 30, 10, 0);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+
+	litest_assert_empty_queue(li);
+	ck_assert_int_eq(libinput_device_get_stats(device,
+						   LIBINPUT_STAT_PALM_TOUCHES),
+			 palms + 1);
+	ck_assert_int_eq(libinput_device_get_stats(device,
+						   LIBINPUT_STAT_DWT_TOUCHES),
+			 0);
+}
+END_TEST
+
 START_TEST(touchpad_no_palm_detect_at_edge_for_edge_scrolling)
 {
 	struct litest_device *dev = litest_current_device();
@@ -2682,6 +2889,43 @@ START_TEST(touchpad_dwt)
 }
 END_TEST
 
+START_TEST(touchpad_dwt_key_events_disabled)
+{
+	struct litest_device *touchpad = litest_current_device();
+	struct litest_device *keyboard;
+	struct libinput *li = touchpad->libinput;
+
+	if (!has_disable_while_typing(touchpad))
+		return;
+
+	keyboard = dwt_init_paired_keyboard(li, touchpad);
+	litest_disable_tap(touchpad->libinput_device);
+	litest_drain_events(li);
+
+	/* The caller doesn't want key events, dwt still needs them */
+	libinput_set_event_type_enabled(li, LIBINPUT_EVENT_KEYBOARD_KEY, 0);
+
+	litest_keyboard_key(keyboard, KEY_A, true);
+	litest_keyboard_key(keyboard, KEY_A, false);
+	libinput_dispatch(li);
+	litest_touch_down(touchpad, 0, 50, 50);
+	litest_touch_move_to(touchpad, 0, 50, 50, 70, 50, 10, 1);
+	litest_touch_up(touchpad, 0);
+	litest_assert_empty_queue(li);
+
+	litest_timeout_dwt_short();
+	libinput_dispatch(li);
+
+	litest_touch_down(touchpad, 0, 50, 50);
+	litest_touch_move_to(touchpad, 0, 50, 50, 70, 50, 10, 1);
+	litest_touch_up(touchpad, 0);
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_POINTER_MOTION);
+
+	libinput_set_event_type_enabled(li, LIBINPUT_EVENT_KEYBOARD_KEY, 1);
+	litest_delete_device(keyboard);
+}
+END_TEST
+
 START_TEST(touchpad_dwt_update_keyboard)
 {
 	struct litest_device *touchpad = litest_current_device();
@@ -5027,6 +5271,8 @@ litest_setup_tests_touchpad(void)
 	struct range axis_range = {ABS_X, ABS_Y + 1};
 
 	litest_add("touchpad:motion", touchpad_1fg_motion, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("touchpad:motion", touchpad_1fg_motion_small, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("touchpad:motion", touchpad_1fg_motion_wobbling, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add("touchpad:motion", touchpad_2fg_no_motion, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
 
 	litest_add("touchpad:scroll", touchpad_2fg_scroll, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH|LITEST_SEMI_MT);
@@ -5047,6 +5293,8 @@ litest_setup_tests_touchpad(void)
 	litest_add("touchpad:scroll", touchpad_edge_scroll_no_motion, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add("touchpad:scroll", touchpad_edge_scroll_no_edge_after_motion, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add("touchpad:scroll", touchpad_edge_scroll_timeout, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add_for_device("touchpad:scroll", touchpad_edge_scroll_lazy_timers_unused, LITEST_ELANTECH_TOUCHPAD);
+	litest_add_for_device("touchpad:scroll", touchpad_edge_scroll_lazy_timers_enable, LITEST_ELANTECH_TOUCHPAD);
 	litest_add("touchpad:scroll", touchpad_edge_scroll_source, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add("touchpad:scroll", touchpad_edge_scroll_no_2fg, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
 	litest_add("touchpad:scroll", touchpad_edge_scroll_into_buttonareas, LITEST_CLICKPAD, LITEST_ANY);
@@ -5056,6 +5304,7 @@ litest_setup_tests_touchpad(void)
 	litest_add("touchpad:scroll", touchpad_edge_scroll_into_area, LITEST_TOUCHPAD, LITEST_ANY);
 
 	litest_add("touchpad:palm", touchpad_palm_detect_at_edge, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("touchpad:palm", touchpad_palm_detect_at_edge_stats, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add("touchpad:palm", touchpad_palm_detect_at_bottom_corners, LITEST_TOUCHPAD, LITEST_CLICKPAD);
 	litest_add("touchpad:palm", touchpad_palm_detect_at_top_corners, LITEST_TOUCHPAD, LITEST_TOPBUTTONPAD);
 	litest_add("touchpad:palm", touchpad_palm_detect_palm_becomes_pointer, LITEST_TOUCHPAD, LITEST_ANY);
@@ -5108,6 +5357,7 @@ litest_setup_tests_touchpad(void)
 	litest_add_ranged("touchpad:state", touchpad_initial_state, LITEST_TOUCHPAD, LITEST_ANY, &axis_range);
 
 	litest_add("touchpad:dwt", touchpad_dwt, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("touchpad:dwt", touchpad_dwt_key_events_disabled, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add_for_device("touchpad:dwt", touchpad_dwt_update_keyboard, LITEST_SYNAPTICS_I2C);
 	litest_add_for_device("touchpad:dwt", touchpad_dwt_update_keyboard_with_state, LITEST_SYNAPTICS_I2C);
 	litest_add("touchpad:dwt", touchpad_dwt_enable_touch, LITEST_TOUCHPAD, LITEST_ANY);
@@ -379,6 +379,54 @@ START_TEST(trackpoint_palmdetect_require_min_events)
 }
 END_TEST
 
+START_TEST(trackpoint_palmdetect_timerfd_updates)
+{
+	struct litest_device *trackpoint = litest_current_device();
+	struct litest_device *touchpad;
+	struct libinput *li = trackpoint->libinput;
+	uint64_t updates;
+	int i;
+
+	touchpad = litest_add_device(li, LITEST_SYNAPTICS_I2C);
+	litest_drain_events(li);
+
+	updates = libinput_get_stats(li, LIBINPUT_STAT_TIMERFD_UPDATES);
+
+	/* One second of trackpoint motion at 100Hz. Every event pushes
+	 * the palm detection timeout forward but that must not require a
+	 * timerfd update each time, only once per timeout. */
+	for (i = 0; i < 100; i++) {
+		litest_event(trackpoint, EV_REL, REL_X, 1);
+		litest_event(trackpoint, EV_REL, REL_Y, 1);
+		litest_event(trackpoint, EV_SYN, SYN_REPORT, 0);
+		libinput_dispatch(li);
+		msleep(10);
+	}
+	litest_drain_events(li);
+
+	ck_assert_int_lt(libinput_get_stats(li,
+					    LIBINPUT_STAT_TIMERFD_UPDATES) -
+			 updates,
+			 10);
+
+	/* still within the timeout of the last event */
+	litest_touch_down(touchpad, 0, 30, 30);
+	litest_touch_move_to(touchpad, 0, 30, 30, 80, 80, 10, 1);
+	litest_touch_up(touchpad, 0);
+	litest_assert_empty_queue(li);
+
+	litest_timeout_trackpoint();
+	libinput_dispatch(li);
+
+	litest_touch_down(touchpad, 0, 30, 30);
+	litest_touch_move_to(touchpad, 0, 30, 30, 80, 80, 10, 1);
+	litest_touch_up(touchpad, 0);
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_POINTER_MOTION);
+
+	litest_delete_device(touchpad);
+}
+END_TEST
+
 void
 litest_setup_tests_trackpoint(void)
 {
@@ -393,4 +441,5 @@ litest_setup_tests_trackpoint(void)
 	litest_add("trackpoint:palmdetect", trackpoint_palmdetect, LITEST_POINTINGSTICK, LITEST_ANY);
 	litest_add("trackpoint:palmdetect", trackpoint_palmdetect_resume_touch, LITEST_POINTINGSTICK, LITEST_ANY);
 	litest_add("trackpoint:palmdetect", trackpoint_palmdetect_require_min_events, LITEST_POINTINGSTICK, LITEST_ANY);
+	litest_add("trackpoint:palmdetect", trackpoint_palmdetect_timerfd_updates, LITEST_POINTINGSTICK, LITEST_ANY);
 }
@@ -26,7 +26,9 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <fcntl.h>
+#include <math.h>
 #include <poll.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <signal.h>
 #include <string.h>
@@ -37,6 +39,7 @@
 #include <sys/ioctl.h>
 
 #include <libinput.h>
+#include <libinput-util.h>
 #include <libevdev/libevdev.h>
 
 #include "shared.h"
@@ -50,98 +53,78 @@ static bool be_quiet = false;
 
 #define printq(...) ({ if (!be_quiet)  printf(__VA_ARGS__); })
 
-static void
-print_event_header(struct libinput_event *ev)
+static const char *
+event_type_to_str(enum libinput_event_type type)
 {
-	/* use for pointer value only, do not dereference */
-	static void *last_device = NULL;
-	struct libinput_device *dev = libinput_event_get_device(ev);
-	const char *type = NULL;
-	char prefix;
-
-	switch(libinput_event_get_type(ev)) {
+	switch (type) {
 	case LIBINPUT_EVENT_NONE:
 		abort();
 	case LIBINPUT_EVENT_DEVICE_ADDED:
-		type = "DEVICE_ADDED";
-		break;
+		return "DEVICE_ADDED";
 	case LIBINPUT_EVENT_DEVICE_REMOVED:
-		type = "DEVICE_REMOVED";
-		break;
+		return "DEVICE_REMOVED";
 	case LIBINPUT_EVENT_KEYBOARD_KEY:
-		type = "KEYBOARD_KEY";
-		break;
+		return "KEYBOARD_KEY";
 	case LIBINPUT_EVENT_POINTER_MOTION:
-		type = "POINTER_MOTION";
-		break;
+		return "POINTER_MOTION";
 	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
-		type = "POINTER_MOTION_ABSOLUTE";
-		break;
+		return "POINTER_MOTION_ABSOLUTE";
 	case LIBINPUT_EVENT_POINTER_BUTTON:
-		type = "POINTER_BUTTON";
-		break;
+		return "POINTER_BUTTON";
 	case LIBINPUT_EVENT_POINTER_AXIS:
-		type = "POINTER_AXIS";
-		break;
+		return "POINTER_AXIS";
 	case LIBINPUT_EVENT_TOUCH_DOWN:
-		type = "TOUCH_DOWN";
-		break;
+		return "TOUCH_DOWN";
 	case LIBINPUT_EVENT_TOUCH_MOTION:
-		type = "TOUCH_MOTION";
-		break;
+		return "TOUCH_MOTION";
 	case LIBINPUT_EVENT_TOUCH_UP:
-		type = "TOUCH_UP";
-		break;
+		return "TOUCH_UP";
 	case LIBINPUT_EVENT_TOUCH_CANCEL:
-		type = "TOUCH_CANCEL";
-		break;
+		return "TOUCH_CANCEL";
 	case LIBINPUT_EVENT_TOUCH_FRAME:
-		type = "TOUCH_FRAME";
-		break;
+		return "TOUCH_FRAME";
 	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
-		type = "GESTURE_SWIPE_BEGIN";
-		break;
+		return "GESTURE_SWIPE_BEGIN";
 	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
-		type = "GESTURE_SWIPE_UPDATE";
-		break;
+		return "GESTURE_SWIPE_UPDATE";
 	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
-		type = "GESTURE_SWIPE_END";
-		break;
+		return "GESTURE_SWIPE_END";
 	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
-		type = "GESTURE_PINCH_BEGIN";
-		break;
+		return "GESTURE_PINCH_BEGIN";
 	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
-		type = "GESTURE_PINCH_UPDATE";
-		break;
+		return "GESTURE_PINCH_UPDATE";
 	case LIBINPUT_EVENT_GESTURE_PINCH_END:
-		type = "GESTURE_PINCH_END";
-		break;
+		return "GESTURE_PINCH_END";
 	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
-		type = "TABLET_TOOL_AXIS";
-		break;
+		return "TABLET_TOOL_AXIS";
 	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
-		type = "TABLET_TOOL_PROXIMITY";
-		break;
+		return "TABLET_TOOL_PROXIMITY";
 	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
-		type = "TABLET_TOOL_TIP";
-		break;
+		return "TABLET_TOOL_TIP";
 	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
-		type = "TABLET_TOOL_BUTTON";
-		break;
+		return "TABLET_TOOL_BUTTON";
 	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
-		type = "TABLET_PAD_BUTTON";
-		break;
+		return "TABLET_PAD_BUTTON";
 	case LIBINPUT_EVENT_TABLET_PAD_RING:
-		type = "TABLET_PAD_RING";
-		break;
+		return "TABLET_PAD_RING";
 	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
-		type = "TABLET_PAD_STRIP";
-		break;
+		return "TABLET_PAD_STRIP";
 	case LIBINPUT_EVENT_SWITCH_TOGGLE:
-		type = "SWITCH_TOGGLE";
-		break;
+		return "SWITCH_TOGGLE";
 	}
 
+	return NULL;
+}
+
+static void
+print_event_header(struct libinput_event *ev)
+{
+	/* use for pointer value only, do not dereference */
+	static void *last_device = NULL;
+	struct libinput_device *dev = libinput_event_get_device(ev);
+	const char *type = event_type_to_str(libinput_event_get_type(ev));
+	char prefix;
+
 	prefix = (last_device != dev) ? '-' : ' ';
 
 	printq("%c%-7s  %-16s ",
@@ -760,6 +743,406 @@ print_switch_event(struct libinput_event *ev)
 	printq("switch %s state %d\n", which, state);
 }
 
+/* JSON lines output: one object per event, built in a local buffer and
+ * written with a single fwrite into a fully buffered stdout. stdout is
+ * flushed every json_flush_ms, see mainloop(). All values are the raw
+ * ones as returned by libinput, times are the event times in us.
+ */
+struct json_line {
+	char buf[1024];
+	size_t len;
+};
+
+LIBINPUT_ATTRIBUTE_PRINTF(2, 3)
+static void
+json_append(struct json_line *line, const char *format, ...)
+{
+	va_list args;
+	int n;
+
+	if (line->len >= sizeof(line->buf))
+		return;
+
+	va_start(args, format);
+	n = vsnprintf(line->buf + line->len,
+		      sizeof(line->buf) - line->len,
+		      format,
+		      args);
+	va_end(args);
+
+	/* on overflow len stays at the buffer size, the event is dropped */
+	if (n > 0)
+		line->len = min(line->len + n, sizeof(line->buf));
+}
+
+static void
+json_string(struct json_line *line, const char *key, const char *str)
+{
+	json_append(line, ",\"%s\":\"", key);
+
+	for (; str && *str; str++) {
+		unsigned char c = *str;
+
+		if (c == '"' || c == '\\')
+			json_append(line, "\\%c", c);
+		else if (c < 0x20)
+			json_append(line, "\\u%04x", c);
+		else
+			json_append(line, "%c", c);
+	}
+
+	json_append(line, "\"");
+}
+
+static inline void
+json_int(struct json_line *line, const char *key, int64_t value)
+{
+	json_append(line, ",\"%s\":%" PRId64, key, value);
+}
+
+static inline void
+json_double(struct json_line *line, const char *key, double value)
+{
+	/* JSON has no nan or inf */
+	if (!isfinite(value))
+		json_append(line, ",\"%s\":null", key);
+	else
+		json_append(line, ",\"%s\":%.9g", key, value);
+}
+
+static void
+json_keyboard_event(struct json_line *line, struct libinput_event *ev)
+{
+	struct libinput_event_keyboard *k = libinput_event_get_keyboard_event(ev);
+	uint32_t key = libinput_event_keyboard_get_key(k);
+	int64_t code = key;
+
+	if (!context.options.show_keycodes &&
+	    (key >= KEY_ESC && key < KEY_ZENKAKUHANKAKU))
+		code = -1;
+
+	json_int(line, "time", libinput_event_keyboard_get_time_usec(k));
+	json_int(line, "key", code);
+	json_int(line, "state", libinput_event_keyboard_get_key_state(k));
+}
+
+static void
+json_pointer_event(struct json_line *line, struct libinput_event *ev)
+{
+	struct libinput_event_pointer *p = libinput_event_get_pointer_event(ev);
+	enum libinput_pointer_axis axis;
+	double value, discrete;
+
+	json_int(line, "time", libinput_event_pointer_get_time_usec(p));
+
+	switch (libinput_event_get_type(ev)) {
+	case LIBINPUT_EVENT_POINTER_MOTION:
+		json_double(line, "dx", libinput_event_pointer_get_dx(p));
+		json_double(line, "dy", libinput_event_pointer_get_dy(p));
+		json_double(line,
+			    "dx_unaccel",
+			    libinput_event_pointer_get_dx_unaccelerated(p));
+		json_double(line,
+			    "dy_unaccel",
+			    libinput_event_pointer_get_dy_unaccelerated(p));
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+		json_double(line, "x", libinput_event_pointer_get_absolute_x(p));
+		json_double(line, "y", libinput_event_pointer_get_absolute_y(p));
+		break;
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+		json_int(line, "button", libinput_event_pointer_get_button(p));
+		json_int(line,
+			 "state",
+			 libinput_event_pointer_get_button_state(p));
+		json_int(line,
+			 "seat_count",
+			 libinput_event_pointer_get_seat_button_count(p));
+		break;
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		json_int(line,
+			 "source",
+			 libinput_event_pointer_get_axis_source(p));
+		axis = LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL;
+		if (libinput_event_pointer_has_axis(p, axis)) {
+			value = libinput_event_pointer_get_axis_value(p, axis);
+			discrete = libinput_event_pointer_get_axis_value_discrete(
+								p, axis);
+			json_double(line, "vert", value);
+			json_double(line, "vert_discrete", discrete);
+		}
+		axis = LIBINPUT_POINTER_AXIS_SCROLL_HORIZONTAL;
+		if (libinput_event_pointer_has_axis(p, axis)) {
+			value = libinput_event_pointer_get_axis_value(p, axis);
+			discrete = libinput_event_pointer_get_axis_value_discrete(
+								p, axis);
+			json_double(line, "horiz", value);
+			json_double(line, "horiz_discrete", discrete);
+		}
+		break;
+	default:
+		abort();
+	}
+}
+
+static void
+json_touch_event(struct json_line *line, struct libinput_event *ev)
+{
+	struct libinput_event_touch *t = libinput_event_get_touch_event(ev);
+	enum libinput_event_type type = libinput_event_get_type(ev);
+
+	json_int(line, "time", libinput_event_touch_get_time_usec(t));
+
+	if (type == LIBINPUT_EVENT_TOUCH_FRAME)
+		return;
+
+	json_int(line, "slot", libinput_event_touch_get_slot(t));
+	json_int(line, "seat_slot", libinput_event_touch_get_seat_slot(t));
+
+	if (type == LIBINPUT_EVENT_TOUCH_DOWN ||
+	    type == LIBINPUT_EVENT_TOUCH_MOTION) {
+		json_double(line, "x", libinput_event_touch_get_x(t));
+		json_double(line, "y", libinput_event_touch_get_y(t));
+	}
+}
+
+static void
+json_gesture_event(struct json_line *line, struct libinput_event *ev)
+{
+	struct libinput_event_gesture *g = libinput_event_get_gesture_event(ev);
+
+	json_int(line, "time", libinput_event_gesture_get_time_usec(g));
+	json_int(line, "fingers", libinput_event_gesture_get_finger_count(g));
+
+	switch (libinput_event_get_type(ev)) {
+	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
+	case LIBINPUT_EVENT_GESTURE_PINCH_END:
+		json_int(line,
+			 "cancelled",
+			 libinput_event_gesture_get_cancelled(g));
+		break;
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+		json_double(line, "scale", libinput_event_gesture_get_scale(g));
+		json_double(line,
+			    "angle_delta",
+			    libinput_event_gesture_get_angle_delta(g));
+		/* fallthrough */
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+		json_double(line, "dx", libinput_event_gesture_get_dx(g));
+		json_double(line, "dy", libinput_event_gesture_get_dy(g));
+		json_double(line,
+			    "dx_unaccel",
+			    libinput_event_gesture_get_dx_unaccelerated(g));
+		json_double(line,
+			    "dy_unaccel",
+			    libinput_event_gesture_get_dy_unaccelerated(g));
+		break;
+	default:
+		break;
+	}
+}
+
+static void
+json_tablet_tool_event(struct json_line *line, struct libinput_event *ev)
+{
+	struct libinput_event_tablet_tool *t =
+		libinput_event_get_tablet_tool_event(ev);
+	struct libinput_tablet_tool *tool = libinput_event_tablet_tool_get_tool(t);
+
+	json_int(line, "time", libinput_event_tablet_tool_get_time_usec(t));
+	json_int(line, "tool_type", libinput_tablet_tool_get_type(tool));
+	json_int(line, "tool_serial", libinput_tablet_tool_get_serial(tool));
+	json_int(line, "tool_id", libinput_tablet_tool_get_tool_id(tool));
+
+	switch (libinput_event_get_type(ev)) {
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+		json_int(line,
+			 "proximity",
+			 libinput_event_tablet_tool_get_proximity_state(t));
+		break;
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+		json_int(line,
+			 "tip",
+			 libinput_event_tablet_tool_get_tip_state(t));
+		break;
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		json_int(line,
+			 "button",
+			 libinput_event_tablet_tool_get_button(t));
+		json_int(line,
+			 "state",
+			 libinput_event_tablet_tool_get_button_state(t));
+		json_int(line,
+			 "seat_count",
+			 libinput_event_tablet_tool_get_seat_button_count(t));
+		break;
+	default:
+		break;
+	}
+
+	json_double(line, "x", libinput_event_tablet_tool_get_x(t));
+	json_double(line, "y", libinput_event_tablet_tool_get_y(t));
+	json_double(line, "dx", libinput_event_tablet_tool_get_dx(t));
+	json_double(line, "dy", libinput_event_tablet_tool_get_dy(t));
+
+	if (libinput_tablet_tool_has_pressure(tool))
+		json_double(line,
+			    "pressure",
+			    libinput_event_tablet_tool_get_pressure(t));
+	if (libinput_tablet_tool_has_distance(tool))
+		json_double(line,
+			    "distance",
+			    libinput_event_tablet_tool_get_distance(t));
+	if (libinput_tablet_tool_has_tilt(tool)) {
+		json_double(line,
+			    "tilt_x",
+			    libinput_event_tablet_tool_get_tilt_x(t));
+		json_double(line,
+			    "tilt_y",
+			    libinput_event_tablet_tool_get_tilt_y(t));
+	}
+	if (libinput_tablet_tool_has_rotation(tool))
+		json_double(line,
+			    "rotation",
+			    libinput_event_tablet_tool_get_rotation(t));
+	if (libinput_tablet_tool_has_slider(tool))
+		json_double(line,
+			    "slider",
+			    libinput_event_tablet_tool_get_slider_position(t));
+	if (libinput_tablet_tool_has_wheel(tool)) {
+		json_double(line,
+			    "wheel",
+			    libinput_event_tablet_tool_get_wheel_delta(t));
+		json_int(line,
+			 "wheel_discrete",
+			 libinput_event_tablet_tool_get_wheel_delta_discrete(t));
+	}
+}
+
+static void
+json_tablet_pad_event(struct json_line *line, struct libinput_event *ev)
+{
+	struct libinput_event_tablet_pad *p =
+		libinput_event_get_tablet_pad_event(ev);
+
+	json_int(line, "time", libinput_event_tablet_pad_get_time_usec(p));
+	json_int(line, "mode", libinput_event_tablet_pad_get_mode(p));
+
+	switch (libinput_event_get_type(ev)) {
+	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
+		json_int(line,
+			 "button",
+			 libinput_event_tablet_pad_get_button_number(p));
+		json_int(line,
+			 "state",
+			 libinput_event_tablet_pad_get_button_state(p));
+		break;
+	case LIBINPUT_EVENT_TABLET_PAD_RING:
+		json_int(line,
+			 "ring",
+			 libinput_event_tablet_pad_get_ring_number(p));
+		json_double(line,
+			    "position",
+			    libinput_event_tablet_pad_get_ring_position(p));
+		json_int(line,
+			 "source",
+			 libinput_event_tablet_pad_get_ring_source(p));
+		break;
+	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
+		json_int(line,
+			 "strip",
+			 libinput_event_tablet_pad_get_strip_number(p));
+		json_double(line,
+			    "position",
+			    libinput_event_tablet_pad_get_strip_position(p));
+		json_int(line,
+			 "source",
+			 libinput_event_tablet_pad_get_strip_source(p));
+		break;
+	default:
+		abort();
+	}
+}
+
+static void
+json_switch_event(struct json_line *line, struct libinput_event *ev)
+{
+	struct libinput_event_switch *sw = libinput_event_get_switch_event(ev);
+
+	json_int(line, "time", libinput_event_switch_get_time_usec(sw));
+	json_int(line, "switch", libinput_event_switch_get_switch(sw));
+	json_int(line, "state", libinput_event_switch_get_switch_state(sw));
+}
+
+static void
+print_json_event(struct libinput_event *ev)
+{
+	struct libinput_device *dev = libinput_event_get_device(ev);
+	enum libinput_event_type type = libinput_event_get_type(ev);
+	struct json_line line;
+
+	line.len = 0;
+	json_append(&line, "{\"type\":\"%s\"", event_type_to_str(type));
+	json_string(&line, "device", libinput_device_get_sysname(dev));
+
+	switch (type) {
+	case LIBINPUT_EVENT_NONE:
+		abort();
+	case LIBINPUT_EVENT_DEVICE_ADDED:
+	case LIBINPUT_EVENT_DEVICE_REMOVED:
+		json_string(&line, "name", libinput_device_get_name(dev));
+		break;
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		json_keyboard_event(&line, ev);
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION:
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		json_pointer_event(&line, ev);
+		break;
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		json_touch_event(&line, ev);
+		break;
+	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
+	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_PINCH_END:
+		json_gesture_event(&line, ev);
+		break;
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		json_tablet_tool_event(&line, ev);
+		break;
+	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
+	case LIBINPUT_EVENT_TABLET_PAD_RING:
+	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
+		json_tablet_pad_event(&line, ev);
+		break;
+	case LIBINPUT_EVENT_SWITCH_TOGGLE:
+		json_switch_event(&line, ev);
+		break;
+	}
+
+	json_append(&line, "}\n");
+
+	if (line.len >= sizeof(line.buf)) {
+		fprintf(stderr, "%s event too long, dropped\n",
+			event_type_to_str(type));
+		return;
+	}
+
+	fwrite(line.buf, 1, line.len, stdout);
+}
+
 static int
 handle_and_print_events(struct libinput *li)
 {
@@ -768,6 +1151,19 @@ handle_and_print_events(struct libinput *li)
 
 	libinput_dispatch(li);
 	while ((ev = libinput_get_event(li))) {
+		if (context.options.json_flush_ms) {
+			print_json_event(ev);
+			if (libinput_event_get_type(ev) ==
+			    LIBINPUT_EVENT_DEVICE_ADDED)
+				tools_device_apply_config(
+					  libinput_event_get_device(ev),
+					  &context.options);
+			libinput_event_destroy(ev);
+			libinput_dispatch(li);
+			rc = 0;
+			continue;
+		}
+
 		print_event_header(ev);
 
 		switch (libinput_event_get_type(ev)) {
@@ -860,17 +1256,391 @@ handle_and_print_events(struct libinput *li)
 	return rc;
 }
 
+static void
+print_stats(struct libinput *li)
+{
+	static const struct {
+		enum libinput_stat stat;
+		const char *name;
+	} stats[] = {
+		{ LIBINPUT_STAT_KERNEL_EVENTS, "kernel events" },
+		{ LIBINPUT_STAT_FRAMES, "frames" },
+		{ LIBINPUT_STAT_SYN_DROPPED, "SYN_DROPPED" },
+		{ LIBINPUT_STAT_EVENTS_POSTED, "events posted" },
+		{ LIBINPUT_STAT_PALM_TOUCHES, "palm touches" },
+		{ LIBINPUT_STAT_THUMB_TOUCHES, "thumb touches" },
+		{ LIBINPUT_STAT_DWT_TOUCHES, "dwt touches" },
+		{ LIBINPUT_STAT_TIMERS_ARMED, "timers armed" },
+		{ LIBINPUT_STAT_TIMERS_FIRED, "timers fired" },
+		{ LIBINPUT_STAT_QUEUE_PEAK, "queue peak" },
+		{ LIBINPUT_STAT_DISPATCH_TIME_US, "dispatch time (us)" },
+		{ LIBINPUT_STAT_TIMER_WAKEUPS, "timer wakeups" },
+		{ LIBINPUT_STAT_TIMERFD_UPDATES, "timerfd updates" },
+	};
+	static const struct {
+		enum libinput_event_type type;
+		const char *name;
+	} types[] = {
+		{ LIBINPUT_EVENT_DEVICE_ADDED, "DEVICE_ADDED" },
+		{ LIBINPUT_EVENT_DEVICE_REMOVED, "DEVICE_REMOVED" },
+		{ LIBINPUT_EVENT_KEYBOARD_KEY, "KEYBOARD_KEY" },
+		{ LIBINPUT_EVENT_POINTER_MOTION, "POINTER_MOTION" },
+		{ LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE, "POINTER_MOTION_ABSOLUTE" },
+		{ LIBINPUT_EVENT_POINTER_BUTTON, "POINTER_BUTTON" },
+		{ LIBINPUT_EVENT_POINTER_AXIS, "POINTER_AXIS" },
+		{ LIBINPUT_EVENT_TOUCH_DOWN, "TOUCH_DOWN" },
+		{ LIBINPUT_EVENT_TOUCH_UP, "TOUCH_UP" },
+		{ LIBINPUT_EVENT_TOUCH_MOTION, "TOUCH_MOTION" },
+		{ LIBINPUT_EVENT_TOUCH_CANCEL, "TOUCH_CANCEL" },
+		{ LIBINPUT_EVENT_TOUCH_FRAME, "TOUCH_FRAME" },
+		{ LIBINPUT_EVENT_TABLET_TOOL_AXIS, "TABLET_TOOL_AXIS" },
+		{ LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY, "TABLET_TOOL_PROXIMITY" },
+		{ LIBINPUT_EVENT_TABLET_TOOL_TIP, "TABLET_TOOL_TIP" },
+		{ LIBINPUT_EVENT_TABLET_TOOL_BUTTON, "TABLET_TOOL_BUTTON" },
+		{ LIBINPUT_EVENT_TABLET_PAD_BUTTON, "TABLET_PAD_BUTTON" },
+		{ LIBINPUT_EVENT_TABLET_PAD_RING, "TABLET_PAD_RING" },
+		{ LIBINPUT_EVENT_TABLET_PAD_STRIP, "TABLET_PAD_STRIP" },
+		{ LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN, "GESTURE_SWIPE_BEGIN" },
+		{ LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE, "GESTURE_SWIPE_UPDATE" },
+		{ LIBINPUT_EVENT_GESTURE_SWIPE_END, "GESTURE_SWIPE_END" },
+		{ LIBINPUT_EVENT_GESTURE_PINCH_BEGIN, "GESTURE_PINCH_BEGIN" },
+		{ LIBINPUT_EVENT_GESTURE_PINCH_UPDATE, "GESTURE_PINCH_UPDATE" },
+		{ LIBINPUT_EVENT_GESTURE_PINCH_END, "GESTURE_PINCH_END" },
+		{ LIBINPUT_EVENT_SWITCH_TOGGLE, "SWITCH_TOGGLE" },
+	};
+	size_t i;
+	/* keep the JSON stream parseable */
+	FILE *out = context.options.json_flush_ms ? stderr : stdout;
+
+	fprintf(out, "-------------------- stats --------------------\n");
+	for (i = 0; i < sizeof(stats)/sizeof(stats[0]); i++)
+		fprintf(out, "%-24s %" PRIu64 "\n",
+			stats[i].name,
+			libinput_get_stats(li, stats[i].stat));
+
+	for (i = 0; i < sizeof(types)/sizeof(types[0]); i++) {
+		uint64_t count = libinput_get_event_stats(li, types[i].type);
+
+		if (count > 0)
+			fprintf(out, "  %-22s %" PRIu64 "\n",
+				types[i].name,
+				count);
+	}
+	fprintf(out, "-----------------------------------------------\n");
+}
+
+/* Dispatch profiler: times every libinput_dispatch() call and the time
+ * between the kernel timestamp of an event and its retrieval. Samples are
+ * collected per interval and printed as a table every profile_interval
+ * seconds, then reset.
+ */
+struct profile_samples {
+	uint32_t *values; /* in us */
+	size_t count;
+	size_t size;
+	uint64_t sum;
+};
+
+struct profile_device {
+	struct profile_device *next;
+	struct libinput_device *device;
+	char *sysname;
+	struct profile_samples latency;
+	unsigned int batch; /* events in the current dispatch batch */
+	unsigned int queue_max;
+};
+
+static struct {
+	struct profile_samples dispatch;
+	struct profile_device *devices;
+	unsigned int queue_max;
+	uint64_t interval_start;
+} profile;
+
+static uint64_t
+now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+profile_samples_add(struct profile_samples *s, uint64_t us)
+{
+	if (s->count == s->size) {
+		size_t size = s->size ? s->size * 2 : 1024;
+		uint32_t *values = realloc(s->values, size * sizeof(*values));
+
+		if (!values)
+			return;
+		s->values = values;
+		s->size = size;
+	}
+
+	s->values[s->count++] = min(us, UINT32_MAX);
+	s->sum += us;
+}
+
+static int
+cmp_uint32(const void *a, const void *b)
+{
+	uint32_t ua = *(const uint32_t*)a,
+		 ub = *(const uint32_t*)b;
+
+	return ua < ub ? -1 : ua > ub;
+}
+
+/* Sorts the samples, returns the mean and sets p99 and max */
+static uint64_t
+profile_samples_evaluate(struct profile_samples *s,
+			 uint32_t *p99,
+			 uint32_t *max)
+{
+	*p99 = 0;
+	*max = 0;
+
+	if (s->count == 0)
+		return 0;
+
+	qsort(s->values, s->count, sizeof(*s->values), cmp_uint32);
+	*p99 = s->values[(s->count - 1) * 99 / 100];
+	*max = s->values[s->count - 1];
+
+	return s->sum / s->count;
+}
+
+static inline void
+profile_samples_reset(struct profile_samples *s)
+{
+	s->count = 0;
+	s->sum = 0;
+}
+
+static uint64_t
+event_get_time_usec(struct libinput_event *ev)
+{
+	switch (libinput_event_get_type(ev)) {
+	case LIBINPUT_EVENT_NONE:
+	case LIBINPUT_EVENT_DEVICE_ADDED:
+	case LIBINPUT_EVENT_DEVICE_REMOVED:
+		return 0;
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		return libinput_event_keyboard_get_time_usec(
+				libinput_event_get_keyboard_event(ev));
+	case LIBINPUT_EVENT_POINTER_MOTION:
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		return libinput_event_pointer_get_time_usec(
+				libinput_event_get_pointer_event(ev));
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		return libinput_event_touch_get_time_usec(
+				libinput_event_get_touch_event(ev));
+	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
+	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_PINCH_END:
+		return libinput_event_gesture_get_time_usec(
+				libinput_event_get_gesture_event(ev));
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		return libinput_event_tablet_tool_get_time_usec(
+				libinput_event_get_tablet_tool_event(ev));
+	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
+	case LIBINPUT_EVENT_TABLET_PAD_RING:
+	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
+		return libinput_event_tablet_pad_get_time_usec(
+				libinput_event_get_tablet_pad_event(ev));
+	case LIBINPUT_EVENT_SWITCH_TOGGLE:
+		return libinput_event_switch_get_time_usec(
+				libinput_event_get_switch_event(ev));
+	}
+
+	return 0;
+}
+
+static void
+profile_device_added(struct libinput_device *device)
+{
+	struct profile_device *pd;
+
+	pd = calloc(1, sizeof(*pd));
+	if (!pd)
+		return;
+
+	pd->device = device;
+	pd->sysname = strdup(libinput_device_get_sysname(device));
+	pd->next = profile.devices;
+	profile.devices = pd;
+	libinput_device_set_user_data(device, pd);
+}
+
+static void
+profile_device_removed(struct libinput_device *device)
+{
+	struct profile_device **pd = &profile.devices;
+
+	while (*pd) {
+		struct profile_device *d = *pd;
+
+		if (d->device == device) {
+			*pd = d->next;
+			free(d->latency.values);
+			free(d->sysname);
+			free(d);
+			break;
+		}
+		pd = &d->next;
+	}
+
+	libinput_device_set_user_data(device, NULL);
+}
+
+static int
+handle_and_profile_events(struct libinput *li)
+{
+	int rc = -1;
+	struct libinput_event *ev;
+	struct profile_device *pd;
+	uint64_t start, now;
+	unsigned int batch = 0;
+
+	start = now_us();
+	libinput_dispatch(li);
+	profile_samples_add(&profile.dispatch, now_us() - start);
+
+	while ((ev = libinput_get_event(li))) {
+		struct libinput_device *device = libinput_event_get_device(ev);
+		uint64_t time;
+
+		switch (libinput_event_get_type(ev)) {
+		case LIBINPUT_EVENT_DEVICE_ADDED:
+			tools_device_apply_config(device, &context.options);
+			profile_device_added(device);
+			break;
+		case LIBINPUT_EVENT_DEVICE_REMOVED:
+			profile_device_removed(device);
+			break;
+		default:
+			pd = libinput_device_get_user_data(device);
+			if (!pd)
+				break;
+
+			now = now_us();
+			time = event_get_time_usec(ev);
+			if (time && now >= time)
+				profile_samples_add(&pd->latency, now - time);
+			pd->batch++;
+			batch++;
+			break;
+		}
+
+		libinput_event_destroy(ev);
+		rc = 0;
+	}
+
+	profile.queue_max = max(profile.queue_max, batch);
+	for (pd = profile.devices; pd; pd = pd->next) {
+		pd->queue_max = max(pd->queue_max, pd->batch);
+		pd->batch = 0;
+	}
+
+	return rc;
+}
+
+static void
+print_profile(void)
+{
+	struct profile_device *pd;
+	uint64_t now = now_us();
+	double elapsed = (now - profile.interval_start) / 1000000.0;
+	uint64_t mean;
+	uint32_t p99, max;
+
+	mean = profile_samples_evaluate(&profile.dispatch, &p99, &max);
+	printf("dispatch: %zu calls, mean %" PRIu64 "us, p99 %uus, max %uus, "
+	       "queue max %u\n",
+	       profile.dispatch.count,
+	       mean,
+	       p99,
+	       max,
+	       profile.queue_max);
+	profile_samples_reset(&profile.dispatch);
+	profile.queue_max = 0;
+
+	printf("%-10s %10s %12s %12s %12s %6s\n",
+	       "device",
+	       "events/s",
+	       "latency",
+	       "p99",
+	       "max",
+	       "queue");
+	for (pd = profile.devices; pd; pd = pd->next) {
+		mean = profile_samples_evaluate(&pd->latency, &p99, &max);
+		printf("%-10s %10.1f %10" PRIu64 "us %10uus %10uus %6u\n",
+		       pd->sysname,
+		       elapsed > 0 ? pd->latency.count / elapsed : 0,
+		       mean,
+		       p99,
+		       max,
+		       pd->queue_max);
+		profile_samples_reset(&pd->latency);
+		pd->queue_max = 0;
+	}
+	printf("\n");
+	fflush(stdout);
+
+	profile.interval_start = now;
+}
+
+static void
+profile_destroy(void)
+{
+	while (profile.devices) {
+		struct profile_device *pd = profile.devices;
+
+		profile.devices = pd->next;
+		free(pd->latency.values);
+		free(pd->sysname);
+		free(pd);
+	}
+	free(profile.dispatch.values);
+}
+
 static void
 sighandler(int signal, siginfo_t *siginfo, void *userdata)
 {
 	stop = 1;
 }
 
+static inline uint64_t
+now_ms(void)
+{
+	return now_us() / 1000;
+}
+
 static void
 mainloop(struct libinput *li)
 {
 	struct pollfd fds;
 	struct sigaction act;
+	uint64_t stats_interval = context.options.stats_interval * 1000;
+	uint64_t flush_interval = context.options.json_flush_ms;
+	uint64_t profile_interval = context.options.profile_interval * 1000;
+	uint64_t now, next_stats = 0, next_flush = 0, next_profile = 0;
+	int timeout = -1;
+	int (*handle_events)(struct libinput *li) = handle_and_print_events;
 
 	fds.fd = libinput_get_fd(li);
 	fds.events = POLLIN;
@@ -886,13 +1656,64 @@ mainloop(struct libinput *li)
 		return;
 	}
 
+	if (profile_interval) {
+		handle_events = handle_and_profile_events;
+		profile.interval_start = now_us();
+	}
+
 	/* Handle already-pending device added events */
-	if (handle_and_print_events(li))
+	if (handle_events(li))
 		fprintf(stderr, "Expected device added events on startup but got none. "
 				"Maybe you don't have the right permissions?\n");
 
-	while (!stop && poll(&fds, 1, -1) > -1)
-		handle_and_print_events(li);
+	now = now_ms();
+	if (stats_interval)
+		next_stats = now + stats_interval;
+	if (flush_interval)
+		next_flush = now + flush_interval;
+	if (profile_interval)
+		next_profile = now + profile_interval;
+
+	while (!stop) {
+		if (stats_interval || flush_interval || profile_interval) {
+			uint64_t next = UINT64_MAX;
+
+			if (stats_interval)
+				next = min(next, next_stats);
+			if (flush_interval)
+				next = min(next, next_flush);
+			if (profile_interval)
+				next = min(next, next_profile);
+			timeout = next > now ? next - now : 0;
+		}
+
+		if (poll(&fds, 1, timeout) < 0)
+			break;
+
+		handle_events(li);
+
+		now = now_ms();
+		if (stats_interval && now >= next_stats) {
+			print_stats(li);
+			next_stats = now + stats_interval;
+		}
+		if (flush_interval && now >= next_flush) {
+			fflush(stdout);
+			next_flush = now + flush_interval;
+		}
+		if (profile_interval && now >= next_profile) {
+			print_profile();
+			next_profile = now + profile_interval;
+		}
+	}
+
+	if (stats_interval)
+		print_stats(li);
+	if (profile_interval) {
+		print_profile();
+		profile_destroy();
+	}
+	fflush(stdout);
 }
 
 int
@@ -911,6 +1732,10 @@ main(int argc, char **argv)
 
 	be_quiet = context.options.quiet;
 
+	/* we flush manually every json_flush_ms */
+	if (context.options.json_flush_ms)
+		setvbuf(stdout, NULL, _IOFBF, 256 * 1024);
+
 	li = tools_open_backend(&context);
 	if (!li)
 		return 1;
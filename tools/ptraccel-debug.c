@@ -148,6 +148,218 @@ mmps_to_upus(double mmps, int dpi)
 	return mmps * (dpi/25.4) / 1e6;
 }
 
+static struct motion_filter *
+create_filter(const char *filter_type,
+	      int dpi,
+	      double speed,
+	      accel_profile_func_t *profile)
+{
+	struct motion_filter *filter;
+
+	if (streq(filter_type, "linear")) {
+		filter = create_pointer_accelerator_filter_linear(dpi);
+		*profile = pointer_accel_profile_linear;
+	} else if (streq(filter_type, "low-dpi")) {
+		filter = create_pointer_accelerator_filter_linear_low_dpi(dpi);
+		*profile = pointer_accel_profile_linear_low_dpi;
+	} else if (streq(filter_type, "touchpad")) {
+		filter = create_pointer_accelerator_filter_touchpad(dpi);
+		*profile = touchpad_accel_profile_linear;
+	} else if (streq(filter_type, "x230")) {
+		filter = create_pointer_accelerator_filter_lenovo_x230(dpi);
+		*profile = touchpad_lenovo_x230_accel_profile;
+	} else if (streq(filter_type, "trackpoint")) {
+		filter = create_pointer_accelerator_filter_trackpoint(dpi);
+		*profile = trackpoint_accel_profile;
+	} else {
+		return NULL;
+	}
+
+	assert(filter != NULL);
+	filter_set_speed(filter, speed);
+
+	return filter;
+}
+
+static void
+print_ptraccel_rates(const char *filter_type,
+		     int dpi,
+		     double speed,
+		     double max_mmps)
+{
+	const int rates[] = { 125, 250, 500, 1000, 2000, 4000, 8000 };
+	const uint64_t window = us(8000); /* one 125Hz interval */
+	double out[ARRAY_LENGTH(rates)][250] = {{0}}; /* 2s of data */
+	const uint64_t duration = window * ARRAY_LENGTH(out[0]);
+	unsigned int r, w;
+
+	/* Replay the same movement at each report rate: the speed ramps up
+	 * from zero to max_mmps over the first second, then stays
+	 * constant. Like a real mouse, each event only contains the
+	 * integer part of the motion, the remainder is carried over and
+	 * events without motion are not sent. Timestamps jitter by up to
+	 * a quarter of the report interval. */
+	for (r = 0; r < ARRAY_LENGTH(rates); r++) {
+		struct motion_filter *filter;
+		accel_profile_func_t profile;
+		uint64_t interval = s2us(1)/rates[r];
+		uint64_t time;
+		double remainder = 0;
+		double pos = 0;
+
+		filter = create_filter(filter_type, dpi, speed, &profile);
+		srand(1);
+
+		for (time = interval; time < duration; time += interval) {
+			struct device_float_coords motion;
+			struct normalized_coords accel;
+			double mmps = max_mmps * min(1.0, time/(double)s2us(1));
+			int spread = (int)interval;
+			int jitter = rand() % (spread/2 + 1) - spread/4;
+			uint64_t event_time;
+
+			remainder += mmps_to_upus(mmps, dpi) * interval;
+			motion.x = (int)remainder;
+			motion.y = 0;
+			remainder -= motion.x;
+			if (motion.x == 0)
+				continue;
+
+			/* jitter is at most a quarter interval and time
+			 * starts at one interval, so this can't go negative */
+			event_time = (uint64_t)((int64_t)time + jitter);
+			accel = filter_dispatch(filter,
+						&motion,
+						NULL,
+						event_time);
+			pos += accel.x;
+			out[r][time/window] = pos;
+		}
+
+		/* fill the windows without events */
+		for (w = 1; w < ARRAY_LENGTH(out[r]); w++) {
+			if (out[r][w] < out[r][w - 1])
+				out[r][w] = out[r][w - 1];
+		}
+
+		filter_destroy(filter);
+	}
+
+	printf("# gnuplot:\n");
+	printf("# set xlabel \"time (ms)\"\n");
+	printf("# set ylabel \"accelerated position\"\n");
+	printf("# set style data lines\n");
+	printf("# plot \"gnuplot.data\" using 1:3 title \"125Hz\", \\\n");
+	printf("#      \"gnuplot.data\" using 1:9 title \"8000Hz\"\n");
+	printf("#\n");
+	printf("# data: time(ms) speed(mm/s)");
+	for (r = 0; r < ARRAY_LENGTH(rates); r++)
+		printf(" %dHz", rates[r]);
+	printf("\n");
+
+	for (w = 0; w < ARRAY_LENGTH(out[0]); w++) {
+		double mmps = max_mmps * min(1.0,
+					     (w + 1) * window/(double)s2us(1));
+
+		printf("%d\t%.1f", (int)us2ms(w * window), mmps);
+		for (r = 0; r < ARRAY_LENGTH(rates); r++)
+			printf("\t%.3f", out[r][w]);
+		printf("\n");
+	}
+}
+
+static struct motion_filter *
+create_fixed_filter(const char *filter_type, int dpi, double speed)
+{
+	struct motion_filter *filter;
+
+	if (streq(filter_type, "linear"))
+		filter = create_pointer_accelerator_filter_linear_fixed(dpi);
+	else if (streq(filter_type, "low-dpi"))
+		filter = create_pointer_accelerator_filter_linear_low_dpi_fixed(dpi);
+	else if (streq(filter_type, "touchpad"))
+		filter = create_pointer_accelerator_filter_touchpad_fixed(dpi);
+	else if (streq(filter_type, "trackpoint"))
+		filter = create_pointer_accelerator_filter_trackpoint_fixed(dpi);
+	else
+		return NULL;
+
+	assert(filter != NULL);
+	filter_set_speed(filter, speed);
+
+	return filter;
+}
+
+static void
+print_ptraccel_compare(const char *filter_type,
+		       int dpi,
+		       double speed,
+		       double max_mmps)
+{
+	struct motion_filter *reference, *fixed;
+	accel_profile_func_t profile;
+	const uint64_t interval = ms2us(1);
+	uint64_t time = 0;
+	struct device_float_coords remainder = {0};
+	double max_error = 0;
+	int i;
+
+	fixed = create_fixed_filter(filter_type, dpi, speed);
+	if (!fixed) {
+		fprintf(stderr,
+			"No fixed-point implementation for filter %s\n",
+			filter_type);
+		return;
+	}
+	reference = create_filter(filter_type, dpi, speed, &profile);
+
+	printf("# gnuplot:\n");
+	printf("# set xlabel \"event number\"\n");
+	printf("# set ylabel \"delta motion\"\n");
+	printf("# set style data lines\n");
+	printf("# plot \"gnuplot.data\" using 1:4 title \"dx double\", \\\n");
+	printf("#      \"gnuplot.data\" using 1:6 title \"dx fixed\"\n");
+	printf("#\n");
+	printf("# data: event dx dy dx-double dy-double dx-fixed dy-fixed error\n");
+
+	/* A 1000Hz movement that slowly turns while the speed goes up and
+	 * down between zero and max_mmps, with a pause every 1.5s */
+	for (i = 0; i < 6000; i++) {
+		struct device_float_coords motion;
+		struct normalized_coords r, f;
+		double mmps = max_mmps * (0.5 - 0.5 * cos(i * M_PI/1000));
+		double angle = i * M_PI/1500;
+		double units = mmps_to_upus(mmps, dpi) * interval;
+		double error;
+
+		time += interval;
+		if (i % 1500 == 0)
+			time += ms2us(300);
+
+		remainder.x += units * cos(angle);
+		remainder.y += units * sin(angle);
+		motion.x = (int)remainder.x;
+		motion.y = (int)remainder.y;
+		remainder.x -= motion.x;
+		remainder.y -= motion.y;
+		if (motion.x == 0 && motion.y == 0)
+			continue;
+
+		r = filter_dispatch(reference, &motion, NULL, time);
+		f = filter_dispatch(fixed, &motion, NULL, time);
+		error = hypot(r.x - f.x, r.y - f.y);
+		max_error = max(max_error, error);
+
+		printf("%d\t%.0f\t%.0f\t%.5f\t%.5f\t%.5f\t%.5f\t%.5f\n",
+		       i, motion.x, motion.y, r.x, r.y, f.x, f.y, error);
+	}
+
+	printf("# max error: %.5f\n", max_error);
+
+	filter_destroy(reference);
+	filter_destroy(fixed);
+}
+
 static void
 print_accel_func(struct motion_filter *filter,
 		 accel_profile_func_t profile,
@@ -175,12 +387,15 @@ usage(void)
 	printf("Usage: %s [options] [dx1] [dx2] [...] > gnuplot.data\n", program_invocation_short_name);
 	printf("\n"
 	       "Options:\n"
-	       "--mode=<motion|accel|delta|sequence> \n"
+	       "--mode=<motion|accel|delta|sequence|rates|compare> \n"
 	       "	motion   ... print motion to accelerated motion (default)\n"
 	       "	delta    ... print delta to accelerated delta\n"
 	       "	accel    ... print accel factor\n"
 	       "	sequence ... print motion for custom delta sequence\n"
+	       "	rates    ... print motion for the same movement at 125Hz to 8000Hz\n"
+	       "	compare  ... print motion through the floating point and fixed-point filter\n"
 	       "--maxdx=<double>  ... in motion mode only. Stop increasing dx at maxdx\n"
+	       "--maxspeed=<double> ... in rates and compare modes only. Maximum speed in mm/s (default: 300)\n"
 	       "--steps=<double>  ... in motion and delta modes only. Increase dx by step each round\n"
 	       "--speed=<double>  ... accel speed [-1, 1], default 0\n"
 	       "--dpi=<int>	... device resolution in DPI (default: 1000)\n"
@@ -213,8 +428,11 @@ main(int argc, char **argv)
 	bool print_accel = false,
 	     print_motion = true,
 	     print_delta = false,
-	     print_sequence = false;
+	     print_sequence = false,
+	     print_rates = false,
+	     print_compare = false;
 	double custom_deltas[1024];
+	double max_mmps = 300.0;
 	double speed = 0.0;
 	int dpi = 1000;
 	const char *filter_type = "linear";
@@ -229,6 +447,7 @@ main(int argc, char **argv)
 		OPT_SPEED,
 		OPT_DPI,
 		OPT_FILTER,
+		OPT_MAXSPEED,
 	};
 
 	while (1) {
@@ -243,6 +462,7 @@ main(int argc, char **argv)
 			{"speed", 1, 0, OPT_SPEED },
 			{"dpi", 1, 0, OPT_DPI },
 			{"filter", 1, 0, OPT_FILTER },
+			{"maxspeed", 1, 0, OPT_MAXSPEED },
 			{0, 0, 0, 0}
 		};
 
@@ -265,6 +485,10 @@ main(int argc, char **argv)
 				print_delta = true;
 			else if (streq(optarg, "sequence"))
 				print_sequence = true;
+			else if (streq(optarg, "rates"))
+				print_rates = true;
+			else if (streq(optarg, "compare"))
+				print_compare = true;
 			else {
 				usage();
 				return 1;
@@ -300,6 +524,13 @@ main(int argc, char **argv)
 		case OPT_FILTER:
 			filter_type = optarg;
 			break;
+		case OPT_MAXSPEED:
+			max_mmps = strtod(optarg, NULL);
+			if (max_mmps <= 0.0) {
+				usage();
+				return 1;
+			}
+			break;
 		default:
 			usage();
 			exit(1);
@@ -307,28 +538,23 @@ main(int argc, char **argv)
 		}
 	}
 
-	if (streq(filter_type, "linear")) {
-		filter = create_pointer_accelerator_filter_linear(dpi);
-		profile = pointer_accel_profile_linear;
-	} else if (streq(filter_type, "low-dpi")) {
-		filter = create_pointer_accelerator_filter_linear_low_dpi(dpi);
-		profile = pointer_accel_profile_linear_low_dpi;
-	} else if (streq(filter_type, "touchpad")) {
-		filter = create_pointer_accelerator_filter_touchpad(dpi);
-		profile = touchpad_accel_profile_linear;
-	} else if (streq(filter_type, "x230")) {
-		filter = create_pointer_accelerator_filter_lenovo_x230(dpi);
-		profile = touchpad_lenovo_x230_accel_profile;
-	} else if (streq(filter_type, "trackpoint")) {
-		filter = create_pointer_accelerator_filter_trackpoint(dpi);
-		profile = trackpoint_accel_profile;
-	} else {
+	filter = create_filter(filter_type, dpi, speed, &profile);
+	if (!filter) {
 		fprintf(stderr, "Invalid filter type %s\n", filter_type);
 		return 1;
 	}
 
-	assert(filter != NULL);
-	filter_set_speed(filter, speed);
+	if (print_rates) {
+		print_ptraccel_rates(filter_type, dpi, speed, max_mmps);
+		filter_destroy(filter);
+		return 0;
+	}
+
+	if (print_compare) {
+		print_ptraccel_compare(filter_type, dpi, speed, max_mmps);
+		filter_destroy(filter);
+		return 0;
+	}
 
 	if (!isatty(STDIN_FILENO)) {
 		char buf[12];
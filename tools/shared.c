@@ -64,6 +64,9 @@ enum options {
 	OPT_PROFILE,
 	OPT_SHOW_KEYCODES,
 	OPT_QUIET,
+	OPT_STATS,
+	OPT_JSON,
+	OPT_PROFILE_DISPATCH,
 };
 
 LIBINPUT_ATTRIBUTE_PRINTF(3, 0)
@@ -74,21 +77,27 @@ log_handler(struct libinput *li,
 	    va_list args)
 {
 	static int is_tty = -1;
+	const struct tools_context *context = libinput_get_user_data(li);
+	FILE *out = stdout;
+
+	/* keep the JSON stream parseable */
+	if (context->options.json_flush_ms)
+		out = stderr;
 
 	if (is_tty == -1)
-		is_tty = isatty(STDOUT_FILENO);
+		is_tty = isatty(fileno(out));
 
 	if (is_tty) {
 		if (priority >= LIBINPUT_LOG_PRIORITY_ERROR)
-			printf(ANSI_RED);
+			fprintf(out, ANSI_RED);
 		else if (priority >= LIBINPUT_LOG_PRIORITY_INFO)
-			printf(ANSI_HIGHLIGHT);
+			fprintf(out, ANSI_HIGHLIGHT);
 	}
 
-	vprintf(format, args);
+	vfprintf(out, format, args);
 
 	if (is_tty && priority >= LIBINPUT_LOG_PRIORITY_INFO)
-		printf(ANSI_NORMAL);
+		fprintf(out, ANSI_NORMAL);
 }
 
 void
@@ -129,6 +138,9 @@ tools_usage(void)
 	       "--grab .......... Exclusively grab all openend devices\n"
 	       "--verbose ....... Print debugging output.\n"
 	       "--quiet ......... Only print libinput messages, useful in combination with --verbose.\n"
+	       "--stats[=<seconds>] .... Print runtime statistics every n seconds (default 5) and on exit.\n"
+	       "--json[=<ms>] ... Print events as JSON lines, flushed every n milliseconds (default 100).\n"
+	       "--profile[=<seconds>] .... Print dispatch times and event latencies every n seconds (default 1) instead of events.\n"
 	       "--help .......... Print this help.\n",
 		program_invocation_short_name);
 }
@@ -195,6 +207,9 @@ tools_parse_args(int argc, char **argv, struct tools_context *context)
 			{ "set-tap-map",               required_argument, 0, OPT_TAP_MAP },
 			{ "set-speed",                 required_argument, 0, OPT_SPEED },
 			{ "show-keycodes",             no_argument,       0, OPT_SHOW_KEYCODES },
+			{ "stats",                     optional_argument, 0, OPT_STATS },
+			{ "json",                      optional_argument, 0, OPT_JSON },
+			{ "profile",                   optional_argument, 0, OPT_PROFILE_DISPATCH },
 			{ 0, 0, 0, 0}
 		};
 
@@ -365,6 +380,50 @@ tools_parse_args(int argc, char **argv, struct tools_context *context)
 		case OPT_QUIET:
 			options->quiet = true;
 			break;
+		case OPT_STATS:
+			options->stats_interval = 5;
+			if (optarg) {
+				char *endptr;
+				unsigned long interval;
+
+				interval = strtoul(optarg, &endptr, 10);
+				if (*endptr != '\0' || interval == 0 ||
+				    interval > 3600) {
+					tools_usage();
+					return 1;
+				}
+				options->stats_interval = interval;
+			}
+			break;
+		case OPT_JSON:
+			options->json_flush_ms = 100;
+			if (optarg) {
+				char *endptr;
+				unsigned long ms;
+
+				ms = strtoul(optarg, &endptr, 10);
+				if (*endptr != '\0' || ms == 0 || ms > 60000) {
+					tools_usage();
+					return 1;
+				}
+				options->json_flush_ms = ms;
+			}
+			break;
+		case OPT_PROFILE_DISPATCH:
+			options->profile_interval = 1;
+			if (optarg) {
+				char *endptr;
+				unsigned long interval;
+
+				interval = strtoul(optarg, &endptr, 10);
+				if (*endptr != '\0' || interval == 0 ||
+				    interval > 3600) {
+					tools_usage();
+					return 1;
+				}
+				options->profile_interval = interval;
+			}
+			break;
 		default:
 			tools_usage();
 			return 1;
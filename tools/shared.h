@@ -40,6 +40,9 @@ struct tools_options {
 	int grab; /* EVIOCGRAB */
 	bool show_keycodes; /* show keycodes */
 	bool quiet; /* only print libinput messages */
+	unsigned int stats_interval; /* in s, 0 to disable */
+	unsigned int json_flush_ms; /* JSON output flush interval, 0 for text */
+	unsigned int profile_interval; /* in s, 0 to disable */
 
 	int verbose;
 	int tapping;
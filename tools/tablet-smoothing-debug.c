@@ -0,0 +1,390 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "config.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "filter-smoothing.h"
+#include "libinput-util.h"
+
+/* Samples slower than this are considered at rest, faster ones are used
+ * to measure the lag */
+#define REST_SPEED 5.0		/* mm/s */
+#define MOVING_SPEED 10.0	/* mm/s */
+
+struct recording {
+	uint64_t *times;	/* µs */
+	struct smoothing_sample *samples;
+	size_t nsamples;
+	size_t size;
+};
+
+static bool
+recording_append(struct recording *rec,
+		 uint64_t time,
+		 const struct smoothing_sample *sample)
+{
+	if (rec->nsamples == rec->size) {
+		size_t size = rec->size ? rec->size * 2 : 1024;
+		uint64_t *times;
+		struct smoothing_sample *samples;
+
+		times = realloc(rec->times, size * sizeof *times);
+		if (!times)
+			return false;
+		rec->times = times;
+
+		samples = realloc(rec->samples, size * sizeof *samples);
+		if (!samples)
+			return false;
+		rec->samples = samples;
+
+		rec->size = size;
+	}
+
+	rec->times[rec->nsamples] = time;
+	rec->samples[rec->nsamples] = *sample;
+	rec->nsamples++;
+
+	return true;
+}
+
+/* One sample per line: time in µs, x and y in device units and
+ * optionally tilt x and y in degrees. Lines starting with # are
+ * ignored. */
+static bool
+recording_read(struct recording *rec, FILE *fp)
+{
+	char line[256];
+	int lineno = 0;
+
+	while (fgets(line, sizeof(line), fp)) {
+		struct smoothing_sample sample = { .point = { 0, 0 } };
+		unsigned long long time;
+		int n;
+
+		lineno++;
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+
+		n = sscanf(line, "%llu %lf %lf %lf %lf",
+			   &time,
+			   &sample.point.x,
+			   &sample.point.y,
+			   &sample.tilt.x,
+			   &sample.tilt.y);
+		if (n != 3 && n != 5) {
+			fprintf(stderr, "Invalid sample on line %d\n", lineno);
+			return false;
+		}
+
+		if (!recording_append(rec, time, &sample))
+			return false;
+	}
+
+	return rec->nsamples > 1;
+}
+
+/* A pen drawing circles with varying speed, pausing between them, with
+ * some sensor noise on all axes. */
+static bool
+recording_synthesize(struct recording *rec,
+		     double frequency,
+		     double resolution)
+{
+	const double radius = 30.0; /* mm */
+	uint64_t interval = 1000000/frequency;
+	uint64_t time = 0;
+	double angle = 0.0;
+	int i, n = frequency * 6;
+
+	srand(1);
+
+	for (i = 0; i < n; i++) {
+		struct smoothing_sample sample;
+		double t = (double)time/1000000.0;
+		double speed; /* revolutions per second */
+
+		/* 1s at rest, then 2s of circles speeding up and slowing
+		 * down, repeated */
+		if (fmod(t, 3.0) < 1.0)
+			speed = 0.0;
+		else
+			speed = 1.5 * sin(M_PI * (fmod(t, 3.0) - 1.0)/2.0);
+
+		angle += 2 * M_PI * speed / frequency;
+
+		sample.point.x = (100 + radius * cos(angle)) * resolution;
+		sample.point.y = (100 + radius * sin(angle)) * resolution;
+		sample.tilt.x = 30 * cos(angle);
+		sample.tilt.y = 30 * sin(angle);
+
+		/* ±0.05mm and ±0.5 degrees noise */
+		sample.point.x += (rand() % 21 - 10) * resolution/200.0;
+		sample.point.y += (rand() % 21 - 10) * resolution/200.0;
+		sample.tilt.x += (rand() % 11 - 5)/10.0;
+		sample.tilt.y += (rand() % 11 - 5)/10.0;
+
+		if (!recording_append(rec, time, &sample))
+			return false;
+
+		time += interval;
+	}
+
+	return true;
+}
+
+static uint64_t
+now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+print_results(const struct recording *rec,
+	      const char *name,
+	      enum smoothing_mode mode,
+	      double strength,
+	      double resolution,
+	      int iterations)
+{
+	struct smoothing_filter filter;
+	struct smoothing_sample *out;
+	uint64_t start, elapsed;
+	double lag_sum = 0.0, lag_max = 0.0;
+	double jitter_sum = 0.0;
+	int nlag = 0, njitter = 0;
+	size_t i;
+	int iter;
+
+	out = calloc(rec->nsamples, sizeof *out);
+	if (!out)
+		return;
+
+	smoothing_init(&filter, mode, strength, resolution);
+
+	start = now_ns();
+	for (iter = 0; iter < iterations; iter++) {
+		smoothing_reset(&filter);
+		for (i = 0; i < rec->nsamples; i++)
+			out[i] = smoothing_dispatch(&filter,
+						    &rec->samples[i],
+						    rec->times[i]);
+	}
+	elapsed = now_ns() - start;
+
+	for (i = 1; i < rec->nsamples - 1; i++) {
+		const struct smoothing_sample *prev = &rec->samples[i - 1],
+					      *next = &rec->samples[i + 1];
+		double dt = (rec->times[i + 1] - rec->times[i - 1])/1000000.0;
+		double vx, vy, speed, dx, dy, lag;
+
+		if (dt <= 0.0)
+			continue;
+
+		/* raw velocity in mm/s */
+		vx = (next->point.x - prev->point.x)/resolution/dt;
+		vy = (next->point.y - prev->point.y)/resolution/dt;
+		speed = hypot(vx, vy);
+
+		/* how far behind the raw sample the filtered one is */
+		dx = (rec->samples[i].point.x - out[i].point.x)/resolution;
+		dy = (rec->samples[i].point.y - out[i].point.y)/resolution;
+
+		if (speed > MOVING_SPEED) {
+			/* project onto the direction of motion, in ms */
+			lag = (dx * vx + dy * vy)/(speed * speed) * 1000.0;
+			lag_sum += lag;
+			lag_max = max(lag_max, lag);
+			nlag++;
+		} else if (speed < REST_SPEED) {
+			dx = (out[i].point.x - out[i - 1].point.x)/resolution;
+			dy = (out[i].point.y - out[i - 1].point.y)/resolution;
+			jitter_sum += dx * dx + dy * dy;
+			njitter++;
+		}
+	}
+
+	printf("%-10s %8.2f %10.1f %10.2f %10.2f %12.4f\n",
+	       name,
+	       strength,
+	       (double)elapsed/iterations/rec->nsamples,
+	       nlag ? lag_sum/nlag : 0.0,
+	       lag_max,
+	       njitter ? sqrt(jitter_sum/njitter) : 0.0);
+
+	free(out);
+}
+
+static void
+usage(void)
+{
+	printf("Usage: %s [options] [recording]\n", program_invocation_short_name);
+	printf("\n"
+	       "Runs the tablet tool smoothing filters over a recording and prints\n"
+	       "the cost per event and the lag behind the raw position\n"
+	       "\n"
+	       "Options:\n"
+	       "--strength=<double>   ... adaptive smoothing strength [0, 1], default 0.5\n"
+	       "--resolution=<double> ... device units per mm, default 200\n"
+	       "--frequency=<double>  ... event rate of the synthesized recording in Hz,\n"
+	       "                          default 200\n"
+	       "--iterations=<int>    ... number of passes for the timing, default 100\n"
+	       "\n"
+	       "A recording has one event per line: the time in microseconds, x and\n"
+	       "y in device units and optionally tilt x and y in degrees.\n"
+	       "Without a recording, a pen stroke is synthesized.\n"
+	       "\n"
+	       "Output columns:\n"
+	       "ns/event  ... time spent in the filter per event\n"
+	       "lag-mean  ... mean lag behind the raw position in ms while moving\n"
+	       "lag-max   ... maximum lag in ms while moving\n"
+	       "jitter    ... RMS motion of the filtered position in mm at rest\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	struct recording rec = {0};
+	double strength = 0.5;
+	double resolution = 200;
+	double frequency = 200;
+	int iterations = 100;
+	bool rc;
+
+	enum {
+		OPT_HELP = 1,
+		OPT_STRENGTH,
+		OPT_RESOLUTION,
+		OPT_FREQUENCY,
+		OPT_ITERATIONS,
+	};
+
+	while (1) {
+		int c;
+		int option_index = 0;
+		static struct option long_options[] = {
+			{"help", 0, 0, OPT_HELP },
+			{"strength", 1, 0, OPT_STRENGTH },
+			{"resolution", 1, 0, OPT_RESOLUTION },
+			{"frequency", 1, 0, OPT_FREQUENCY },
+			{"iterations", 1, 0, OPT_ITERATIONS },
+			{0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "",
+				long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_HELP:
+			usage();
+			exit(0);
+			break;
+		case OPT_STRENGTH:
+			strength = strtod(optarg, NULL);
+			if (strength < 0.0 || strength > 1.0) {
+				usage();
+				return 1;
+			}
+			break;
+		case OPT_RESOLUTION:
+			resolution = strtod(optarg, NULL);
+			if (resolution <= 0.0) {
+				usage();
+				return 1;
+			}
+			break;
+		case OPT_FREQUENCY:
+			frequency = strtod(optarg, NULL);
+			if (frequency <= 0.0) {
+				usage();
+				return 1;
+			}
+			break;
+		case OPT_ITERATIONS:
+			iterations = atoi(optarg);
+			if (iterations <= 0) {
+				usage();
+				return 1;
+			}
+			break;
+		default:
+			usage();
+			exit(1);
+			break;
+		}
+	}
+
+	if (optind < argc) {
+		FILE *fp = fopen(argv[optind], "r");
+
+		if (!fp) {
+			fprintf(stderr,
+				"Failed to open %s: %s\n",
+				argv[optind],
+				strerror(errno));
+			return 1;
+		}
+		rc = recording_read(&rec, fp);
+		fclose(fp);
+	} else {
+		rc = recording_synthesize(&rec, frequency, resolution);
+	}
+
+	if (!rc) {
+		fprintf(stderr, "Failed to load the recording\n");
+		return 1;
+	}
+
+	printf("# %zu events over %.2fs\n",
+	       rec.nsamples,
+	       (rec.times[rec.nsamples - 1] - rec.times[0])/1000000.0);
+	printf("# %-8s %8s %10s %10s %10s %12s\n",
+	       "filter", "strength", "ns/event", "lag-mean", "lag-max", "jitter");
+
+	print_results(&rec, "average", SMOOTHING_BOX, 0.0,
+		      resolution, iterations);
+	print_results(&rec, "adaptive", SMOOTHING_ADAPTIVE, strength,
+		      resolution, iterations);
+
+	free(rec.times);
+	free(rec.samples);
+
+	return 0;
+}